@@ -0,0 +1,839 @@
+//chess_perft: counts the leaf nodes of the legal move tree for known positions
+//and compares them against the published numbers, the oracle for any move generator change
+//only the headless rule code is linked, there is no Renderer, AudioSystem or Engine here
+//
+//usage: chess_perft [position=<name>|all] [fen="<FEN>"] [moves="<e2e4 e7e5 ...>"] [depth=<n>] [divide=true] [status=true] [search=true] [threads=<n>] [hash=<MB>] [hugepages=true] [nnue=<file>] [makennue=true] [tablebases=<dir>] [book=<file>] [makebook=<file>] [bookplies=<n>]
+//fen= runs a single position of your own, there is nothing to compare its counts against
+//moves= replays a move list on top of the position first, the counts are then unknown as well
+//status=true times check/checkmate/stalemate detection after every move instead of counting nodes
+//search=true runs the alpha-beta search to depth= (default 5) and prints its move, score and speed,
+//threads= searches with that many Lazy SMP threads (default 1), hash= sizes the transposition table in MB (default 16)
+//and hugepages=true asks Linux for 2 MB pages behind it; nnue= evaluates with that network after checking its incremental accumulators,
+//with makennue=true it writes that network instead, the piece-square tables as weights, and compares both evaluations
+//tablebases= scores the endings chess_tbgen wrote there from the tables and prints what they say about the position itself
+//book= checks GetPolyglotKey() against known keys, then prints the Polyglot key and opening book moves of each position, with makebook= it writes that book instead from a text file
+//of games or opening lines (coordinate moves from the start position, one line each, # starts a comment), keeping bookplies= (default 16)
+
+#include "Game/ChessMoveGen.hpp"
+#include "Game/ChessMoveSequence.hpp"
+#include "Game/ChessAttacks.hpp"
+#include "Game/ChessAttackMap.hpp"
+#include "Game/ChessEvaluation.hpp"
+#include "Game/ChessPieceSquareTables.hpp"
+#include "Game/ChessSearch.hpp"
+#include "Game/ChessOpeningBook.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+
+struct PerftTestPosition
+{
+	const char* m_name = nullptr;
+	const char* m_fen = nullptr;
+	int m_defaultDepth = 1;
+	uint64_t m_expectedNodes[7] = {};//index 0 = depth 1, 0 = unknown
+	const char* m_moves = nullptr;//played from m_fen before counting
+};
+
+//https://www.chessprogramming.org/Perft_Results
+static const PerftTestPosition PERFT_TEST_POSITIONS[] =
+{
+	{ "startpos",
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5,
+		{ 20ULL, 400ULL, 8902ULL, 197281ULL, 4865609ULL, 119060324ULL } },
+	{ "kiwipete",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4,
+		{ 48ULL, 2039ULL, 97862ULL, 4085603ULL, 193690690ULL } },
+	{ "position3",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6,
+		{ 14ULL, 191ULL, 2812ULL, 43238ULL, 674624ULL, 11030083ULL, 178633661ULL } },
+	{ "position4",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5,
+		{ 6ULL, 264ULL, 9467ULL, 422333ULL, 15833292ULL, 706045033ULL } },
+	{ "position5",
+		"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4,
+		{ 44ULL, 1486ULL, 62379ULL, 2103487ULL, 89941194ULL } },
+	{ "position6",
+		"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4,
+		{ 46ULL, 2079ULL, 89890ULL, 3894594ULL, 164075551ULL } },
+};
+constexpr int NUM_PERFT_TEST_POSITIONS = sizeof(PERFT_TEST_POSITIONS) / sizeof(PERFT_TEST_POSITIONS[0]);
+constexpr int MAX_PERFT_DEPTH = 7;
+
+
+static uint64_t Perft(ChessPosition& position, int depth)
+{
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+	if (depth == 1)
+	{
+		return (uint64_t)moves.GetSize();
+	}
+
+	uint64_t nodes = 0;
+	for (ChessMove move : moves)
+	{
+		position.MakeMove(move);
+		nodes += Perft(position, depth - 1);
+		position.UnmakeMove();
+	}
+	return nodes;
+}
+
+static uint64_t PerftDivide(ChessPosition& position, int depth)
+{
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+
+	uint64_t nodes = 0;
+	for (ChessMove move : moves)
+	{
+		uint64_t moveNodes = 1;
+		if (depth > 1)
+		{
+			position.MakeMove(move);
+			moveNodes = Perft(position, depth - 1);
+			position.UnmakeMove();
+		}
+		char moveText[MAX_MOVE_TEXT_LENGTH];
+		WriteMoveText(move, moveText);
+		printf("  %s: %llu\n", moveText, (unsigned long long)moveNodes);
+		nodes += moveNodes;
+	}
+	printf("  %d moves\n", moves.GetSize());
+	return nodes;
+}
+
+static void SetPositionForTest(ChessPosition& position, PerftTestPosition const& test)
+{
+	position.SetFromFEN(test.m_fen);
+	if (test.m_moves != nullptr)
+	{
+		int numMovesApplied = 0;
+		ApplyMoveSequence(position, test.m_moves, numMovesApplied);
+	}
+}
+
+static bool RunPerftTest(PerftTestPosition const& test, int depth, bool isDivide)
+{
+	ChessPosition position;
+	SetPositionForTest(position, test);
+
+	auto startTime = std::chrono::steady_clock::now();
+	uint64_t nodes = isDivide ? PerftDivide(position, depth) : Perft(position, depth);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	uint64_t expectedNodes = test.m_expectedNodes[depth - 1];
+	bool isCorrect = expectedNodes == 0 || nodes == expectedNodes;
+	double nodesPerSecond = seconds > 0.0 ? (double)nodes / seconds : 0.0;
+	printf("%-10s depth %d  nodes %12llu  expected %12llu  %8.3f s  %6.2f Mnps  %s\n",
+		test.m_name, depth, (unsigned long long)nodes, (unsigned long long)expectedNodes, seconds, nodesPerSecond / 1000000.0,
+		expectedNodes == 0 ? "UNKNOWN" : (isCorrect ? "OK" : "FAILED"));
+	return isCorrect;
+}
+
+enum class StatusWalkMode
+{
+	MAKE_UNMAKE_ONLY,
+	INCREMENTAL_ATTACK_MAP,
+	REBUILT_ATTACK_MAP,
+	MOVE_GENERATOR
+};
+
+struct StatusWalkCounts
+{
+	uint64_t m_nodes = 0;
+	uint64_t m_checks = 0;
+	uint64_t m_checkmates = 0;
+	uint64_t m_stalemates = 0;
+	uint64_t m_mapMismatches = 0;
+	uint64_t m_evaluationMismatches = 0;
+};
+
+//the game status after every move of the tree, the way ChessMatch does it after MovePiece
+static void WalkStatus(ChessPosition& position, ChessAttackMap& attackMap, int depth, StatusWalkMode mode, bool isVerifying, StatusWalkCounts& counts)
+{
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+	for (ChessMove move : moves)
+	{
+		position.MakeMove(move);
+		counts.m_nodes++;
+
+		ChessGameStatus status = ChessGameStatus::ONGOING;
+		if (mode == StatusWalkMode::INCREMENTAL_ATTACK_MAP || mode == StatusWalkMode::REBUILT_ATTACK_MAP)
+		{
+			if (mode == StatusWalkMode::INCREMENTAL_ATTACK_MAP)
+			{
+				attackMap.UpdateForMove(position, move);
+			}
+			else
+			{
+				attackMap.Rebuild(position);
+			}
+			status = GetGameStatus(position, attackMap);
+		}
+		else if (mode == StatusWalkMode::MOVE_GENERATOR)
+		{
+			ChessMoveList replies;
+			GenerateLegalMoves(position, replies);
+			bool isInCheck = IsPlayerInCheck(position, position.GetPlayerToMove());
+			status = replies.IsEmpty() ? (isInCheck ? ChessGameStatus::CHECKMATE : ChessGameStatus::STALEMATE) : (isInCheck ? ChessGameStatus::CHECK : ChessGameStatus::ONGOING);
+		}
+
+		if (isVerifying)
+		{
+			ChessAttackMap rebuiltMap;
+			rebuiltMap.Rebuild(position);
+			for (int player = 0; player < NUM_CHESS_PLAYERS; player++)
+			{
+				if (rebuiltMap.GetAttacksForPlayer(player) != attackMap.GetAttacksForPlayer(player))
+				{
+					counts.m_mapMismatches++;
+				}
+			}
+			if (EvaluatePosition(position) != EvaluatePositionFromScratch(position))
+			{
+				counts.m_evaluationMismatches++;
+			}
+		}
+
+		counts.m_checks += (status == ChessGameStatus::CHECK || status == ChessGameStatus::CHECKMATE) ? 1 : 0;
+		counts.m_checkmates += status == ChessGameStatus::CHECKMATE ? 1 : 0;
+		counts.m_stalemates += status == ChessGameStatus::STALEMATE ? 1 : 0;
+		if (depth > 1)
+		{
+			WalkStatus(position, attackMap, depth - 1, mode, isVerifying, counts);
+		}
+
+		position.UnmakeMove();
+		if (mode == StatusWalkMode::INCREMENTAL_ATTACK_MAP)
+		{
+			attackMap.UpdateForChangedSquares(position, ChessAttackMap::GetChangedSquaresForMove(move, position.GetPlayerToMove()));
+		}
+	}
+}
+
+static double TimeStatusWalk(PerftTestPosition const& test, int depth, StatusWalkMode mode, StatusWalkCounts& counts)
+{
+	ChessPosition position;
+	SetPositionForTest(position, test);
+	ChessAttackMap attackMap;
+	attackMap.Rebuild(position);
+
+	auto startTime = std::chrono::steady_clock::now();
+	WalkStatus(position, attackMap, depth, mode, false, counts);
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+//incremental attack maps against rebuilding them and against asking the move generator, in ns per move on top of make/unmake
+static bool RunStatusBenchmark(PerftTestPosition const& test, int depth)
+{
+	//correctness first: the incremental map must equal a rebuilt one after every make and unmake, so must the incremental evaluation,
+	//and both status paths must count the same checks, mates and stalemates
+	ChessPosition position;
+	SetPositionForTest(position, test);
+	ChessAttackMap attackMap;
+	attackMap.Rebuild(position);
+	StatusWalkCounts verifyCounts;
+	WalkStatus(position, attackMap, depth, StatusWalkMode::INCREMENTAL_ATTACK_MAP, true, verifyCounts);
+
+	StatusWalkCounts baseCounts, incrementalCounts, rebuiltCounts, moveGenCounts;
+	double baseSeconds = TimeStatusWalk(test, depth, StatusWalkMode::MAKE_UNMAKE_ONLY, baseCounts);
+	double incrementalSeconds = TimeStatusWalk(test, depth, StatusWalkMode::INCREMENTAL_ATTACK_MAP, incrementalCounts);
+	double rebuiltSeconds = TimeStatusWalk(test, depth, StatusWalkMode::REBUILT_ATTACK_MAP, rebuiltCounts);
+	double moveGenSeconds = TimeStatusWalk(test, depth, StatusWalkMode::MOVE_GENERATOR, moveGenCounts);
+
+	double nanosecondsPerNode = 1000000000.0 / (double)baseCounts.m_nodes;
+	bool isCorrect = verifyCounts.m_mapMismatches == 0
+		&& verifyCounts.m_evaluationMismatches == 0
+		&& incrementalCounts.m_checks == moveGenCounts.m_checks
+		&& incrementalCounts.m_checkmates == moveGenCounts.m_checkmates
+		&& incrementalCounts.m_stalemates == moveGenCounts.m_stalemates;
+	printf("%-10s depth %d  moves %10llu  checks %8llu  mates %6llu  stalemates %4llu  %s\n",
+		test.m_name, depth, (unsigned long long)baseCounts.m_nodes, (unsigned long long)incrementalCounts.m_checks,
+		(unsigned long long)incrementalCounts.m_checkmates, (unsigned long long)incrementalCounts.m_stalemates, isCorrect ? "OK" : "FAILED");
+	printf("           status ns/move: incremental map %6.1f  rebuilt map %6.1f  move generator %6.1f  (make/unmake alone %.1f)\n",
+		(incrementalSeconds - baseSeconds) * nanosecondsPerNode, (rebuiltSeconds - baseSeconds) * nanosecondsPerNode,
+		(moveGenSeconds - baseSeconds) * nanosecondsPerNode, baseSeconds * nanosecondsPerNode);
+	return isCorrect;
+}
+
+constexpr int DEFAULT_SEARCH_DEPTH = 5;
+constexpr int NNUE_CHECK_DEPTH = 3;
+
+struct SearchBenchmarkSettings
+{
+	int m_numThreads = 1;
+	int m_hashSizeInMB = ChessTranspositionTable::DEFAULT_SIZE_MB;
+	bool m_isUsingHugePages = false;
+	const char* m_networkFile = nullptr;
+	const char* m_tablebaseDirectory = nullptr;
+};
+
+//the accumulator the search updates move by move must equal one built from the position after every move
+static uint64_t CountAccumulatorMismatches(ChessNNUENetwork const& network, ChessPosition& position, ChessNNUEAccumulator const& parent, int depth)
+{
+	uint64_t numMismatches = 0;
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+	for (ChessMove move : moves)
+	{
+		ChessNNUEAccumulator child;
+		ChessNNUEAccumulator rebuilt;
+		network.UpdateAccumulator(parent, child, position, move);
+		position.MakeMove(move);
+		network.RefreshAccumulator(position, rebuilt);
+		if (memcmp(&child, &rebuilt, sizeof(child)) != 0)
+		{
+			numMismatches++;
+		}
+		if (depth > 1)
+		{
+			numMismatches += CountAccumulatorMismatches(network, position, child, depth - 1);
+		}
+		position.UnmakeMove();
+	}
+	return numMismatches;
+}
+
+static bool RunSearchBenchmark(PerftTestPosition const& test, int depth, SearchBenchmarkSettings const& settings)
+{
+	ChessPosition position;
+	SetPositionForTest(position, test);
+
+	ChessSearchLimits limits;
+	limits.m_maxDepth = depth;
+	ChessSearch search;
+	search.SetNumThreads(settings.m_numThreads);
+	search.GetTranspositionTable().Resize(settings.m_hashSizeInMB, settings.m_isUsingHugePages);
+	if (settings.m_networkFile != nullptr)
+	{
+		std::unique_ptr<ChessNNUENetwork> network = std::make_unique<ChessNNUENetwork>();
+		if (!network->LoadFromFile(settings.m_networkFile) || !search.LoadNetwork(settings.m_networkFile))
+		{
+			printf("%-10s could not load network %s\n", test.m_name, settings.m_networkFile);
+			return false;
+		}
+		ChessNNUEAccumulator rootAccumulator;
+		network->RefreshAccumulator(position, rootAccumulator);
+		uint64_t numMismatches = CountAccumulatorMismatches(*network, position, rootAccumulator, NNUE_CHECK_DEPTH);
+		printf("%-10s nnue %s  accumulator mismatches to depth %d: %llu  evaluation %d\n", test.m_name, ChessNNUENetwork::GetInstructionSetName(),
+			NNUE_CHECK_DEPTH, (unsigned long long)numMismatches, network->Evaluate(rootAccumulator, position.GetPlayerToMove()));
+		if (numMismatches != 0)
+		{
+			return false;
+		}
+	}
+	if (settings.m_tablebaseDirectory != nullptr)
+	{
+		int numTablebases = search.LoadTablebases(settings.m_tablebaseDirectory);
+		ChessTablebaseResult tablebaseResult;
+		ChessMove tablebaseMove;
+		char tablebaseMoveText[MAX_MOVE_TEXT_LENGTH] = "none";
+		if (search.GetTablebases().GetBestMove(position, tablebaseMove, tablebaseResult))
+		{
+			WriteMoveText(tablebaseMove, tablebaseMoveText);
+			printf("%-10s %d tablebases  bestmove %-5s  %s in %d plies\n", test.m_name, numTablebases, tablebaseMoveText,
+				tablebaseResult.m_wdl > 0 ? "win" : (tablebaseResult.m_wdl < 0 ? "loss" : "draw"), tablebaseResult.m_pliesToMate);
+		}
+		else
+		{
+			printf("%-10s %d tablebases, none covers the position\n", test.m_name, numTablebases);
+		}
+	}
+	ChessSearchResult result = search.Search(position, limits);
+
+	char moveText[MAX_MOVE_TEXT_LENGTH] = "none";
+	if (!result.m_bestMove.IsNull())
+	{
+		WriteMoveText(result.m_bestMove, moveText);
+	}
+	double nodesPerSecond = result.m_seconds > 0.0 ? (double)result.m_nodes / result.m_seconds : 0.0;
+	printf("%-10s depth %d  bestmove %-5s  score %6d  nodes %12llu  %8.3f s  %6.2f Mnps  hashfull %4d\n",
+		test.m_name, result.m_depth, moveText, result.m_score, (unsigned long long)result.m_nodes, result.m_seconds, nodesPerSecond / 1000000.0,
+		result.m_hashfull);
+	return !result.m_bestMove.IsNull();
+}
+
+//the piece-square evaluation written as a network, so the NNUE code paths run with weights that mean something:
+//the first 128 hidden units of each perspective read midgame minus endgame score plus a large multiple of the
+//game phase, which puts every phase in its own band of 4 units whose output weight is that phase, so the band
+//scales the difference by the phase; the other 128 units read the endgame score. the player to move's units add,
+//the opponent's, seeing the same board from the other side, subtract, which leaves
+//endgame + (midgame - endgame) * phase / MAX_GAME_PHASE like EvaluatePosition, give or take the rounding of the rows
+constexpr int PHASE_UNITS = 128;
+constexpr int UNITS_PER_PHASE_BAND = 4;
+constexpr int PHASE_BAND_WIDTH = UNITS_PER_PHASE_BAND * NNUE_ACTIVATION_SCALE;//the phase difference stays within half a band
+constexpr int ENDGAME_UNITS = NNUE_HIDDEN_SIZE - PHASE_UNITS;
+constexpr int ENDGAME_OUTPUT_WEIGHT = 5;
+constexpr double OUTPUT_UNITS_PER_CENTIPAWN = (double)(NNUE_ACTIVATION_SCALE * NNUE_WEIGHT_SCALE) / NNUE_OUTPUT_SCALE;
+constexpr double PHASE_DIFFERENCE_SCALE = OUTPUT_UNITS_PER_CENTIPAWN / (2 * MAX_GAME_PHASE);
+constexpr double ENDGAME_SCALE = OUTPUT_UNITS_PER_CENTIPAWN / (2 * ENDGAME_OUTPUT_WEIGHT);
+constexpr int NETWORK_CHECK_DEPTH = 3;
+
+static int16_t RoundToInt16(double value)
+{
+	return (int16_t)(value < 0.0 ? value - 0.5 : value + 0.5);
+}
+
+static void AddEvaluationDifferences(ChessNNUENetwork const& network, ChessPosition& position, int depth, int& outLargest, double& outSum, uint64_t& outCount)
+{
+	ChessNNUEAccumulator accumulator;
+	network.RefreshAccumulator(position, accumulator);
+	int difference = abs(network.Evaluate(accumulator, position.GetPlayerToMove()) - EvaluatePosition(position));
+	outLargest = difference > outLargest ? difference : outLargest;
+	outSum += difference;
+	outCount++;
+	if (depth == 0)
+	{
+		return;
+	}
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+	for (ChessMove move : moves)
+	{
+		position.MakeMove(move);
+		AddEvaluationDifferences(network, position, depth - 1, outLargest, outSum, outCount);
+		position.UnmakeMove();
+	}
+}
+
+static bool MakePieceSquareNetwork(const char* networkFilePath)
+{
+	//rows are seen from player 0, the other perspective reads them through the mirrored feature index
+	std::vector<int16_t> featureWeights((size_t)NNUE_NUM_FEATURES * NNUE_HIDDEN_SIZE);
+	for (int owner = 0; owner < NUM_CHESS_PLAYERS; owner++)
+	{
+		for (int type = 0; type < NUM_CHESS_PIECE_TYPES; type++)
+		{
+			for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+			{
+				int midgame = PIECE_SQUARE_SCORES.m_midgame[owner][type][square];
+				int endgame = PIECE_SQUARE_SCORES.m_endgame[owner][type][square];
+				int16_t phaseRow = (int16_t)(RoundToInt16(PHASE_DIFFERENCE_SCALE * (midgame - endgame)) + PHASE_BAND_WIDTH * GAME_PHASE_WEIGHTS[type]);
+				int16_t endgameRow = RoundToInt16(ENDGAME_SCALE * endgame);
+				int16_t* row = &featureWeights[((size_t)(owner * NUM_CHESS_PIECE_TYPES + type) * NUM_BOARD_SQUARES + square) * NNUE_HIDDEN_SIZE];
+				for (int unit = 0; unit < NNUE_HIDDEN_SIZE; unit++)
+				{
+					row[unit] = unit < PHASE_UNITS ? phaseRow : endgameRow;
+				}
+			}
+		}
+	}
+
+	//each unit clips the next NNUE_ACTIVATION_SCALE wide slice, together they are the identity over their whole range
+	int16_t featureBiases[NNUE_HIDDEN_SIZE] = {};
+	int16_t outputWeights[NUM_CHESS_PLAYERS * NNUE_HIDDEN_SIZE] = {};
+	for (int unit = 0; unit < NNUE_HIDDEN_SIZE; unit++)
+	{
+		int outputWeight = 0;
+		if (unit < PHASE_UNITS)
+		{
+			int phaseBand = unit / UNITS_PER_PHASE_BAND;
+			featureBiases[unit] = (int16_t)(PHASE_BAND_WIDTH / 2 - unit * NNUE_ACTIVATION_SCALE);
+			outputWeight = phaseBand < MAX_GAME_PHASE ? phaseBand : MAX_GAME_PHASE;
+		}
+		else
+		{
+			int endgameUnit = unit - PHASE_UNITS;
+			featureBiases[unit] = (int16_t)((ENDGAME_UNITS / 2 - endgameUnit) * NNUE_ACTIVATION_SCALE);
+			outputWeight = ENDGAME_OUTPUT_WEIGHT;
+		}
+		outputWeights[unit] = (int16_t)outputWeight;
+		outputWeights[NNUE_HIDDEN_SIZE + unit] = (int16_t)-outputWeight;
+	}
+	int32_t outputBias = 0;
+
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	fopen_s(&file, networkFilePath, "wb");
+#else
+	file = fopen(networkFilePath, "wb");
+#endif
+	if (file == nullptr)
+	{
+		printf("Could not write %s\n", networkFilePath);
+		return false;
+	}
+	uint32_t hiddenSize = NNUE_HIDDEN_SIZE;
+	bool isWritten = fwrite("CNN1", 1, 4, file) == 4
+		&& fwrite(&hiddenSize, sizeof(hiddenSize), 1, file) == 1
+		&& fwrite(featureWeights.data(), sizeof(int16_t), featureWeights.size(), file) == featureWeights.size()
+		&& fwrite(featureBiases, sizeof(featureBiases), 1, file) == 1
+		&& fwrite(outputWeights, sizeof(outputWeights), 1, file) == 1
+		&& fwrite(&outputBias, sizeof(outputBias), 1, file) == 1;
+	isWritten = fclose(file) == 0 && isWritten;
+	std::unique_ptr<ChessNNUENetwork> network = std::make_unique<ChessNNUENetwork>();
+	if (!isWritten || !network->LoadFromFile(networkFilePath))
+	{
+		printf("Could not write %s\n", networkFilePath);
+		return false;
+	}
+
+	int largestDifference = 0;
+	double differenceSum = 0.0;
+	uint64_t numPositions = 0;
+	for (PerftTestPosition const& test : PERFT_TEST_POSITIONS)
+	{
+		ChessPosition position;
+		SetPositionForTest(position, test);
+		AddEvaluationDifferences(*network, position, NETWORK_CHECK_DEPTH, largestDifference, differenceSum, numPositions);
+	}
+	printf("%s written, network minus piece-square evaluation over %llu positions: largest %d, average %.2f centipawns\n",
+		networkFilePath, (unsigned long long)numPositions, largestDifference, differenceSum / (double)numPositions);
+	return true;
+}
+
+constexpr int DEFAULT_BOOK_PLIES = 16;
+constexpr int MAX_BOOK_LINE_LENGTH = 8192;
+constexpr const char* BOOK_MOVE_SEPARATORS = " ,\t\r\n";
+
+static bool MakeBook(const char* gamesFilePath, const char* bookFilePath, int numPlies)
+{
+	FILE* gamesFile = nullptr;
+#if defined(_MSC_VER)
+	fopen_s(&gamesFile, gamesFilePath, "r");
+#else
+	gamesFile = fopen(gamesFilePath, "r");
+#endif
+	if (gamesFile == nullptr)
+	{
+		printf("Could not open %s\n", gamesFilePath);
+		return false;
+	}
+
+	//every time a line plays a move it counts once towards that move's weight
+	std::vector<ChessBookEntry> entries;
+	char line[MAX_BOOK_LINE_LENGTH];
+	int lineNumber = 0;
+	int numLines = 0;
+	while (fgets(line, sizeof(line), gamesFile) != nullptr)
+	{
+		lineNumber++;
+		char* comment = strchr(line, '#');
+		if (comment != nullptr)
+		{
+			*comment = '\0';
+		}
+		ChessPosition position;
+		position.SetFromFEN(PERFT_TEST_POSITIONS[0].m_fen);
+		int numLineMoves = 0;
+		const char* moveText = line;
+		while (numLineMoves < numPlies)
+		{
+			moveText += strspn(moveText, BOOK_MOVE_SEPARATORS);
+			int textLength = (int)strcspn(moveText, BOOK_MOVE_SEPARATORS);
+			if (textLength == 0)
+			{
+				break;
+			}
+			ChessMove move = GetLegalMoveForMoveText(position, moveText, textLength);
+			if (move.IsNull())
+			{
+				printf("%s line %d: %.*s is illegal or malformed, the rest of the line is skipped\n", gamesFilePath, lineNumber, textLength, moveText);
+				break;
+			}
+			entries.push_back({ ChessOpeningBook::GetPolyglotKey(position), ChessOpeningBook::GetMoveCode(position, move), 1 });
+			position.MakeMove(move);
+			numLineMoves++;
+			moveText += textLength;
+		}
+		if (numLineMoves > 0)
+		{
+			numLines++;
+		}
+	}
+	fclose(gamesFile);
+
+	if (!ChessOpeningBook::WriteFile(bookFilePath, entries))
+	{
+		printf("Could not write %s\n", bookFilePath);
+		return false;
+	}
+	ChessOpeningBook book;
+	book.Open(bookFilePath);
+	printf("%d lines, %zu moves played -> %zu book entries in %s\n", numLines, entries.size(), book.GetNumEntries(), bookFilePath);
+	return book.IsOpen();
+}
+
+struct PolyglotKeyTest
+{
+	const char* m_fen = nullptr;
+	uint64_t m_key = 0;
+};
+
+//the first nine are the examples of Polyglot's book format description; those always have the black king on e8
+//together with both black castling rights or neither, so the last three split the king's entry from the rights'
+static const PolyglotKeyTest POLYGLOT_KEY_TESTS[] =
+{
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463b96181691fc9cULL },
+	{ "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823c9b50fd114196ULL },
+	{ "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756b94461c50fb0ULL },
+	{ "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662fafb965db29d4ULL },
+	{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22a48b5a8e47ff78ULL },
+	{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652a607ca3f242c1ULL },
+	{ "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00fdd303c946bdd9ULL },
+	{ "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3c8123ea7b067637ULL },
+	{ "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5c3f9b829b279560ULL },
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQq - 0 1", 0xe345f521cbbd0f3cULL },
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQk - 0 1", 0x58cd70c3a707e255ULL },
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQ - 0 1", 0xfdb313fa7a2b11f5ULL },
+};
+constexpr int NUM_POLYGLOT_KEY_TESTS = sizeof(POLYGLOT_KEY_TESTS) / sizeof(POLYGLOT_KEY_TESTS[0]);
+
+static int CountPolyglotKeyMismatches()
+{
+	int numMismatches = 0;
+	for (PolyglotKeyTest const& test : POLYGLOT_KEY_TESTS)
+	{
+		ChessPosition position;
+		position.SetFromFEN(test.m_fen);
+		uint64_t key = ChessOpeningBook::GetPolyglotKey(position);
+		if (key != test.m_key)
+		{
+			printf("Polyglot key %016llx, expected %016llx: %s\n", (unsigned long long)key, (unsigned long long)test.m_key, test.m_fen);
+			numMismatches++;
+		}
+	}
+	printf("%d of %d Polyglot keys match\n", NUM_POLYGLOT_KEY_TESTS - numMismatches, NUM_POLYGLOT_KEY_TESTS);
+	return numMismatches;
+}
+
+static bool RunBookProbe(PerftTestPosition const& test, ChessOpeningBook const& book)
+{
+	ChessPosition position;
+	SetPositionForTest(position, test);
+
+	ChessBookMove bookMoves[ChessOpeningBook::MAX_MOVES_PER_POSITION];
+	auto startTime = std::chrono::steady_clock::now();
+	int numBookMoves = book.GetBookMoves(position, bookMoves, ChessOpeningBook::MAX_MOVES_PER_POSITION);
+	double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+
+	printf("%-10s key %016llx  %d book moves in %.1f us:", test.m_name, (unsigned long long)ChessOpeningBook::GetPolyglotKey(position), numBookMoves, microseconds);
+	for (int i = 0; i < numBookMoves; i++)
+	{
+		char moveText[MAX_MOVE_TEXT_LENGTH] = {};
+		WriteMoveText(bookMoves[i].m_move, moveText);
+		printf(" %s (%d)", moveText, bookMoves[i].m_weight);
+	}
+	printf("\n");
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const char* positionName = "all";
+	const char* customFen = nullptr;
+	const char* movesText = nullptr;
+	int depth = 0;//0 = each position's default depth
+	bool isDivide = false;
+	bool isStatusBenchmark = false;
+	bool isSearchBenchmark = false;
+	SearchBenchmarkSettings searchSettings;
+	const char* bookFilePath = nullptr;
+	const char* gamesFilePath = nullptr;
+	int numBookPlies = DEFAULT_BOOK_PLIES;
+	bool isMakingNetwork = false;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (strncmp(arg, "position=", 9) == 0)
+		{
+			positionName = arg + 9;
+		}
+		else if (strncmp(arg, "fen=", 4) == 0)
+		{
+			customFen = arg + 4;
+		}
+		else if (strncmp(arg, "moves=", 6) == 0)
+		{
+			movesText = arg + 6;
+		}
+		else if (strncmp(arg, "depth=", 6) == 0)
+		{
+			depth = atoi(arg + 6);
+		}
+		else if (strcmp(arg, "divide=true") == 0)
+		{
+			isDivide = true;
+		}
+		else if (strcmp(arg, "status=true") == 0)
+		{
+			isStatusBenchmark = true;
+		}
+		else if (strcmp(arg, "search=true") == 0)
+		{
+			isSearchBenchmark = true;
+		}
+		else if (strncmp(arg, "threads=", 8) == 0)
+		{
+			searchSettings.m_numThreads = atoi(arg + 8);
+		}
+		else if (strncmp(arg, "hash=", 5) == 0)
+		{
+			searchSettings.m_hashSizeInMB = atoi(arg + 5);
+		}
+		else if (strcmp(arg, "hugepages=true") == 0)
+		{
+			searchSettings.m_isUsingHugePages = true;
+		}
+		else if (strncmp(arg, "nnue=", 5) == 0)
+		{
+			searchSettings.m_networkFile = arg + 5;
+		}
+		else if (strcmp(arg, "makennue=true") == 0)
+		{
+			isMakingNetwork = true;
+		}
+		else if (strncmp(arg, "tablebases=", 11) == 0)
+		{
+			searchSettings.m_tablebaseDirectory = arg + 11;
+		}
+		else if (strncmp(arg, "book=", 5) == 0)
+		{
+			bookFilePath = arg + 5;
+		}
+		else if (strncmp(arg, "makebook=", 9) == 0)
+		{
+			gamesFilePath = arg + 9;
+		}
+		else if (strncmp(arg, "bookplies=", 10) == 0)
+		{
+			numBookPlies = atoi(arg + 10);
+		}
+		else
+		{
+			printf("Unknown argument %s\nusage: chess_perft [position=<name>|all] [fen=\"<FEN>\"] [moves=\"<e2e4 e7e5 ...>\"] [depth=<n>] [divide=true] [status=true] [search=true] [threads=<n>] [hash=<MB>] [hugepages=true] [nnue=<file>] [makennue=true] [tablebases=<dir>] [book=<file>] [makebook=<file>] [bookplies=<n>]\n", arg);
+			return 2;
+		}
+	}
+	int maxDepth = isSearchBenchmark ? MAX_SEARCH_DEPTH : MAX_PERFT_DEPTH;
+	if (depth < 0 || depth > maxDepth)
+	{
+		printf("Invalid depth %d, must be between 1 and %d\n", depth, maxDepth);
+		return 2;
+	}
+	if (searchSettings.m_numThreads < 1 || searchSettings.m_numThreads > MAX_SEARCH_THREADS)
+	{
+		printf("Invalid threads %d, must be between 1 and %d\n", searchSettings.m_numThreads, MAX_SEARCH_THREADS);
+		return 2;
+	}
+	if (searchSettings.m_hashSizeInMB < 1 || searchSettings.m_hashSizeInMB > ChessTranspositionTable::MAX_SIZE_MB)
+	{
+		printf("Invalid hash %d, must be between 1 and %d MB\n", searchSettings.m_hashSizeInMB, ChessTranspositionTable::MAX_SIZE_MB);
+		return 2;
+	}
+
+	InitializeChessAttackTables();
+
+	if (gamesFilePath != nullptr)
+	{
+		if (bookFilePath == nullptr)
+		{
+			printf("makebook= needs book= to write to\n");
+			return 2;
+		}
+		return MakeBook(gamesFilePath, bookFilePath, numBookPlies) ? 0 : 1;
+	}
+	if (isMakingNetwork)
+	{
+		if (searchSettings.m_networkFile == nullptr)
+		{
+			printf("makennue=true needs nnue= to write to\n");
+			return 2;
+		}
+		return MakePieceSquareNetwork(searchSettings.m_networkFile) ? 0 : 1;
+	}
+	ChessOpeningBook book;
+	if (bookFilePath != nullptr && !book.Open(bookFilePath))
+	{
+		printf("Could not open book %s\n", bookFilePath);
+		return 2;
+	}
+	int numKeyMismatches = book.IsOpen() ? CountPolyglotKeyMismatches() : 0;
+
+	const PerftTestPosition* tests = PERFT_TEST_POSITIONS;
+	int numTests = NUM_PERFT_TEST_POSITIONS;
+	PerftTestPosition customTest;
+	if (customFen != nullptr)
+	{
+		ChessPosition position;
+		if (!position.SetFromFEN(customFen))
+		{
+			printf("Invalid FEN \"%s\"\n", customFen);
+			return 2;
+		}
+		customTest.m_name = "fen";
+		customTest.m_fen = customFen;
+		customTest.m_defaultDepth = 5;
+		tests = &customTest;
+		numTests = 1;
+		positionName = "all";
+	}
+
+	int numRun = 0;
+	int numFailed = 0;
+	for (int i = 0; i < numTests; i++)
+	{
+		PerftTestPosition test = tests[i];
+		if (strcmp(positionName, "all") != 0 && strcmp(positionName, test.m_name) != 0)
+		{
+			continue;
+		}
+		numRun++;
+		if (movesText != nullptr)
+		{
+			//the whole list must replay, a typo would otherwise silently count a different position
+			ChessPosition position;
+			position.SetFromFEN(test.m_fen);
+			int numMovesApplied = 0;
+			if (ApplyMoveSequence(position, movesText, numMovesApplied) != MOVE_SEQUENCE_ALL_APPLIED)
+			{
+				printf("%-10s move %d of moves= is illegal or malformed\n", test.m_name, numMovesApplied + 1);
+				numFailed++;
+				continue;
+			}
+			test.m_moves = movesText;
+			for (uint64_t& expectedNodes : test.m_expectedNodes)
+			{
+				expectedNodes = 0;
+			}
+		}
+		bool isPassed = false;
+		if (book.IsOpen())
+		{
+			isPassed = RunBookProbe(test, book);
+		}
+		else if (isSearchBenchmark)
+		{
+			isPassed = RunSearchBenchmark(test, depth > 0 ? depth : DEFAULT_SEARCH_DEPTH, searchSettings);
+		}
+		else if (isStatusBenchmark)
+		{
+			//every move of the walk does several times the work of a perft leaf, so go one ply shallower by default
+			isPassed = RunStatusBenchmark(test, depth > 0 ? depth : test.m_defaultDepth - 1);
+		}
+		else
+		{
+			isPassed = RunPerftTest(test, depth > 0 ? depth : test.m_defaultDepth, isDivide);
+		}
+		if (!isPassed)
+		{
+			numFailed++;
+		}
+	}
+
+	if (numRun == 0)
+	{
+		printf("Unknown position %s\n", positionName);
+		return 2;
+	}
+	printf("%d of %d %s tests passed\n", numRun - numFailed, numRun, book.IsOpen() ? "book" : (isSearchBenchmark ? "search" : (isStatusBenchmark ? "status" : "perft")));
+	return numFailed == 0 && numKeyMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,401 @@
+#include "ChessTablebaseGen/ChessTablebaseGenerator.hpp"
+#include "Game/ChessMoveGen.hpp"
+#include "Game/ChessAttacks.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+
+constexpr uint8_t NO_PLIES = 255;
+
+//what the captures and promotions of one position lead to, seen from the replying player
+struct ChessConversionSummary
+{
+	uint8_t m_minLossPlies = NO_PLIES;//fastest loss among them, NO_PLIES if none loses
+	uint8_t m_maxWinPlies = 0;//slowest win among them, NO_PLIES if one of them does not win
+};
+
+//one per thread, ChessPosition carries its undo stack and is too big to copy around
+struct ChessTablebaseGenThread
+{
+	std::unique_ptr<ChessPosition> m_position = std::make_unique<ChessPosition>();
+	ChessMoveList m_moves;
+	size_t m_numChanged = 0;
+	size_t m_numDeferred = 0;
+	bool m_isMissingChildTable = false;
+};
+
+
+//false for impossible placements: two pieces on a square, a pawn on the first or last rank,
+//or the player who just moved left in check
+static bool SetUpPosition(ChessTablebaseMaterial const& material, int const* squares, int sideToMove, ChessPosition& position)
+{
+	Bitboard occupied = EMPTY_BITBOARD;
+	for (int i = 0; i < material.m_numPieces; i++)
+	{
+		Bitboard square = GetBitboardForSquare(squares[i]);
+		if ((occupied & square) != EMPTY_BITBOARD)
+		{
+			return false;
+		}
+		if (material.m_types[i] == ChessPieceType::PAWN && (square & (RANK_1_BITBOARD | RANK_8_BITBOARD)) != EMPTY_BITBOARD)
+		{
+			return false;
+		}
+		occupied |= square;
+	}
+
+	position.Clear();
+	for (int i = 0; i < material.m_numPieces; i++)
+	{
+		position.SetPieceAtSquare(squares[i], material.m_types[i], material.m_sides[i]);
+	}
+	position.SetPlayerToMove(sideToMove);
+	return !IsPlayerInCheck(position, 1 - sideToMove);
+}
+
+static bool IsConversion(ChessMove move)
+{
+	return move.IsCapture() || move.IsPromotion();
+}
+
+static bool SummarizeConversions(ChessTablebases const& childTables, ChessPosition& position, ChessMoveList const& moves, ChessConversionSummary& out)
+{
+	out = ChessConversionSummary();
+	for (ChessMove move : moves)
+	{
+		if (!IsConversion(move))
+		{
+			continue;
+		}
+		ChessTablebaseResult childResult;
+		position.MakeMove(move);
+		bool isProbed = childTables.Probe(position, childResult);
+		position.UnmakeMove();
+		if (!isProbed)
+		{
+			return false;
+		}
+		if (childResult.m_wdl < 0)
+		{
+			out.m_minLossPlies = (uint8_t)std::min<int>(out.m_minLossPlies, childResult.m_pliesToMate);
+		}
+		else
+		{
+			out.m_maxWinPlies = childResult.m_wdl > 0 ? (uint8_t)std::max<int>(out.m_maxWinPlies, childResult.m_pliesToMate) : NO_PLIES;
+		}
+	}
+	return true;
+}
+
+//the result the children's codes give this position: a win one ply after the fastest losing reply, a loss one ply after
+//the slowest win if every reply wins, a draw (so far) otherwise; children still unsettled read as draws
+static uint8_t GetCodeFromChildren(ChessTablebaseMaterial const& material, uint8_t const* codes, int const* squares, int sideToMove,
+	ChessMoveList const& moves, ChessConversionSummary const& conversions)
+{
+	int minLossPlies = conversions.m_minLossPlies;
+	int maxWinPlies = conversions.m_maxWinPlies;
+	int childSquares[MAX_TABLEBASE_PIECES] = {};
+	for (ChessMove move : moves)
+	{
+		if (IsConversion(move))
+		{
+			continue;
+		}
+		memcpy(childSquares, squares, sizeof(childSquares));
+		for (int i = 0; i < material.m_numPieces; i++)
+		{
+			if (childSquares[i] == move.GetFromSquare())
+			{
+				childSquares[i] = move.GetToSquare();
+				break;
+			}
+		}
+		uint8_t childCode = codes[material.GetIndex(childSquares, 1 - sideToMove)];
+		ChessTablebaseResult childResult = GetTablebaseResultForCode(childCode);
+		if (childResult.m_wdl < 0)
+		{
+			minLossPlies = std::min(minLossPlies, childResult.m_pliesToMate);
+		}
+		else
+		{
+			maxWinPlies = childResult.m_wdl > 0 ? std::max(maxWinPlies, childResult.m_pliesToMate) : NO_PLIES;
+		}
+	}
+
+	ChessTablebaseResult result;
+	if (minLossPlies != NO_PLIES)
+	{
+		result.m_wdl = 1;
+		result.m_pliesToMate = minLossPlies + 1;
+	}
+	else if (maxWinPlies != NO_PLIES)
+	{
+		result.m_wdl = -1;
+		result.m_pliesToMate = maxWinPlies + 1;
+	}
+	if (result.m_pliesToMate > MAX_TABLEBASE_PLIES)
+	{
+		return TABLEBASE_CODE_DRAW;
+	}
+	return GetTablebaseCodeForResult(result);
+}
+
+//flags every position one quiet move before this one for the next pass, found by moving the last mover's pieces back:
+//kings, knights and sliders to the empty squares they attack, pawns one or two squares back. flagging a few impossible
+//or settled positions as well costs nothing, they are skipped
+static void FlagPredecessors(ChessTablebaseMaterial const& material, int const* squares, int sideToMove, std::atomic<uint8_t>* isFlagged)
+{
+	int mover = 1 - sideToMove;
+	Bitboard occupied = EMPTY_BITBOARD;
+	for (int i = 0; i < material.m_numPieces; i++)
+	{
+		occupied |= GetBitboardForSquare(squares[i]);
+	}
+
+	int predecessorSquares[MAX_TABLEBASE_PIECES] = {};
+	for (int i = 0; i < material.m_numPieces; i++)
+	{
+		if (material.m_sides[i] != mover)
+		{
+			continue;
+		}
+		Bitboard fromSquares = EMPTY_BITBOARD;
+		if (material.m_types[i] == ChessPieceType::PAWN)
+		{
+			int backward = mover == 0 ? -8 : 8;
+			int oneBack = squares[i] + backward;
+			int doublePushRank = mover == 0 ? 3 : 4;
+			if (oneBack >= 0 && oneBack < NUM_BOARD_SQUARES && !IsSquareInBitboard(occupied, oneBack))
+			{
+				fromSquares |= GetBitboardForSquare(oneBack);
+				if (GetRankForSquare(squares[i]) == doublePushRank && !IsSquareInBitboard(occupied, oneBack + backward))
+				{
+					fromSquares |= GetBitboardForSquare(oneBack + backward);
+				}
+			}
+		}
+		else
+		{
+			fromSquares = GetAttacksForPiece(material.m_types[i], mover, squares[i], occupied) & ~occupied;
+		}
+
+		memcpy(predecessorSquares, squares, sizeof(predecessorSquares));
+		while (fromSquares != EMPTY_BITBOARD)
+		{
+			predecessorSquares[i] = PopLowestSquare(fromSquares);
+			isFlagged[material.GetIndex(predecessorSquares, mover)].store(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+//hands chunks of [0, numIndices) to the threads until none are left, function(thread, begin, end)
+template<typename ChunkFunction>
+static void RunOverChunks(size_t numIndices, std::vector<ChessTablebaseGenThread>& threads, ChunkFunction const& function)
+{
+	constexpr size_t CHUNK_SIZE = ChessTablebaseGenerator::INDICES_PER_CHUNK;
+	std::atomic<size_t> nextChunk = 0;
+	size_t numChunks = (numIndices + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	auto runThread = [&](ChessTablebaseGenThread& thread)
+		{
+			for (size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+			{
+				function(thread, chunk * CHUNK_SIZE, std::min(numIndices, (chunk + 1) * CHUNK_SIZE));
+			}
+		};
+
+	std::vector<std::thread> helperThreads;
+	for (size_t i = 1; i < threads.size(); i++)
+	{
+		helperThreads.emplace_back(runThread, std::ref(threads[i]));
+	}
+	runThread(threads[0]);
+	for (std::thread& helperThread : helperThreads)
+	{
+		helperThread.join();
+	}
+}
+
+
+ChessTablebaseGenerator::ChessTablebaseGenerator(ChessTablebases const& childTables, int numThreads)
+	: m_childTables(childTables)
+	, m_numThreads(std::max(1, numThreads))
+{
+}
+
+std::unique_ptr<ChessTablebase> ChessTablebaseGenerator::Generate(ChessTablebaseMaterial const& material, ChessTablebaseGenStats& outStats)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	outStats = ChessTablebaseGenStats();
+	size_t numEntries = material.GetNumEntries();
+	std::vector<uint8_t> codes(numEntries, TABLEBASE_CODE_DRAW);
+	std::vector<uint8_t> isSettled(numEntries, 0);
+	std::vector<ChessConversionSummary> conversions(numEntries);
+	//which unsettled positions a pass looks at: pass 1 all of them, later passes the predecessors of what the pass
+	//before settled plus whatever waits for its pass. written by every thread, so the flags are atomic
+	std::unique_ptr<std::atomic<uint8_t>[]> isFlagged(new std::atomic<uint8_t>[numEntries]);
+	std::unique_ptr<std::atomic<uint8_t>[]> isNextFlagged(new std::atomic<uint8_t>[numEntries]);
+	std::vector<ChessTablebaseGenThread> threads(m_numThreads);
+
+	//impossible positions, mates, stalemates and what every capture and promotion leads to
+	RunOverChunks(numEntries, threads, [&](ChessTablebaseGenThread& thread, size_t begin, size_t end)
+		{
+			int squares[MAX_TABLEBASE_PIECES] = {};
+			int sideToMove = 0;
+			for (size_t index = begin; index < end && !thread.m_isMissingChildTable; index++)
+			{
+				isFlagged[index].store(0, std::memory_order_relaxed);
+				isNextFlagged[index].store(0, std::memory_order_relaxed);
+				material.GetSquaresForIndex(index, squares, sideToMove);
+				if (!SetUpPosition(material, squares, sideToMove, *thread.m_position))
+				{
+					codes[index] = TABLEBASE_CODE_ILLEGAL;
+					isSettled[index] = 1;
+					continue;
+				}
+				thread.m_moves.Clear();
+				GenerateLegalMoves(*thread.m_position, thread.m_moves);
+				if (thread.m_moves.IsEmpty())
+				{
+					codes[index] = IsPlayerInCheck(*thread.m_position, sideToMove) ? GetTablebaseCodeForResult({ -1, 0 }) : TABLEBASE_CODE_DRAW;
+					isSettled[index] = 1;
+					continue;
+				}
+				thread.m_isMissingChildTable = !SummarizeConversions(m_childTables, *thread.m_position, thread.m_moves, conversions[index]);
+				isFlagged[index].store(1, std::memory_order_relaxed);
+			}
+		});
+	for (ChessTablebaseGenThread const& thread : threads)
+	{
+		if (thread.m_isMissingChildTable)
+		{
+			return nullptr;
+		}
+	}
+
+	//pass n settles the results n plies from mate: a win needs a reply settled as a loss in n - 1, a loss needs every
+	//reply settled as a win. results that only a capture or promotion decides wait for their pass to keep the plies exact
+	std::vector<uint8_t> nextCodes = codes;
+	for (int pass = 1; pass <= MAX_TABLEBASE_PLIES; pass++)
+	{
+		RunOverChunks(numEntries, threads, [&](ChessTablebaseGenThread& thread, size_t begin, size_t end)
+			{
+				int squares[MAX_TABLEBASE_PIECES] = {};
+				int sideToMove = 0;
+				for (size_t index = begin; index < end; index++)
+				{
+					if (isSettled[index] != 0 || isFlagged[index].load(std::memory_order_relaxed) == 0)
+					{
+						continue;
+					}
+					isFlagged[index].store(0, std::memory_order_relaxed);
+					material.GetSquaresForIndex(index, squares, sideToMove);
+					SetUpPosition(material, squares, sideToMove, *thread.m_position);
+					thread.m_moves.Clear();
+					GenerateLegalMoves(*thread.m_position, thread.m_moves);
+					uint8_t code = GetCodeFromChildren(material, codes.data(), squares, sideToMove, thread.m_moves, conversions[index]);
+					if (code == TABLEBASE_CODE_DRAW)
+					{
+						continue;
+					}
+					if (GetTablebaseResultForCode(code).m_pliesToMate > pass)
+					{
+						isNextFlagged[index].store(1, std::memory_order_relaxed);
+						thread.m_numDeferred++;
+						continue;
+					}
+					nextCodes[index] = code;
+					isSettled[index] = 1;
+					thread.m_numChanged++;
+					FlagPredecessors(material, squares, sideToMove, isNextFlagged.get());
+				}
+			});
+
+		size_t numChanged = 0;
+		size_t numDeferred = 0;
+		for (ChessTablebaseGenThread& thread : threads)
+		{
+			numChanged += thread.m_numChanged;
+			numDeferred += thread.m_numDeferred;
+			thread.m_numChanged = 0;
+			thread.m_numDeferred = 0;
+		}
+		codes = nextCodes;
+		std::swap(isFlagged, isNextFlagged);
+		outStats.m_numPasses = pass;
+		if (numChanged == 0 && numDeferred == 0)
+		{
+			break;
+		}
+	}
+
+	for (size_t index = 0; index < numEntries; index++)
+	{
+		if (codes[index] == TABLEBASE_CODE_ILLEGAL)
+		{
+			continue;
+		}
+		ChessTablebaseResult result = GetTablebaseResultForCode(codes[index]);
+		outStats.m_numPositions++;
+		outStats.m_numWins += result.m_wdl > 0 ? 1 : 0;
+		outStats.m_numDraws += result.m_wdl == 0 ? 1 : 0;
+		outStats.m_numLosses += result.m_wdl < 0 ? 1 : 0;
+		if (result.m_pliesToMate > outStats.m_maxPliesToMate)
+		{
+			outStats.m_maxPliesToMate = result.m_pliesToMate;
+			outStats.m_maxPliesToMateIndex = index;
+		}
+	}
+
+	std::unique_ptr<ChessTablebase> table = std::make_unique<ChessTablebase>();
+	table->SetCodes(material, std::move(codes));
+	outStats.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return table;
+}
+
+size_t ChessTablebaseGenerator::Verify(ChessTablebase const& table)
+{
+	ChessTablebaseMaterial const& material = table.GetMaterial();
+	size_t numEntries = material.GetNumEntries();
+	std::vector<uint8_t> codes(numEntries);
+	for (size_t index = 0; index < numEntries; index++)
+	{
+		codes[index] = table.GetCode(index);
+	}
+	std::vector<ChessTablebaseGenThread> threads(m_numThreads);
+	std::atomic<size_t> numMismatches = 0;
+
+	RunOverChunks(numEntries, threads, [&](ChessTablebaseGenThread& thread, size_t begin, size_t end)
+		{
+			int squares[MAX_TABLEBASE_PIECES] = {};
+			int sideToMove = 0;
+			ChessConversionSummary conversions;
+			for (size_t index = begin; index < end; index++)
+			{
+				material.GetSquaresForIndex(index, squares, sideToMove);
+				uint8_t expectedCode = TABLEBASE_CODE_ILLEGAL;
+				if (SetUpPosition(material, squares, sideToMove, *thread.m_position))
+				{
+					thread.m_moves.Clear();
+					GenerateLegalMoves(*thread.m_position, thread.m_moves);
+					if (thread.m_moves.IsEmpty())
+					{
+						expectedCode = IsPlayerInCheck(*thread.m_position, sideToMove) ? GetTablebaseCodeForResult({ -1, 0 }) : TABLEBASE_CODE_DRAW;
+					}
+					else if (SummarizeConversions(m_childTables, *thread.m_position, thread.m_moves, conversions))
+					{
+						expectedCode = GetCodeFromChildren(material, codes.data(), squares, sideToMove, thread.m_moves, conversions);
+					}
+				}
+				if (expectedCode != codes[index])
+				{
+					numMismatches++;
+				}
+			}
+		});
+	return numMismatches;
+}
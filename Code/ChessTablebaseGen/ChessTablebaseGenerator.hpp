@@ -0,0 +1,44 @@
+#pragma once
+#include "Game/ChessTablebase.hpp"
+
+#include <cstddef>
+#include <memory>
+
+
+struct ChessTablebaseGenStats
+{
+	size_t m_numPositions = 0;//legal ones, both sides to move
+	size_t m_numWins = 0;//for the player to move
+	size_t m_numDraws = 0;
+	size_t m_numLosses = 0;
+	int m_maxPliesToMate = 0;
+	size_t m_maxPliesToMateIndex = 0;
+	int m_numPasses = 0;
+	double m_seconds = 0.0;
+};
+
+
+//builds one table by retrograde analysis in passes over the index space, each position scored from its children:
+//a first pass marks the impossible positions, the mates and stalemates, and sums up what every capture and promotion
+//leads to (looked up in the smaller, already built tables); pass n then settles every position whose result is
+//decided by children settled before it, the wins in n plies and the losses whose replies all win, until a pass
+//changes nothing and whatever is left is a draw. after the first pass only the positions one un-move before a newly settled
+//one are looked at again. every pass reads the previous pass's codes and writes a second buffer, so the index space
+//splits into chunks the threads take one at a time with no locking
+class ChessTablebaseGenerator
+{
+public:
+	ChessTablebaseGenerator(ChessTablebases const& childTables, int numThreads);
+
+	//null if a table a capture or promotion leads to is not in childTables
+	std::unique_ptr<ChessTablebase> Generate(ChessTablebaseMaterial const& material, ChessTablebaseGenStats& outStats);
+	//checks every code against its children once more, a table read back from disk included; returns how many disagree
+	size_t Verify(ChessTablebase const& table);
+
+public:
+	static constexpr size_t INDICES_PER_CHUNK = 16384;
+
+private:
+	ChessTablebases const& m_childTables;
+	int m_numThreads = 1;
+};
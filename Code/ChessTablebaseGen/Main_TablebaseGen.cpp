@@ -0,0 +1,204 @@
+//chess_tbgen: builds the endgame tablebases the game probes, win/draw/loss and distance to mate for every
+//position of 3 and 4 pieces (kings included), one ChessTablebase file per material split
+//only the headless rule code is linked, there is no Renderer, AudioSystem or Engine here
+//
+//usage: chess_tbgen [tables=all|<name>,<name>,...] [out=<directory>] [threads=<n>] [verify=true]
+//tables= names material splits strongest side first (KQK, KRK, KPK, KRKP, KBNK, ...), default all 35 of them;
+//the smaller tables their captures and promotions lead to are read from out= when present and built first when not
+//out= is where the .ctb files go (default Data/Tablebases, run from the Run folder like the game)
+//threads= splits every pass over the index space across that many threads (default: every hardware thread)
+//verify=true checks every code against its children once more after building or loading it
+
+#include "ChessTablebaseGen/ChessTablebaseGenerator.hpp"
+#include "Game/ChessAttacks.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+constexpr const char* DEFAULT_TABLEBASE_DIRECTORY = "Data/Tablebases";
+constexpr int MAX_GEN_THREADS = 256;
+
+
+static bool ParseTableNames(const char* text, std::vector<std::string> const& allNames, std::vector<std::string>& outNames)
+{
+	if (strcmp(text, "all") == 0)
+	{
+		outNames = allNames;
+		return true;
+	}
+	while (*text != '\0')
+	{
+		size_t length = strcspn(text, ",");
+		std::string name(text, length);
+		if (std::find(allNames.begin(), allNames.end(), name) == allNames.end())
+		{
+			printf("Unknown table %s, names list the stronger side first with pieces in QRBNP order (KRKP, not KPKR)\n", name.c_str());
+			return false;
+		}
+		outNames.push_back(name);
+		text += length;
+		text += strspn(text, ",");
+	}
+	return !outNames.empty();
+}
+
+static void AddTableWithDependencies(std::string const& name, std::vector<std::string>& neededNames)
+{
+	if (std::find(neededNames.begin(), neededNames.end(), name) != neededNames.end())
+	{
+		return;
+	}
+	neededNames.push_back(name);
+	ChessTablebaseMaterial material;
+	material.SetFromName(name.c_str());
+	std::vector<std::string> dependencies;
+	GetTablebaseDependencies(material, dependencies);
+	for (std::string const& dependency : dependencies)
+	{
+		AddTableWithDependencies(dependency, neededNames);
+	}
+}
+
+static void WriteFENForIndex(ChessTablebaseMaterial const& material, size_t index, char* out, int outSize)
+{
+	int squares[MAX_TABLEBASE_PIECES] = {};
+	int sideToMove = 0;
+	material.GetSquaresForIndex(index, squares, sideToMove);
+	ChessPosition position;
+	position.Clear();
+	for (int i = 0; i < material.m_numPieces; i++)
+	{
+		position.SetPieceAtSquare(squares[i], material.m_types[i], material.m_sides[i]);
+	}
+	position.SetPlayerToMove(sideToMove);
+	position.WriteFEN(out, outSize);
+}
+
+static void PrintStats(ChessTablebaseMaterial const& material, ChessTablebaseGenStats const& stats)
+{
+	double entriesPerSecond = stats.m_seconds > 0.0 ? (double)material.GetNumEntries() / stats.m_seconds : 0.0;
+	printf("%-6s entries %10zu  positions %10zu  wins %10zu  draws %10zu  losses %10zu  passes %3d  %8.3f s  %7.2f M entries/s\n",
+		material.m_name, material.GetNumEntries(), stats.m_numPositions, stats.m_numWins, stats.m_numDraws, stats.m_numLosses,
+		stats.m_numPasses, stats.m_seconds, entriesPerSecond / 1000000.0);
+	if (stats.m_maxPliesToMate > 0)
+	{
+		char fen[ChessPosition::MAX_FEN_LENGTH] = {};
+		WriteFENForIndex(material, stats.m_maxPliesToMateIndex, fen, sizeof(fen));
+		printf("       longest mate %d plies: %s\n", stats.m_maxPliesToMate, fen);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* tablesText = "all";
+	const char* outDirectory = DEFAULT_TABLEBASE_DIRECTORY;
+	int numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+	bool isVerifying = false;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (strncmp(arg, "tables=", 7) == 0)
+		{
+			tablesText = arg + 7;
+		}
+		else if (strncmp(arg, "out=", 4) == 0)
+		{
+			outDirectory = arg + 4;
+		}
+		else if (strncmp(arg, "threads=", 8) == 0)
+		{
+			numThreads = atoi(arg + 8);
+		}
+		else if (strcmp(arg, "verify=true") == 0)
+		{
+			isVerifying = true;
+		}
+		else
+		{
+			printf("Unknown argument %s\nusage: chess_tbgen [tables=all|<name>,<name>,...] [out=<directory>] [threads=<n>] [verify=true]\n", arg);
+			return 2;
+		}
+	}
+	if (numThreads < 1 || numThreads > MAX_GEN_THREADS)
+	{
+		printf("Invalid threads %d, must be between 1 and %d\n", numThreads, MAX_GEN_THREADS);
+		return 2;
+	}
+
+	std::vector<std::string> allNames;
+	GetAllTablebaseNames(allNames);
+	std::vector<std::string> requestedNames;
+	if (!ParseTableNames(tablesText, allNames, requestedNames))
+	{
+		return 2;
+	}
+	std::vector<std::string> neededNames;
+	for (std::string const& name : requestedNames)
+	{
+		AddTableWithDependencies(name, neededNames);
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(outDirectory, error);
+	if (error)
+	{
+		printf("Could not create %s: %s\n", outDirectory, error.message().c_str());
+		return 2;
+	}
+
+	InitializeChessAttackTables();
+	printf("%zu tables with %d threads into %s\n", neededNames.size(), numThreads, outDirectory);
+
+	//allNames puts every table after the ones it depends on
+	ChessTablebases tables;
+	ChessTablebaseGenerator generator(tables, numThreads);
+	int numFailed = 0;
+	for (std::string const& name : allNames)
+	{
+		if (std::find(neededNames.begin(), neededNames.end(), name) == neededNames.end())
+		{
+			continue;
+		}
+		std::string filePath = std::string(outDirectory) + "/" + name + ".ctb";
+		bool isRequested = std::find(requestedNames.begin(), requestedNames.end(), name) != requestedNames.end();
+		std::unique_ptr<ChessTablebase> table = std::make_unique<ChessTablebase>();
+		if (!isRequested && table->Open(filePath.c_str()))
+		{
+			printf("%-6s read from %s\n", name.c_str(), filePath.c_str());
+		}
+		else
+		{
+			ChessTablebaseMaterial material;
+			material.SetFromName(name.c_str());
+			ChessTablebaseGenStats stats;
+			table = generator.Generate(material, stats);
+			if (table == nullptr)
+			{
+				printf("%-6s could not be built, a table it depends on is missing\n", name.c_str());
+				return 1;
+			}
+			PrintStats(material, stats);
+			if (!table->WriteFile(filePath.c_str()))
+			{
+				printf("Could not write %s\n", filePath.c_str());
+				return 1;
+			}
+		}
+
+		if (isVerifying)
+		{
+			size_t numMismatches = generator.Verify(*table);
+			printf("%-6s verify: %s (%zu mismatches)\n", name.c_str(), numMismatches == 0 ? "PASS" : "FAIL", numMismatches);
+			numFailed += numMismatches == 0 ? 0 : 1;
+		}
+		tables.AddTable(std::move(table));
+	}
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#include "Game/ChessAIPlayer.hpp"
+#include "Game/ChessMatch.hpp"
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+
+ChessAIPlayer::ChessAIPlayer()
+{
+	m_limits.m_maxMilliseconds = 1000;
+}
+
+ChessAIPlayer::~ChessAIPlayer()
+{
+	Cancel();
+}
+
+void ChessAIPlayer::Update(ChessMatch* match, bool isAITurn)
+{
+	if (IsSearching())
+	{
+		if (!m_isSearchFinished)
+		{
+			return;
+		}
+		m_searchThread.join();
+		if (isAITurn)
+		{
+			PlaySearchResult(match);
+		}
+		return;
+	}
+
+	bool isMovePending = match != nullptr && match->GetMatchID() == m_searchedMatchID && match->GetPosition().GetHash() == m_playedPositionHash;
+	if (match != nullptr && isAITurn && !isMovePending && !PlayTablebaseMove(match) && !PlayBookMove(match))
+	{
+		StartSearch(*match);
+	}
+}
+
+void ChessAIPlayer::Cancel()
+{
+	if (IsSearching())
+	{
+		m_search.RequestStop();
+		m_searchThread.join();
+	}
+	m_isSearchFinished = false;
+}
+
+void ChessAIPlayer::SetIsPlayingForPlayer(int playerIndex, bool isPlaying)
+{
+	m_isPlayingForPlayer[playerIndex] = isPlaying;
+}
+
+bool ChessAIPlayer::IsPlayingForPlayer(int playerIndex) const
+{
+	return m_isPlayingForPlayer[playerIndex];
+}
+
+void ChessAIPlayer::SetSearchLimits(ChessSearchLimits const& limits)
+{
+	m_limits = limits;
+}
+
+ChessSearchLimits const& ChessAIPlayer::GetSearchLimits() const
+{
+	return m_limits;
+}
+
+void ChessAIPlayer::SetNumSearchThreads(int numThreads)
+{
+	m_numSearchThreads = numThreads;
+}
+
+int ChessAIPlayer::GetNumSearchThreads() const
+{
+	return m_numSearchThreads;
+}
+
+void ChessAIPlayer::SetTranspositionTableSize(int sizeInMB, bool isUsingHugePages)
+{
+	Cancel();
+	m_search.GetTranspositionTable().Resize(sizeInMB, isUsingHugePages);
+}
+
+bool ChessAIPlayer::LoadEvaluationNetwork(const char* filePath)
+{
+	Cancel();
+	return m_search.LoadNetwork(filePath);
+}
+
+bool ChessAIPlayer::LoadOpeningBook(const char* filePath)
+{
+	if (filePath == nullptr || filePath[0] == '\0')
+	{
+		m_book.Close();
+		return true;
+	}
+	return m_book.Open(filePath);
+}
+
+int ChessAIPlayer::LoadTablebases(const char* directoryPath)
+{
+	Cancel();
+	return m_search.LoadTablebases(directoryPath);
+}
+
+bool ChessAIPlayer::IsSearching() const
+{
+	return m_searchThread.joinable();
+}
+
+bool ChessAIPlayer::PlayTablebaseMove(ChessMatch* match)
+{
+	ChessPosition const& position = match->GetPosition();
+	ChessMove move;
+	ChessTablebaseResult result;
+	if (!m_search.GetTablebases().GetBestMove(position, move, result))
+	{
+		return false;
+	}
+
+	m_searchedMatchID = match->GetMatchID();
+	m_searchedPositionHash = position.GetHash();
+	if (result.m_wdl == 0)
+	{
+		PrintInfoMsgToConsole("AI: tablebase move, draw");
+	}
+	else
+	{
+		PrintInfoMsgToConsole(Stringf("AI: tablebase move, %s in %d plies", result.m_wdl > 0 ? "mates" : "mated", result.m_pliesToMate));
+	}
+	return QueueMove(match, move);
+}
+
+bool ChessAIPlayer::PlayBookMove(ChessMatch* match)
+{
+	ChessBookMove bookMoves[ChessOpeningBook::MAX_MOVES_PER_POSITION];
+	ChessPosition const& position = match->GetPosition();
+	int numBookMoves = m_book.GetBookMoves(position, bookMoves, ChessOpeningBook::MAX_MOVES_PER_POSITION);
+	if (numBookMoves == 0)
+	{
+		return false;
+	}
+
+	//each move is picked with a chance proportional to its weight
+	int totalWeight = 0;
+	for (int i = 0; i < numBookMoves; i++)
+	{
+		totalWeight += bookMoves[i].m_weight;
+	}
+	int roll = g_randGen.RollRandomIntInRange(0, totalWeight - 1);
+	int chosenIndex = 0;
+	while (roll >= bookMoves[chosenIndex].m_weight)
+	{
+		roll -= bookMoves[chosenIndex].m_weight;
+		chosenIndex++;
+	}
+
+	m_searchedMatchID = match->GetMatchID();
+	m_searchedPositionHash = position.GetHash();
+	PrintInfoMsgToConsole(Stringf("AI: book move, weight %d of %d", bookMoves[chosenIndex].m_weight, totalWeight));
+	return QueueMove(match, bookMoves[chosenIndex].m_move);
+}
+
+void ChessAIPlayer::StartSearch(ChessMatch const& match)
+{
+	ChessPosition const& position = match.GetPosition();
+	m_searchedMatchID = match.GetMatchID();
+	m_searchedPositionHash = position.GetHash();
+
+	//the worker gets its own copies, the match keeps changing on the main thread
+	m_isSearchFinished = false;
+	m_search.ClearStopRequest();
+	m_search.SetNumThreads(m_numSearchThreads);
+	ChessSearchLimits limits = m_limits;
+	m_searchThread = std::thread([this, position, limits]()
+		{
+			m_searchResult = m_search.Search(position, limits);
+			m_isSearchFinished = true;
+		});
+}
+
+void ChessAIPlayer::PlaySearchResult(ChessMatch* match)
+{
+	m_isSearchFinished = false;
+	if (match == nullptr || match->IsMatchFinished() || match->GetMatchID() != m_searchedMatchID
+		|| match->GetPosition().GetHash() != m_searchedPositionHash || m_searchResult.m_bestMove.IsNull())
+	{
+		return;
+	}
+
+	PrintInfoMsgToConsole(Stringf("AI: depth %d, score %d, %llu nodes in %.2f s, hashfull %d",
+		m_searchResult.m_depth, m_searchResult.m_score, (unsigned long long)m_searchResult.m_nodes, m_searchResult.m_seconds, m_searchResult.m_hashfull));
+	QueueMove(match, m_searchResult.m_bestMove);
+}
+
+bool ChessAIPlayer::QueueMove(ChessMatch* match, ChessMove move)
+{
+	EventArgs args;
+	args.SetValue("from", GetSquareCoordsForBoardCoords(GetBoardCoordsForBoardStateIndex(move.GetFromSquare())));
+	args.SetValue("to", GetSquareCoordsForBoardCoords(GetBoardCoordsForBoardStateIndex(move.GetToSquare())));
+	if (move.IsPromotion())
+	{
+		static const char* PROMOTION_NAMES[4] = { "knight", "bishop", "rook", "queen" };
+		args.SetValue("promoteTo", PROMOTION_NAMES[move.GetFlags() & 3]);
+	}
+
+	if (!match->QueueMoveCommand(args))
+	{
+		return false;
+	}
+	m_playedPositionHash = m_searchedPositionHash;
+	return true;
+}
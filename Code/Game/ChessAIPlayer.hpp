@@ -0,0 +1,59 @@
+#pragma once
+#include "Game/ChessSearch.hpp"
+#include "Game/ChessOpeningBook.hpp"
+
+#include <atomic>
+#include <thread>
+
+class ChessMatch;
+
+
+//computer opponent: plays the tablebase move in an ending the tables cover, a book move if the opening book knows
+//the position, otherwise searches it on a worker thread so rendering keeps going; every move goes through the same
+//QueueMoveCommand path as a chessmove command
+class ChessAIPlayer
+{
+public:
+	ChessAIPlayer();
+	~ChessAIPlayer();
+
+	//isAITurn: the player to move is played by the computer on this machine
+	void Update(ChessMatch* match, bool isAITurn);
+	void Cancel();//stops and joins a running search, its move is dropped
+
+	void SetIsPlayingForPlayer(int playerIndex, bool isPlaying);
+	bool IsPlayingForPlayer(int playerIndex)const;
+	void SetSearchLimits(ChessSearchLimits const& limits);
+	ChessSearchLimits const& GetSearchLimits()const;
+	void SetNumSearchThreads(int numThreads);//takes effect from the next search
+	int GetNumSearchThreads()const;
+	void SetTranspositionTableSize(int sizeInMB, bool isUsingHugePages);//cancels a running search
+	bool LoadEvaluationNetwork(const char* filePath);//cancels a running search, false keeps the piece-square evaluation
+	bool LoadOpeningBook(const char* filePath);//false leaves the AI without a book, an empty path just closes it
+	int LoadTablebases(const char* directoryPath);//cancels a running search, returns how many tables were found
+	bool IsSearching()const;
+
+private:
+	bool PlayTablebaseMove(ChessMatch* match);//false if no table covers the match position
+	bool PlayBookMove(ChessMatch* match);//false if the book has no move for the match position
+	void StartSearch(ChessMatch const& match);
+	void PlaySearchResult(ChessMatch* match);
+	bool QueueMove(ChessMatch* match, ChessMove move);
+
+private:
+	bool m_isPlayingForPlayer[NUM_CHESS_PLAYERS] = { false, false };
+	ChessSearchLimits m_limits;
+	int m_numSearchThreads = 1;
+
+	ChessSearch m_search;
+	ChessOpeningBook m_book;
+	std::thread m_searchThread;
+	std::atomic<bool> m_isSearchFinished = false;
+	ChessSearchResult m_searchResult;//written by the worker, read after m_isSearchFinished
+
+	//the position the running search was started for, a result for anything else is stale
+	int m_searchedMatchID = -1;
+	uint64_t m_searchedPositionHash = 0;
+	//a queued move is only made on the match's next update, do not search the same position again meanwhile
+	uint64_t m_playedPositionHash = 0;
+};
@@ -0,0 +1,173 @@
+#include "Game/ChessAttackMap.hpp"
+#include "Game/ChessAttacks.hpp"
+#include "Game/ChessMoveGen.hpp"
+
+
+ChessAttackMap::ChessAttackMap()
+{
+}
+
+ChessAttackMap::~ChessAttackMap()
+{
+}
+
+void ChessAttackMap::Rebuild(ChessPosition const& position)
+{
+	Bitboard occupied = position.GetOccupied();
+	for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+	{
+		ChessPieceType type = position.GetPieceTypeAtSquare(square);
+		m_attacksBySquare[square] = GetAttacksForPiece(type, position.GetPlayerIndexAtSquare(square), square, occupied);
+	}
+	UpdatePlayerAttacks(position);
+}
+
+void ChessAttackMap::UpdateForChangedSquares(ChessPosition const& position, Bitboard changedSquares)
+{
+	//a slider is affected if its old rays reached a changed square: a blocker left it, or a piece now stands on it
+	Bitboard toRecompute = changedSquares;
+	Bitboard sliders = (position.GetPiecesForType(ChessPieceType::ROOK) | position.GetPiecesForType(ChessPieceType::BISHOP)
+		| position.GetPiecesForType(ChessPieceType::QUEEN)) & ~changedSquares;
+	while (sliders != EMPTY_BITBOARD)
+	{
+		int square = PopLowestSquare(sliders);
+		if (m_attacksBySquare[square] & changedSquares)
+		{
+			toRecompute |= GetBitboardForSquare(square);
+		}
+	}
+
+	Bitboard occupied = position.GetOccupied();
+	while (toRecompute != EMPTY_BITBOARD)
+	{
+		int square = PopLowestSquare(toRecompute);
+		ChessPieceType type = position.GetPieceTypeAtSquare(square);
+		m_attacksBySquare[square] = GetAttacksForPiece(type, position.GetPlayerIndexAtSquare(square), square, occupied);
+	}
+	UpdatePlayerAttacks(position);
+}
+
+void ChessAttackMap::UpdateForMove(ChessPosition const& position, ChessMove move)
+{
+	UpdateForChangedSquares(position, GetChangedSquaresForMove(move, 1 - position.GetPlayerToMove()));
+}
+
+Bitboard ChessAttackMap::GetAttacksForPlayer(int playerIndex) const
+{
+	return m_attacksByPlayer[playerIndex];
+}
+
+Bitboard ChessAttackMap::GetAttacksForSquare(int square) const
+{
+	return m_attacksBySquare[square];
+}
+
+bool ChessAttackMap::IsPlayerInCheck(ChessPosition const& position, int playerIndex) const
+{
+	int kingSquare = position.GetKingSquare(playerIndex);
+	if (kingSquare == NO_SQUARE)
+	{
+		return false;
+	}
+	return IsSquareInBitboard(m_attacksByPlayer[1 - playerIndex], kingSquare);
+}
+
+Bitboard ChessAttackMap::GetChangedSquaresForMove(ChessMove move, int playerIndex)
+{
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	Bitboard changedSquares = GetBitboardForSquare(fromSquare) | GetBitboardForSquare(toSquare);
+	if (move.IsEnPassant())
+	{
+		changedSquares |= GetBitboardForSquare(GetSquareForFileAndRank(GetFileForSquare(toSquare), GetRankForSquare(fromSquare)));
+	}
+	else if (move.GetFlags() == MOVE_FLAG_KING_CASTLE)
+	{
+		changedSquares |= GetBitboardForSquare(KINGSIDE_ROOK_START_SQUARES[playerIndex]) | GetBitboardForSquare(toSquare - 1);
+	}
+	else if (move.GetFlags() == MOVE_FLAG_QUEEN_CASTLE)
+	{
+		changedSquares |= GetBitboardForSquare(QUEENSIDE_ROOK_START_SQUARES[playerIndex]) | GetBitboardForSquare(toSquare + 1);
+	}
+	return changedSquares;
+}
+
+void ChessAttackMap::UpdatePlayerAttacks(ChessPosition const& position)
+{
+	for (int player = 0; player < NUM_CHESS_PLAYERS; player++)
+	{
+		Bitboard attacks = EMPTY_BITBOARD;
+		Bitboard pieces = position.GetPiecesForPlayer(player);
+		while (pieces != EMPTY_BITBOARD)
+		{
+			attacks |= m_attacksBySquare[PopLowestSquare(pieces)];
+		}
+		m_attacksByPlayer[player] = attacks;
+	}
+}
+
+
+static bool HasAnyLegalMove(ChessPosition const& position, ChessAttackMap const& attackMap, bool isInCheck)
+{
+	int playerIndex = position.GetPlayerToMove();
+	int enemyIndex = 1 - playerIndex;
+	int kingSquare = position.GetKingSquare(playerIndex);
+
+	//most of the time the king alone has a safe square, which the attack map answers without generating moves
+	if (kingSquare != NO_SQUARE)
+	{
+		Bitboard escapes = GetKingAttacks(kingSquare) & ~position.GetPiecesForPlayer(playerIndex) & ~attackMap.GetAttacksForPlayer(enemyIndex);
+		if (isInCheck)
+		{
+			//the king hides the squares behind it from a checking slider, stepping back along that line is not an escape
+			Bitboard enemyPieces = position.GetPiecesForPlayer(enemyIndex);
+			Bitboard sliderCheckers = GetAttackersToSquare(position, kingSquare, position.GetOccupied()) & enemyPieces
+				& ~position.GetPiecesForType(ChessPieceType::PAWN) & ~position.GetPiecesForType(ChessPieceType::KNIGHT) & ~position.GetPiecesForType(ChessPieceType::KING);
+			while (sliderCheckers != EMPTY_BITBOARD)
+			{
+				int checkerSquare = PopLowestSquare(sliderCheckers);
+				escapes &= ~GetLineThrough(kingSquare, checkerSquare) | GetBitboardForSquare(checkerSquare);
+			}
+		}
+		if (escapes != EMPTY_BITBOARD)
+		{
+			return true;
+		}
+
+		//out of check, a piece off every line through the king cannot be pinned, so any target it has is a legal move
+		if (!isInCheck)
+		{
+			Bitboard ownPieces = position.GetPiecesForPlayer(playerIndex);
+			Bitboard unpinnable = ownPieces & ~GetQueenAttacks(kingSquare, EMPTY_BITBOARD) & ~GetBitboardForSquare(kingSquare);
+			Bitboard ownPawns = position.GetPieces(playerIndex, ChessPieceType::PAWN);
+			Bitboard pieces = unpinnable & ~ownPawns;
+			while (pieces != EMPTY_BITBOARD)
+			{
+				if (attackMap.GetAttacksForSquare(PopLowestSquare(pieces)) & ~ownPieces)
+				{
+					return true;
+				}
+			}
+			Bitboard pawns = unpinnable & ownPawns;
+			Bitboard pushes = (playerIndex == 0 ? pawns << 8 : pawns >> 8) & ~position.GetOccupied();
+			if (pushes != EMPTY_BITBOARD)
+			{
+				return true;
+			}
+		}
+	}
+
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+	return !moves.IsEmpty();
+}
+
+ChessGameStatus GetGameStatus(ChessPosition const& position, ChessAttackMap const& attackMap)
+{
+	bool isInCheck = attackMap.IsPlayerInCheck(position, position.GetPlayerToMove());
+	if (HasAnyLegalMove(position, attackMap, isInCheck))
+	{
+		return isInCheck ? ChessGameStatus::CHECK : ChessGameStatus::ONGOING;
+	}
+	return isInCheck ? ChessGameStatus::CHECKMATE : ChessGameStatus::STALEMATE;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Game/ChessMove.hpp"
+#include "Game/ChessPosition.hpp"
+
+
+enum class ChessGameStatus
+{
+	ONGOING,
+	CHECK,
+	CHECKMATE,
+	STALEMATE
+};
+
+
+//per side attack bitboards, kept up to date move by move:
+//only the pieces on squares a move touched and the sliders whose rays cross those squares are recomputed
+class ChessAttackMap
+{
+public:
+	ChessAttackMap();
+	~ChessAttackMap();
+
+	void Rebuild(ChessPosition const& position);
+	//position is the one after the changes, works the same for MakeMove and UnmakeMove
+	void UpdateForChangedSquares(ChessPosition const& position, Bitboard changedSquares);
+	//position is the one after MakeMove(move)
+	void UpdateForMove(ChessPosition const& position, ChessMove move);
+
+	Bitboard GetAttacksForPlayer(int playerIndex)const;
+	Bitboard GetAttacksForSquare(int square)const;//attacks of the piece on square, empty if there is none
+	bool IsPlayerInCheck(ChessPosition const& position, int playerIndex)const;
+
+	//squares whose content changes when move is made by playerIndex
+	static Bitboard GetChangedSquaresForMove(ChessMove move, int playerIndex);
+
+private:
+	void UpdatePlayerAttacks(ChessPosition const& position);
+
+private:
+	Bitboard m_attacksBySquare[NUM_BOARD_SQUARES] = {};
+	Bitboard m_attacksByPlayer[NUM_CHESS_PLAYERS] = {};
+};
+
+
+//status of the player to move, the attack map must match position
+ChessGameStatus GetGameStatus(ChessPosition const& position, ChessAttackMap const& attackMap);
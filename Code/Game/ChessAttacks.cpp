@@ -0,0 +1,251 @@
+#include "Game/ChessAttacks.hpp"
+
+#include <atomic>
+#include <mutex>
+
+
+ChessMagicEntry g_rookMagics[NUM_BOARD_SQUARES];
+ChessMagicEntry g_bishopMagics[NUM_BOARD_SQUARES];
+Bitboard g_squaresBetween[NUM_BOARD_SQUARES][NUM_BOARD_SQUARES];
+Bitboard g_lineThrough[NUM_BOARD_SQUARES][NUM_BOARD_SQUARES];
+
+//fancy magic: every square owns a slice of one shared table
+static Bitboard s_rookAttackTable[102400];
+static Bitboard s_bishopAttackTable[5248];
+
+static std::once_flag s_attackTablesOnceFlag;
+static std::atomic<bool> s_areAttackTablesInitialized = false;
+
+//magics found offline with the search in FindMagicForEntry() (same seeds), embedding them keeps startup fast
+static constexpr Bitboard ROOK_MAGIC_NUMBERS[NUM_BOARD_SQUARES] = {
+	0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+	0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+	0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+	0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+	0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+	0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+	0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+	0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+	0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+	0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+	0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+	0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+	0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+	0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+	0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+	0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
+
+static constexpr Bitboard BISHOP_MAGIC_NUMBERS[NUM_BOARD_SQUARES] = {
+	0x2048017020910100ULL, 0x0044410424008008ULL, 0x040828A400900000ULL, 0x8002209200022000ULL,
+	0x0002021000540002ULL, 0x0021018840000000ULL, 0x00009E8420204002ULL, 0x00A0920110084480ULL,
+	0x4003062018010110ULL, 0x0221046812004E09ULL, 0x01E11002958912A0ULL, 0x0000044410804000ULL,
+	0x0000821210000080ULL, 0x080201102210A800ULL, 0x0080040411045004ULL, 0x00704A1842021000ULL,
+	0x1005061070322800ULL, 0x0018001010410444ULL, 0x0010000800401420ULL, 0x2204002844000800ULL,
+	0x2052020412022280ULL, 0x000A020101008208ULL, 0x0040400201042000ULL, 0x03E1082040480410ULL,
+	0x1004200004208414ULL, 0x08700400984808C8ULL, 0x0088080004004410ULL, 0x008C0240140100A2ULL,
+	0x0008840001822000ULL, 0x0050088001080100ULL, 0x98140840040A2200ULL, 0x3002020900210110ULL,
+	0x1004040640206000ULL, 0x1090909000840400ULL, 0x9002444810100020ULL, 0x4000020080080080ULL,
+	0x0028020400011010ULL, 0x0290808300020100ULL, 0x8010020882004410ULL, 0x0604010040082C20ULL,
+	0x20040104C0801008ULL, 0x6004208424001050ULL, 0x1002840041000800ULL, 0x0200042018000102ULL,
+	0xA8002000A0821C00ULL, 0x0040080802201910ULL, 0x0222620444000100ULL, 0x0002080041020088ULL,
+	0x1500820110401050ULL, 0x0000492090100080ULL, 0x0900410041100000ULL, 0x0302000420880000ULL,
+	0x0010501202020020ULL, 0x0008200490049040ULL, 0x0462080214A40120ULL, 0x2421310102008100ULL,
+	0x2400420080884060ULL, 0x0800804406184208ULL, 0x0B0080124A084400ULL, 0x082E082300840412ULL,
+	0x6051049040082200ULL, 0xC610211002102101ULL, 0x0000048808010433ULL, 0x0010200804405440ULL
+};
+
+
+Bitboard GetSlidingAttacksByRayWalk(int square, Bitboard occupied, bool isRook)
+{
+	const int (*directions)[2] = isRook ? ROOK_DIRECTIONS : BISHOP_DIRECTIONS;
+	Bitboard attacks = EMPTY_BITBOARD;
+	for (int i = 0; i < 4; i++)
+	{
+		int file = GetFileForSquare(square) + directions[i][0];
+		int rank = GetRankForSquare(square) + directions[i][1];
+		while (IsFileAndRankValid(file, rank))
+		{
+			int toSquare = GetSquareForFileAndRank(file, rank);
+			attacks |= GetBitboardForSquare(toSquare);
+			if (IsSquareInBitboard(occupied, toSquare))
+			{
+				break;
+			}
+			file += directions[i][0];
+			rank += directions[i][1];
+		}
+	}
+	return attacks;
+}
+
+//relevant occupancy: the ray squares minus the board edge each ray ends on
+static Bitboard GetRelevantOccupancyMask(int square, bool isRook)
+{
+	Bitboard rays = GetSlidingAttacksByRayWalk(square, EMPTY_BITBOARD, isRook);
+	Bitboard edges = ((RANK_1_BITBOARD | RANK_8_BITBOARD) & ~(RANK_1_BITBOARD << (8 * GetRankForSquare(square))))
+		| ((FILE_A_BITBOARD | FILE_H_BITBOARD) & ~(FILE_A_BITBOARD << GetFileForSquare(square)));
+	return rays & ~edges;
+}
+
+#if !defined(CHESS_USE_PEXT_ATTACKS)
+//xorshift64star, deterministic so every run (and every platform) finds the same magics
+static uint64_t GetNextMagicRandom(uint64_t& state)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 2685821657736338717ULL;
+}
+
+//fills the slice of the table, returns false on a destructive collision
+static bool TryFillMagicTable(ChessMagicEntry& entry, Bitboard const* occupancies, Bitboard const* references, int numSubsets, int* epochs, int currentEpoch)
+{
+	for (int i = 0; i < numSubsets; i++)
+	{
+		unsigned int index = entry.GetIndex(occupancies[i]);
+		if (epochs[index] < currentEpoch)
+		{
+			epochs[index] = currentEpoch;
+			entry.m_attacks[index] = references[i];
+		}
+		else if (entry.m_attacks[index] != references[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//try sparse random numbers until one maps every subset without a destructive collision
+static void FindMagicForEntry(ChessMagicEntry& entry, Bitboard const* occupancies, Bitboard const* references, int numSubsets, int* epochs, int& currentEpoch, uint64_t& randomState)
+{
+	bool isMagicFound = false;
+	while (!isMagicFound)
+	{
+		do
+		{
+			entry.m_magic = GetNextMagicRandom(randomState) & GetNextMagicRandom(randomState) & GetNextMagicRandom(randomState);
+		} while (GetNumSetBits((entry.m_mask * entry.m_magic) >> 56) < 6);
+
+		currentEpoch++;
+		isMagicFound = TryFillMagicTable(entry, occupancies, references, numSubsets, epochs, currentEpoch);
+	}
+}
+#endif
+
+static void InitializeMagicsForPiece(bool isRook, ChessMagicEntry* magics, Bitboard* table)
+{
+	Bitboard occupancies[4096];
+	Bitboard references[4096];
+#if !defined(CHESS_USE_PEXT_ATTACKS)
+	int epochs[4096] = {};
+	int currentEpoch = 0;
+	uint64_t randomState = isRook ? 0x9E3779B97F4A7C15ULL : 0xD1B54A32D192ED03ULL;
+	Bitboard const* storedMagics = isRook ? ROOK_MAGIC_NUMBERS : BISHOP_MAGIC_NUMBERS;
+#endif
+
+	Bitboard* nextTableSlice = table;
+	for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+	{
+		ChessMagicEntry& entry = magics[square];
+		entry.m_mask = GetRelevantOccupancyMask(square, isRook);
+		int numRelevantBits = GetNumSetBits(entry.m_mask);
+		entry.m_shift = 64 - numRelevantBits;
+		entry.m_attacks = nextTableSlice;
+
+		//enumerate every subset of the mask (carry-rippler)
+		int numSubsets = 0;
+		Bitboard subset = EMPTY_BITBOARD;
+		do
+		{
+			occupancies[numSubsets] = subset;
+			references[numSubsets] = GetSlidingAttacksByRayWalk(square, subset, isRook);
+			numSubsets++;
+			subset = (subset - entry.m_mask) & entry.m_mask;
+		} while (subset != EMPTY_BITBOARD);
+
+#if defined(CHESS_USE_PEXT_ATTACKS)
+		for (int i = 0; i < numSubsets; i++)
+		{
+			entry.m_attacks[entry.GetIndex(occupancies[i])] = references[i];
+		}
+#else
+		entry.m_magic = storedMagics[square];
+		currentEpoch++;
+		if (!TryFillMagicTable(entry, occupancies, references, numSubsets, epochs, currentEpoch))
+		{//stored magic does not fit (should never happen), search for a new one
+			FindMagicForEntry(entry, occupancies, references, numSubsets, epochs, currentEpoch, randomState);
+		}
+#endif
+		nextTableSlice += numSubsets;
+	}
+}
+
+static void InitializeSquaresBetween()
+{
+	for (int from = 0; from < NUM_BOARD_SQUARES; from++)
+	{
+		for (int to = 0; to < NUM_BOARD_SQUARES; to++)
+		{
+			g_squaresBetween[from][to] = EMPTY_BITBOARD;
+			g_lineThrough[from][to] = EMPTY_BITBOARD;
+			Bitboard fromBB = GetBitboardForSquare(from);
+			Bitboard toBB = GetBitboardForSquare(to);
+			if (from == to)
+			{
+				continue;
+			}
+			for (int pieceCase = 0; pieceCase < 2; pieceCase++)
+			{
+				bool isRook = pieceCase == 0;
+				if (GetSlidingAttacksByRayWalk(from, EMPTY_BITBOARD, isRook) & toBB)
+				{
+					g_squaresBetween[from][to] = GetSlidingAttacksByRayWalk(from, toBB, isRook) & GetSlidingAttacksByRayWalk(to, fromBB, isRook);
+					g_lineThrough[from][to] = (GetSlidingAttacksByRayWalk(from, EMPTY_BITBOARD, isRook) & GetSlidingAttacksByRayWalk(to, EMPTY_BITBOARD, isRook)) | fromBB | toBB;
+					break;
+				}
+			}
+		}
+	}
+}
+
+void InitializeChessAttackTables()
+{
+	std::call_once(s_attackTablesOnceFlag, []()
+	{
+		InitializeMagicsForPiece(true, g_rookMagics, s_rookAttackTable);
+		InitializeMagicsForPiece(false, g_bishopMagics, s_bishopAttackTable);
+		InitializeSquaresBetween();
+		s_areAttackTablesInitialized = true;
+	});
+}
+
+bool AreChessAttackTablesInitialized()
+{
+	return s_areAttackTablesInitialized;
+}
+
+static Bitboard GetNoAttacks(int, int, Bitboard)
+{
+	return EMPTY_BITBOARD;
+}
+
+typedef Bitboard(*ChessAttackFunction)(int playerIndex, int square, Bitboard occupied);
+
+//indexed by type + 1 so NONE (-1) lands on the empty entry
+static constexpr ChessAttackFunction ATTACK_FUNCTIONS_BY_TYPE[NUM_CHESS_PIECE_TYPES + 1] = {
+	GetNoAttacks,
+	GetAttacksForPieceType<ChessPieceType::PAWN>,
+	GetAttacksForPieceType<ChessPieceType::ROOK>,
+	GetAttacksForPieceType<ChessPieceType::KNIGHT>,
+	GetAttacksForPieceType<ChessPieceType::BISHOP>,
+	GetAttacksForPieceType<ChessPieceType::QUEEN>,
+	GetAttacksForPieceType<ChessPieceType::KING>
+};
+static_assert((int)ChessPieceType::NONE == -1 && (int)ChessPieceType::PAWN == 0 && (int)ChessPieceType::KING == 5, "attack jump table is ordered by ChessPieceType");
+
+Bitboard GetAttacksForPiece(ChessPieceType type, int playerIndex, int square, Bitboard occupied)
+{
+	return ATTACK_FUNCTIONS_BY_TYPE[(int)type + 1](playerIndex, square, occupied);
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "Game/ChessCommon.hpp"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#define CHESS_USE_PEXT_ATTACKS
+#endif
+
+
+//leaper attack tables are generated at compile time
+struct ChessSquareAttackTable
+{
+	Bitboard m_attacks[NUM_BOARD_SQUARES] = {};
+};
+
+constexpr Bitboard GetLeaperAttacksForSquare(int square, const int (*offsets)[2], int numOffsets)
+{
+	Bitboard attacks = EMPTY_BITBOARD;
+	int file = GetFileForSquare(square);
+	int rank = GetRankForSquare(square);
+	for (int i = 0; i < numOffsets; i++)
+	{
+		int toFile = file + offsets[i][0];
+		int toRank = rank + offsets[i][1];
+		if (IsFileAndRankValid(toFile, toRank))
+		{
+			attacks |= GetBitboardForSquare(GetSquareForFileAndRank(toFile, toRank));
+		}
+	}
+	return attacks;
+}
+
+constexpr int KNIGHT_OFFSETS[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+constexpr int KING_OFFSETS[8][2] = { {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1} };
+constexpr int PAWN_ATTACK_OFFSETS[NUM_CHESS_PLAYERS][2][2] = { { {-1, 1}, {1, 1} }, { {-1, -1}, {1, -1} } };
+constexpr int ROOK_DIRECTIONS[4][2] = { {0, 1}, {1, 0}, {0, -1}, {-1, 0} };
+constexpr int BISHOP_DIRECTIONS[4][2] = { {1, 1}, {1, -1}, {-1, -1}, {-1, 1} };
+
+constexpr ChessSquareAttackTable MakeLeaperAttackTable(const int (*offsets)[2], int numOffsets)
+{
+	ChessSquareAttackTable table;
+	for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+	{
+		table.m_attacks[square] = GetLeaperAttacksForSquare(square, offsets, numOffsets);
+	}
+	return table;
+}
+
+inline constexpr ChessSquareAttackTable KNIGHT_ATTACK_TABLE = MakeLeaperAttackTable(KNIGHT_OFFSETS, 8);
+inline constexpr ChessSquareAttackTable KING_ATTACK_TABLE = MakeLeaperAttackTable(KING_OFFSETS, 8);
+inline constexpr ChessSquareAttackTable PAWN_ATTACK_TABLES[NUM_CHESS_PLAYERS] = {
+	MakeLeaperAttackTable(PAWN_ATTACK_OFFSETS[0], 2),
+	MakeLeaperAttackTable(PAWN_ATTACK_OFFSETS[1], 2)
+};
+
+static_assert(KNIGHT_ATTACK_TABLE.m_attacks[0] == 0x0000000000020400ULL, "knight on a1 attacks b3 and c2");
+static_assert(KING_ATTACK_TABLE.m_attacks[0] == 0x0000000000000302ULL, "king on a1 attacks a2, b2 and b1");
+static_assert(PAWN_ATTACK_TABLES[0].m_attacks[12] == 0x0000000000280000ULL, "white pawn on e2 attacks d3 and f3");
+static_assert(PAWN_ATTACK_TABLES[1].m_attacks[52] == 0x0000280000000000ULL, "black pawn on e7 attacks d6 and f6");
+
+
+//sliding attacks use fancy magic bitboards (or PEXT when compiled with BMI2),
+//the tables are built once by InitializeChessAttackTables()
+struct ChessMagicEntry
+{
+	Bitboard m_mask = EMPTY_BITBOARD;
+	Bitboard m_magic = 0;
+	Bitboard* m_attacks = nullptr;
+	int m_shift = 0;
+
+	unsigned int GetIndex(Bitboard occupied)const
+	{
+#if defined(CHESS_USE_PEXT_ATTACKS)
+		return (unsigned int)_pext_u64(occupied, m_mask);
+#else
+		return (unsigned int)(((occupied & m_mask) * m_magic) >> m_shift);
+#endif
+	}
+};
+
+extern ChessMagicEntry g_rookMagics[NUM_BOARD_SQUARES];
+extern ChessMagicEntry g_bishopMagics[NUM_BOARD_SQUARES];
+extern Bitboard g_squaresBetween[NUM_BOARD_SQUARES][NUM_BOARD_SQUARES];
+extern Bitboard g_lineThrough[NUM_BOARD_SQUARES][NUM_BOARD_SQUARES];
+
+//safe to call more than once and from more than one thread
+void InitializeChessAttackTables();
+bool AreChessAttackTablesInitialized();
+
+
+inline Bitboard GetKnightAttacks(int square) { return KNIGHT_ATTACK_TABLE.m_attacks[square]; }
+inline Bitboard GetKingAttacks(int square) { return KING_ATTACK_TABLE.m_attacks[square]; }
+inline Bitboard GetPawnAttacks(int playerIndex, int square) { return PAWN_ATTACK_TABLES[playerIndex].m_attacks[square]; }
+
+inline Bitboard GetRookAttacks(int square, Bitboard occupied)
+{
+	ChessMagicEntry const& entry = g_rookMagics[square];
+	return entry.m_attacks[entry.GetIndex(occupied)];
+}
+
+inline Bitboard GetBishopAttacks(int square, Bitboard occupied)
+{
+	ChessMagicEntry const& entry = g_bishopMagics[square];
+	return entry.m_attacks[entry.GetIndex(occupied)];
+}
+
+inline Bitboard GetQueenAttacks(int square, Bitboard occupied)
+{
+	return GetRookAttacks(square, occupied) | GetBishopAttacks(square, occupied);
+}
+
+//squares strictly between two squares on the same rank, file or diagonal, empty otherwise
+inline Bitboard GetSquaresBetween(int fromSquare, int toSquare)
+{
+	return g_squaresBetween[fromSquare][toSquare];
+}
+
+//the whole rank, file or diagonal through both squares (edge to edge), empty if they are not aligned
+inline Bitboard GetLineThrough(int fromSquare, int toSquare)
+{
+	return g_lineThrough[fromSquare][toSquare];
+}
+
+//attacks of a piece of this type on an arbitrary square, pawns use playerIndex
+//the type is resolved at compile time, loops over one piece type should call this one
+template <ChessPieceType TYPE>
+inline Bitboard GetAttacksForPieceType(int playerIndex, int square, Bitboard occupied)
+{
+	static_assert(TYPE != ChessPieceType::NONE && TYPE != ChessPieceType::COUNT, "no attacks for an empty square");
+	if constexpr (TYPE == ChessPieceType::PAWN)			return GetPawnAttacks(playerIndex, square);
+	else if constexpr (TYPE == ChessPieceType::ROOK)	return GetRookAttacks(square, occupied);
+	else if constexpr (TYPE == ChessPieceType::KNIGHT)	return GetKnightAttacks(square);
+	else if constexpr (TYPE == ChessPieceType::BISHOP)	return GetBishopAttacks(square, occupied);
+	else if constexpr (TYPE == ChessPieceType::QUEEN)	return GetQueenAttacks(square, occupied);
+	else												return GetKingAttacks(square);
+}
+
+//runtime type goes through a jump table, NONE gives no attacks
+Bitboard GetAttacksForPiece(ChessPieceType type, int playerIndex, int square, Bitboard occupied);
+
+//slow reference ray walk, used to build and verify the tables
+Bitboard GetSlidingAttacksByRayWalk(int square, Bitboard occupied, bool isRook);
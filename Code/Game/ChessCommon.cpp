@@ -0,0 +1,70 @@
+#include "Game/ChessCommon.hpp"
+
+
+static constexpr char s_upperCaseGlyphs[NUM_CHESS_PIECE_TYPES] = { 'P', 'R', 'N', 'B', 'Q', 'K' };
+static constexpr char s_lowerCaseGlyphs[NUM_CHESS_PIECE_TYPES] = { 'p', 'r', 'n', 'b', 'q', 'k' };
+
+
+char GetGlyphForPiece(ChessPieceType type, int playerIndex)
+{
+	if (type == ChessPieceType::NONE || type == ChessPieceType::COUNT)
+	{
+		return '.';
+	}
+	return playerIndex == 0 ? s_upperCaseGlyphs[(int)type] : s_lowerCaseGlyphs[(int)type];
+}
+
+ChessPieceType GetPieceTypeForGlyph(char glyph)
+{
+	for (int i = 0; i < NUM_CHESS_PIECE_TYPES; i++)
+	{
+		if (s_upperCaseGlyphs[i] == glyph || s_lowerCaseGlyphs[i] == glyph)
+		{
+			return (ChessPieceType)i;
+		}
+	}
+	return ChessPieceType::NONE;
+}
+
+int GetPlayerIndexForGlyph(char glyph)
+{
+	ChessPieceType type = GetPieceTypeForGlyph(glyph);
+	if (type == ChessPieceType::NONE)
+	{
+		return -1;
+	}
+	return (glyph >= 'a' && glyph <= 'z') ? 1 : 0;
+}
+
+int GetSquareForSquareCoords(const char* squareCoords)
+{
+	if (squareCoords == nullptr || squareCoords[0] == '\0')
+	{
+		return NO_SQUARE;
+	}
+	char fileLetter = squareCoords[0];
+	char rankLetter = squareCoords[1];
+
+	int file = -1;
+	if (fileLetter >= 'a' && fileLetter <= 'h')
+	{
+		file = fileLetter - 'a';
+	}
+	else if (fileLetter >= 'A' && fileLetter <= 'H')
+	{
+		file = fileLetter - 'A';
+	}
+	int rank = rankLetter - '1';
+
+	if (!IsFileAndRankValid(file, rank))
+	{
+		return NO_SQUARE;
+	}
+	return GetSquareForFileAndRank(file, rank);
+}
+
+void WriteSquareCoordsForSquare(int square, char* out)
+{
+	out[0] = (char)('A' + GetFileForSquare(square));
+	out[1] = (char)('1' + GetRankForSquare(square));
+}
@@ -0,0 +1,134 @@
+#pragma once
+//headless chess rule types, this file must not include anything from Engine/ or Renderer
+//so that the rule code can be compiled and tested on its own
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+typedef uint64_t Bitboard;
+
+enum class ChessPieceType {
+	NONE = -1,
+	PAWN,
+	ROOK,
+	KNIGHT,
+	BISHOP,
+	QUEEN,
+	KING,
+	COUNT
+};
+
+constexpr int NUM_CHESS_PLAYERS = 2;
+constexpr int NUM_CHESS_PIECE_TYPES = (int)ChessPieceType::COUNT;
+constexpr int NUM_BOARD_SQUARES = 64;
+constexpr int NO_SQUARE = -1;
+
+//square index = rank * 8 + file, a1 = 0, h8 = 63 (same as board state index)
+//player 0 owns upper case glyphs and starts on rank 1, player 1 owns lower case glyphs
+constexpr Bitboard EMPTY_BITBOARD = 0ULL;
+constexpr Bitboard FILE_A_BITBOARD = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H_BITBOARD = FILE_A_BITBOARD << 7;
+constexpr Bitboard RANK_1_BITBOARD = 0xFFULL;
+constexpr Bitboard RANK_8_BITBOARD = RANK_1_BITBOARD << 56;
+
+//castling rights bit flags, kingside castles with the rook on the h file, queenside with the a file
+enum ChessCastlingRight : int
+{
+	CASTLING_NONE = 0,
+	CASTLING_PLAYER0_KINGSIDE = 1,
+	CASTLING_PLAYER0_QUEENSIDE = 2,
+	CASTLING_PLAYER1_KINGSIDE = 4,
+	CASTLING_PLAYER1_QUEENSIDE = 8,
+	CASTLING_ALL = 15
+};
+
+//starting squares the castling rules depend on
+constexpr int KING_START_SQUARES[NUM_CHESS_PLAYERS] = { 4, 60 };
+constexpr int KINGSIDE_ROOK_START_SQUARES[NUM_CHESS_PLAYERS] = { 7, 63 };
+constexpr int QUEENSIDE_ROOK_START_SQUARES[NUM_CHESS_PLAYERS] = { 0, 56 };
+
+constexpr int GetKingsideCastlingRight(int playerIndex) { return playerIndex == 0 ? CASTLING_PLAYER0_KINGSIDE : CASTLING_PLAYER1_KINGSIDE; }
+constexpr int GetQueensideCastlingRight(int playerIndex) { return playerIndex == 0 ? CASTLING_PLAYER0_QUEENSIDE : CASTLING_PLAYER1_QUEENSIDE; }
+
+
+constexpr int GetFileForSquare(int square) { return square & 7; }
+constexpr int GetRankForSquare(int square) { return square >> 3; }
+constexpr int GetSquareForFileAndRank(int file, int rank) { return rank * 8 + file; }
+constexpr bool IsFileAndRankValid(int file, int rank) { return file >= 0 && file < 8 && rank >= 0 && rank < 8; }
+constexpr Bitboard GetBitboardForSquare(int square) { return 1ULL << square; }
+constexpr bool IsSquareInBitboard(Bitboard bitboard, int square) { return (bitboard >> square) & 1ULL; }
+
+
+inline int GetNumSetBits(Bitboard bitboard)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	return (int)__popcnt64(bitboard);
+#elif defined(_MSC_VER)
+	return (int)(__popcnt((unsigned int)bitboard) + __popcnt((unsigned int)(bitboard >> 32)));
+#else
+	return __builtin_popcountll(bitboard);
+#endif
+}
+
+//bitboard must not be empty
+inline int GetLowestSquare(Bitboard bitboard)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanForward64(&index, bitboard);
+	return (int)index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)bitboard))
+	{
+		return (int)index;
+	}
+	_BitScanForward(&index, (unsigned long)(bitboard >> 32));
+	return (int)index + 32;
+#else
+	return __builtin_ctzll(bitboard);
+#endif
+}
+
+//bitboard must not be empty
+inline int GetHighestSquare(Bitboard bitboard)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanReverse64(&index, bitboard);
+	return (int)index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanReverse(&index, (unsigned long)(bitboard >> 32)))
+	{
+		return (int)index + 32;
+	}
+	_BitScanReverse(&index, (unsigned long)bitboard);
+	return (int)index;
+#else
+	return 63 - __builtin_clzll(bitboard);
+#endif
+}
+
+//bitboard must not be empty
+inline int PopLowestSquare(Bitboard& bitboard)
+{
+	int square = GetLowestSquare(bitboard);
+	bitboard &= bitboard - 1;
+	return square;
+}
+
+
+//glyph helpers, '.' is an empty square
+char GetGlyphForPiece(ChessPieceType type, int playerIndex);
+ChessPieceType GetPieceTypeForGlyph(char glyph);
+int GetPlayerIndexForGlyph(char glyph);//0 = player 0, 1 = player 1, -1 = empty or invalid
+
+//"e4" or "E4" -> square index, NO_SQUARE if invalid
+int GetSquareForSquareCoords(const char* squareCoords);
+//writes 2 characters ("E4") without a terminator
+void WriteSquareCoordsForSquare(int square, char* out);
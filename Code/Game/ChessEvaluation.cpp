@@ -0,0 +1,105 @@
+#include "Game/ChessEvaluation.hpp"
+#include "Game/ChessPieceSquareTables.hpp"
+#include "Game/ChessMoveGen.hpp"
+#include "Game/ChessAttacks.hpp"
+
+
+static int GetTaperedScore(int midgameScore, int endgameScore, int gamePhase, int playerToMove)
+{
+	int score = (midgameScore * gamePhase + endgameScore * (MAX_GAME_PHASE - gamePhase)) / MAX_GAME_PHASE;
+	return playerToMove == 0 ? score : -score;
+}
+
+int EvaluatePosition(ChessPosition const& position)
+{
+	return GetTaperedScore(position.GetMidgameScore(), position.GetEndgameScore(), position.GetGamePhase(), position.GetPlayerToMove());
+}
+
+int EvaluatePositionFromScratch(ChessPosition const& position)
+{
+	int midgameScore = 0;
+	int endgameScore = 0;
+	int gamePhase = 0;
+	position.ComputeScoresFromScratch(midgameScore, endgameScore, gamePhase);
+	return GetTaperedScore(midgameScore, endgameScore, gamePhase, position.GetPlayerToMove());
+}
+
+int GetStaticExchangeScore(ChessPosition const& position, ChessMove move)
+{
+	if (move.IsCastling())
+	{
+		return 0;
+	}
+
+	//cheapest attackers first, the king last since it may only take when nothing recaptures
+	constexpr ChessPieceType EXCHANGE_ORDER[] = { ChessPieceType::PAWN, ChessPieceType::KNIGHT, ChessPieceType::BISHOP,
+		ChessPieceType::ROOK, ChessPieceType::QUEEN, ChessPieceType::KING };
+
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	int sideIndex = position.GetPlayerIndexAtSquare(fromSquare);
+	Bitboard occupied = position.GetOccupied() & ~GetBitboardForSquare(fromSquare);
+	Bitboard diagonalSliders = position.GetPiecesForType(ChessPieceType::BISHOP) | position.GetPiecesForType(ChessPieceType::QUEEN);
+	Bitboard straightSliders = position.GetPiecesForType(ChessPieceType::ROOK) | position.GetPiecesForType(ChessPieceType::QUEEN);
+
+	//gains[i] is what the capture i plies into the sequence wins if the opponent gives up there
+	int gains[32] = {};
+	int numCaptures = 1;
+	ChessPieceType pieceOnSquare = position.GetPieceTypeAtSquare(fromSquare);
+	if (move.IsEnPassant())
+	{
+		gains[0] = GetPieceValue(ChessPieceType::PAWN);
+		occupied &= ~GetBitboardForSquare(GetSquareForFileAndRank(GetFileForSquare(toSquare), GetRankForSquare(fromSquare)));
+	}
+	else
+	{
+		gains[0] = GetPieceValue(position.GetPieceTypeAtSquare(toSquare));
+	}
+	if (move.IsPromotion())
+	{
+		pieceOnSquare = move.GetPromotionType();
+		gains[0] += GetPieceValue(pieceOnSquare) - GetPieceValue(ChessPieceType::PAWN);
+	}
+
+	Bitboard attackers = GetAttackersToSquare(position, toSquare, occupied) & occupied;
+	while (numCaptures < 32)
+	{
+		sideIndex = 1 - sideIndex;
+		Bitboard sideAttackers = attackers & position.GetPiecesForPlayer(sideIndex);
+		if (sideAttackers == EMPTY_BITBOARD)
+		{
+			break;
+		}
+		ChessPieceType attackerType = ChessPieceType::KING;
+		Bitboard attackerBB = EMPTY_BITBOARD;
+		for (ChessPieceType type : EXCHANGE_ORDER)
+		{
+			attackerBB = sideAttackers & position.GetPiecesForType(type);
+			if (attackerBB != EMPTY_BITBOARD)
+			{
+				attackerType = type;
+				break;
+			}
+		}
+		if (attackerType == ChessPieceType::KING && (attackers & position.GetPiecesForPlayer(1 - sideIndex)) != EMPTY_BITBOARD)
+		{
+			break;
+		}
+
+		gains[numCaptures] = GetPieceValue(pieceOnSquare) - gains[numCaptures - 1];
+		numCaptures++;
+		pieceOnSquare = attackerType;
+
+		//taking the attacker off the board may uncover a slider behind it
+		occupied &= ~GetBitboardForSquare(GetLowestSquare(attackerBB));
+		attackers |= (GetBishopAttacks(toSquare, occupied) & diagonalSliders) | (GetRookAttacks(toSquare, occupied) & straightSliders);
+		attackers &= occupied;
+	}
+
+	//each player only continues the exchange when that is better for them than stopping
+	while (--numCaptures > 0)
+	{
+		gains[numCaptures - 1] = -(-gains[numCaptures - 1] > gains[numCaptures] ? -gains[numCaptures - 1] : gains[numCaptures]);
+	}
+	return gains[0];
+}
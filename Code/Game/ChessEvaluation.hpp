@@ -0,0 +1,20 @@
+#pragma once
+#include "Game/ChessPosition.hpp"
+
+
+//static evaluation for the search, in centipawns
+constexpr int PIECE_VALUES[NUM_CHESS_PIECE_TYPES] = { 100, 500, 320, 330, 900, 0 };//pawn, rook, knight, bishop, queen, king, for move ordering
+
+constexpr int GetPieceValue(ChessPieceType type)
+{
+	return type == ChessPieceType::NONE ? 0 : PIECE_VALUES[(int)type];
+}
+
+//material and piece-square tables blended between midgame and endgame by the material left,
+//from the point of view of the player to move; O(1), the terms are kept up to date by MakeMove()/UnmakeMove()
+int EvaluatePosition(ChessPosition const& position);
+int EvaluatePositionFromScratch(ChessPosition const& position);//same result from a full board scan, for verification
+
+//static exchange evaluation: material the mover wins (< 0 loses) if both players keep recapturing on the move's
+//to square with their least valuable attacker and each may stop when recapturing would lose; pins are ignored
+int GetStaticExchangeScore(ChessPosition const& position, ChessMove move);
@@ -0,0 +1,118 @@
+#include "Game/ChessMappedFile.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+ChessMappedFile::ChessMappedFile()
+{
+}
+
+ChessMappedFile::~ChessMappedFile()
+{
+	Close();
+}
+
+bool ChessMappedFile::Open(const char* filePath, bool isRandomAccess)
+{
+	Close();
+#if defined(_WIN32)
+	DWORD flags = FILE_ATTRIBUTE_NORMAL | (isRandomAccess ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN);
+	HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_fileHandle = file;
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+	{
+		Close();
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+	m_mappingHandle = mapping;
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		Close();
+		return false;
+	}
+	m_size = (size_t)fileSize.QuadPart;
+	m_data = static_cast<unsigned char const*>(view);
+#else
+	int file = open(filePath, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat fileStatus = {};
+	bool isSizeValid = fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0;
+	void* view = isSizeValid ? mmap(nullptr, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+	//the mapping keeps the file alive on its own
+	close(file);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+	madvise(view, (size_t)fileStatus.st_size, isRandomAccess ? MADV_RANDOM : MADV_SEQUENTIAL);
+	m_size = (size_t)fileStatus.st_size;
+	m_data = static_cast<unsigned char const*>(view);
+#endif
+	return true;
+}
+
+void ChessMappedFile::Close()
+{
+#if defined(_WIN32)
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle(m_mappingHandle);
+	}
+	if (m_fileHandle != nullptr)
+	{
+		CloseHandle(m_fileHandle);
+	}
+#else
+	if (m_data != nullptr)
+	{
+		munmap(const_cast<unsigned char*>(m_data), m_size);
+	}
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+}
+
+bool ChessMappedFile::IsOpen() const
+{
+	return m_data != nullptr;
+}
+
+unsigned char const* ChessMappedFile::GetData() const
+{
+	return m_data;
+}
+
+size_t ChessMappedFile::GetSize() const
+{
+	return m_size;
+}
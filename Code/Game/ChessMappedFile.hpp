@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+
+
+//read only view of a whole file mapped into memory, the OS pages in what is touched and shares the pages between processes
+class ChessMappedFile
+{
+public:
+	ChessMappedFile();
+	~ChessMappedFile();
+	ChessMappedFile(ChessMappedFile const& copyFrom) = delete;
+	ChessMappedFile& operator=(ChessMappedFile const& copyFrom) = delete;
+
+	//isRandomAccess tells the OS not to read ahead, for files that are probed rather than scanned; false for missing or empty files
+	bool Open(const char* filePath, bool isRandomAccess);
+	void Close();
+	bool IsOpen()const;
+
+	unsigned char const* GetData()const;
+	size_t GetSize()const;
+
+private:
+	unsigned char const* m_data = nullptr;
+	size_t m_size = 0;
+	void* m_fileHandle = nullptr;//Windows only
+	void* m_mappingHandle = nullptr;
+};
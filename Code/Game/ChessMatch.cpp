@@ -3,6 +3,8 @@
 #include "Game/Game.hpp"
 #include "Game/App.hpp"
 #include "Game/AudioDefinition.hpp"
+#include "Game/ChessMoveGen.hpp"
+#include "Game/ChessMoveSequence.hpp"
 
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Core/EventSystem.hpp"
@@ -14,26 +16,73 @@
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 
-ChessMoveResult ChessMatch::s_chessMoveResult = ChessMoveResult();
-bool ChessMatch::s_hasPreDefinedResult = false;
-IntVec2 ChessMatch::s_formerCoords = IntVec2(0, 0);
-IntVec2 ChessMatch::s_desiredCoords = IntVec2(0, 0);
-char ChessMatch::s_promoteToPiece = '?';
-bool ChessMatch::s_autoPromoteToQueen = false;
-bool ChessMatch::s_matchEnds = false;
-int ChessMatch::s_result = -1;
-bool ChessMatch::s_player1Turn = false;
-bool ChessMatch::s_isTeleporting = false;
+std::map<int, ChessMatch*> ChessMatch::s_matchesByID;
+std::mutex ChessMatch::s_matchesByIDMutex;
+int ChessMatch::s_nextMatchID = 0;
+
+//board of a match that has no Game to take the configured default board state from
+static constexpr const char* START_POSITION_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+
+//indexed by ChessMoveError, %s entries are filled in by GetMessageForMoveError
+static const char* MOVE_ERROR_MESSAGES[(int)ChessMoveError::COUNT] = {
+	"UNKNOWN ERROR",
+	"Invalid command: Match Ended",
+	"Invalid FROM args: FROM square has no piece",
+	"Invalid FROM args: FROM Piece is opponent's piece",
+	"Invalid TO args: TO Piece is your piece",
+	"Invalid format: FROM piece is equal to TO piece",
+	"Invalid move: cannot promote non-pawn piece",
+	"Invalid move: %s cannot move to this place by rule",
+	"Invalid move: %s is blocked by %s at %s",
+	"Invalid move: pawn cannot move vertically to capture TO piece",
+	"Invalid args: moving pawn to far rank without promoteTo args",
+	"Invalid move: pawn cannot move diagonally to empty TO coords",
+	"Invalid move: kings cannot be adjacent to each other",
+	"Invalid move: cannot perform castling, the king or rook has moved",
+	"Invalid move: cannot perform castling, a piece is between the king and rook",
+	"Invalid move: this move would leave your king in check",
+};
+
+static const char* GetPieceNameForGlyph(char glyph)
+{
+	const ChessPieceDefinition* def = ChessPieceDefinition::GetByGlyph(glyph);
+	return def != nullptr ? def->m_name.c_str() : "piece";
+}
+
+std::string GetMessageForMoveError(ChessMoveError error, char pieceGlyph, char blockingGlyph, int blockingSquare)
+{
+	int errorIndex = (int)error;
+	if (errorIndex < 0 || errorIndex >= (int)ChessMoveError::COUNT)
+	{
+		errorIndex = (int)ChessMoveError::NONE;
+	}
+	const char* message = MOVE_ERROR_MESSAGES[errorIndex];
+
+	switch (error)
+	{
+	case ChessMoveError::NOT_A_MOVE_FOR_PIECE:
+		return Stringf(message, GetPieceNameForGlyph(pieceGlyph));
+	case ChessMoveError::PATH_BLOCKED:
+		return Stringf(message, GetPieceNameForGlyph(pieceGlyph), GetPieceNameForGlyph(blockingGlyph),
+			GetSquareCoordsForBoardCoords(GetBoardCoordsForBoardStateIndex(blockingSquare)).c_str());
+	default:
+		return message;
+	}
+}
 
 
 ChessMatch::ChessMatch()
 {
+	RegisterMatch();
+	Startup();
 }
 
 ChessMatch::ChessMatch(Game* owner, int startingPlayerIndex)
 	:m_game(owner)
 {
-	s_player1Turn = startingPlayerIndex == 1;
+	RegisterMatch();
+	m_context.m_player1Turn = startingPlayerIndex == 1;
 	Startup();
 }
 
@@ -41,13 +90,17 @@ ChessMatch::~ChessMatch()
 {
 	m_game = nullptr;
 
+	std::lock_guard<std::mutex> lock(s_matchesByIDMutex);
+	s_matchesByID.erase(m_context.m_matchID);
+
 	//g_theEventSystem->UnsubscribeEventCallbackFunction("chessmove", Event_ChessMove);
 	//g_theEventSystem->UnsubscribeEventCallbackFunction("resign", Event_Resign);
 }
 
 void ChessMatch::Startup()
 {
-	SetBoardStateByString(m_game->GetDefaultBoardState());
+	InitializeChessAttackTables();
+	SetBoardStateByString(m_game != nullptr ? m_game->GetDefaultBoardState() : START_POSITION_FEN);
 
 	//EventArgs args;
 	//args.SetValue("from", "e2");
@@ -61,7 +114,7 @@ void ChessMatch::Startup()
 
 void ChessMatch::Update(float deltaSeconds)
 {
-	if (!s_matchEnds)
+	if (!m_context.m_matchEnds)
 	{
 		UpdatePlayerRaycastHit();
 		UpdatePlayerHighlight();
@@ -70,6 +123,10 @@ void ChessMatch::Update(float deltaSeconds)
 
 	int numPieces = (int)m_pieces.size();
 	for (int i = 0; i < numPieces; i++) {
+		if (m_pieces[i].m_isCaptured)
+		{
+			continue;
+		}
 		m_pieces[i].Update(deltaSeconds);
 	}
 
@@ -120,6 +177,10 @@ RaycastResult3D ChessMatch::RaycastAgainstAllPieces(Vec3 const& rayStart, Vec3 c
 
 	for (int i = 0; i < numPieces; i++)
 	{
+		if (m_pieces[i].m_isCaptured)
+		{
+			continue;
+		}
 		pieceCenter2D = GetFromVec3(m_pieces[i].m_position);
 		FloatRange tempRange = pieceHeightRange;
 		tempRange.m_max += m_pieces[i].m_pieceDef->m_modelHeight;
@@ -165,7 +226,7 @@ RaycastResult3D ChessMatch::RaycastAgainstAllBoardSquares(Vec3 const& rayStart,
 
 void ChessMatch::UpdatePlayerHighlight()
 {
-	if (Game::s_isSpectator)
+	if (m_context.m_isSpectator)
 	{//if is spectator
 		return;
 	}
@@ -174,30 +235,27 @@ void ChessMatch::UpdatePlayerHighlight()
 		m_highlightingCoords = IntVec2(-1, -1);
 		return;//not raycasting anything
 	}
-	int currentPlayerIndex = (int)s_player1Turn;
+	int currentPlayerIndex = (int)m_context.m_player1Turn;
 	int playerIndexOfPieceAtCoords = GetPlayerIndexForPieceAtCoords(m_raycastingCoords);
 
 
 	//if (m_selectedPiece != nullptr && m_selectedPiece->IsValidMoveForCoords(m_raycastingCoords))
 	if(m_selectedPiece != nullptr)//if a piece is already selected
 	{
-		ChessMoveResult tempResult;
-		bool isMoveValid = CheckMoveValidity(m_selectedPiece->m_currentCoords, m_raycastingCoords, tempResult);
+		UpdateLegalTargetCache();
+		Bitboard legalTargets = GetLegalTargetsForCoords(m_selectedPiece->m_currentCoords);
+		bool isMoveValid = IsSquareInBitboard(legalTargets, GetBoardStateIndexForBoardCoords(m_raycastingCoords));
 
-		if (isMoveValid || ChessMatch::s_isTeleporting)
+		if (isMoveValid || m_context.m_isTeleporting)
 		{
 			m_highlightingCoords = m_raycastingCoords;
-
-			//store the result globally
-			ChessMatch::s_chessMoveResult = tempResult;
-			ChessMatch::s_hasPreDefinedResult = true;
 		}
 		
 	}
 	else if (m_selectedPiece == nullptr && currentPlayerIndex == playerIndexOfPieceAtCoords)//no piece is selected but I'm raycasting a current player's piece
 	{
-		if (!Game::s_isPlayingRemotely //if I'm playing with myself (playing both player 0 and player 1)
-			|| (Game::s_isPlayingRemotely && s_player1Turn == Game::s_myPlayerIndex))//if I'm raycasting my piece at my turn
+		if (!m_context.m_isPlayingRemotely //if I'm playing with myself (playing both player 0 and player 1)
+			|| (m_context.m_isPlayingRemotely && m_context.m_player1Turn == m_context.m_myPlayerIndex))//if I'm raycasting my piece at my turn
 		{
 			m_highlightingCoords = m_raycastingCoords;
 		}
@@ -215,7 +273,7 @@ void ChessMatch::HandlePlayerLeftClick()
 	}
 
 	const ChessPiece* highlightedPiece = GetPieceAtCoords(m_highlightingCoords);
-	if (highlightedPiece != nullptr && highlightedPiece->m_player1Side == s_player1Turn)
+	if (highlightedPiece != nullptr && highlightedPiece->m_player1Side == m_context.m_player1Turn)
 	{//if selecting another friendly piece, de-select previous piece to select this piece
 		if (m_selectedPiece != nullptr)
 		{
@@ -228,12 +286,11 @@ void ChessMatch::HandlePlayerLeftClick()
 	else if (m_selectedPiece != nullptr)
 	{//moving, or capturing
 
-		ChessMatch::s_formerCoords = m_selectedPiece->m_currentCoords;
-		ChessMatch::s_desiredCoords = m_highlightingCoords;
-		ChessMatch::s_autoPromoteToQueen = true;
+		m_context.m_formerCoords = m_selectedPiece->m_currentCoords;
+		m_context.m_desiredCoords = m_highlightingCoords;
+		m_context.m_autoPromoteToQueen = true;
 
-		Player player = m_game->GetPlayerByIndex((int)ChessMatch::s_player1Turn);
-		m_selectedPiece->m_color = player.m_playerColor;
+		m_selectedPiece->m_color = m_players[(int)m_context.m_player1Turn].m_playerColor;
 		m_selectedPiece = nullptr;
 	}
 
@@ -245,8 +302,7 @@ void ChessMatch::HandlePlayerRightClick()
 {
 	if (m_selectedPiece != nullptr)
 	{
-		Player player = m_game->GetPlayerByIndex((int)ChessMatch::s_player1Turn);
-		m_selectedPiece->m_color = player.m_playerColor;
+		m_selectedPiece->m_color = m_players[(int)m_context.m_player1Turn].m_playerColor;
 	}
 	m_selectedPiece = nullptr;
 
@@ -254,42 +310,44 @@ void ChessMatch::HandlePlayerRightClick()
 
 void ChessMatch::HandlePlayerTeleporting(bool isTeleporting)
 {
-	ChessMatch::s_isTeleporting = isTeleporting;
+	m_context.m_isTeleporting = isTeleporting;
 }
 
 void ChessMatch::UpdateMovePieceCommand()
 {
-	if (s_formerCoords == s_desiredCoords) return;
+	if (m_context.m_formerCoords == m_context.m_desiredCoords) return;
+
+	IntVec2 fromCoords = m_context.m_formerCoords;
+	IntVec2 toCoords = m_context.m_desiredCoords;
 
-	IntVec2 fromCoords = s_formerCoords;
-	IntVec2 toCoords = s_desiredCoords;
+	m_context.m_formerCoords = IntVec2::ZERO;
+	m_context.m_desiredCoords = IntVec2::ZERO;
 
-	s_formerCoords = IntVec2::ZERO;
-	s_desiredCoords = IntVec2::ZERO;
+	int currentPlayerIndex = (int)m_context.m_player1Turn;
+	int playerIndexFrom = GetPlayerIndexForPieceAtCoords(fromCoords);
+	int playerIndexTo = GetPlayerIndexForPieceAtCoords(toCoords);
 
-	if (s_matchEnds)
+	ChessMoveError error = ChessMoveError::NONE;
+	if (m_context.m_matchEnds)
 	{
-		PrintErrorMsgToConsole("Invalid command: Match Ended");
-		return;
+		error = ChessMoveError::MATCH_ENDED;
 	}
-	int currentPlayerIndex = (int)s_player1Turn;
-
-	int playerIndexFrom = GetPlayerIndexForPieceAtCoords(fromCoords);
-	if (playerIndexFrom == -1)
+	else if (playerIndexFrom == -1)
 	{
-		PrintErrorMsgToConsole("Invalid FROM args: FROM square has no piece");
-		return;
+		error = ChessMoveError::FROM_SQUARE_EMPTY;
 	}
 	else if (playerIndexFrom != currentPlayerIndex)
 	{
-		PrintErrorMsgToConsole("Invalid FROM args: FROM Piece is opponent's piece");
-		return;
+		error = ChessMoveError::FROM_PIECE_IS_OPPONENTS;
+	}
+	else if (playerIndexTo == currentPlayerIndex)
+	{
+		error = ChessMoveError::TO_PIECE_IS_OWN;
 	}
 
-	int playerIndexTo = GetPlayerIndexForPieceAtCoords(toCoords);
-	if (playerIndexTo == currentPlayerIndex)
+	if (error != ChessMoveError::NONE)
 	{
-		PrintErrorMsgToConsole("Invalid TO args: TO Piece is your piece");
+		PrintErrorMsgToConsole(GetMessageForMoveError(error));
 		return;
 	}
 
@@ -302,6 +360,25 @@ void ChessMatch::UpdateMovePieceCommand()
 
 }
 
+void ChessMatch::UpdateLegalTargetCache()
+{
+	if (m_isLegalTargetCacheValid)
+	{
+		return;
+	}
+	for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+	{
+		m_legalTargetsBySquare[square] = EMPTY_BITBOARD;
+	}
+	ChessMoveList legalMoves;
+	GenerateLegalMoves(m_position, legalMoves);
+	for (ChessMove move : legalMoves)
+	{
+		m_legalTargetsBySquare[move.GetFromSquare()] |= GetBitboardForSquare(move.GetToSquare());
+	}
+	m_isLegalTargetCacheValid = true;
+}
+
 void ChessMatch::Render() const
 {
 	
@@ -309,7 +386,10 @@ void ChessMatch::Render() const
 
 	int numPieces = (int)m_pieces.size();
 	for (int i = 0; i < numPieces; i++) {
-		
+		if (m_pieces[i].m_isCaptured)
+		{
+			continue;
+		}
 		m_pieces[i].Render();
 	}
 
@@ -328,9 +408,24 @@ void ChessMatch::RenderPlayerSelections() const
 
 	g_theRenderer->BindShader(nullptr);
 
-	std::vector<Vertex_PCU> tempVerts;
+	std::vector<Vertex_PCU>& tempVerts = m_selectionVerts;
+	tempVerts.clear();
 	float tableHeight = m_game->m_boardModel.m_boardHeight;
 
+	//every legal target of the selected piece, straight from the cached mask
+	if (m_selectedPiece != nullptr && m_isLegalTargetCacheValid)
+	{
+		Bitboard legalTargets = GetLegalTargetsForCoords(m_selectedPiece->m_currentCoords);
+		while (legalTargets != EMPTY_BITBOARD)
+		{
+			IntVec2 targetCoords = GetBoardCoordsForBoardStateIndex(PopLowestSquare(legalTargets));
+			Vec3 targetBL(targetCoords.x + 0.1f, targetCoords.y + 0.1f, tableHeight);
+			Vec3 targetTR(targetCoords.x + 0.9f, targetCoords.y + 0.9f, tableHeight + 0.01f);
+			AABB3 targetBox(targetBL, targetTR);
+			AddVertsForAABBWireframe3D(tempVerts, targetBox, 0.02f);
+		}
+	}
+
 	if (m_highlightingCoords != IntVec2(-1,-1))
 	{
 		//draw coords
@@ -350,9 +445,11 @@ void ChessMatch::RenderPlayerSelections() const
 
 			AddVertsForCylinderZWireframe3D(tempVerts, pieceCenter2D, pieceHeightRange, pieceRadius, 8, 0.05f);
 		}
+	}
 
+	if (!tempVerts.empty())
+	{
 		g_theRenderer->DrawVertexArray(tempVerts);
-
 	}
 
 	
@@ -370,21 +467,21 @@ void ChessMatch::SetTurnNumber(int turnNumber)
 //0 = player 0 wins, 1 = player 1 wins, 2 = draw
 void ChessMatch::SetMatchResultAndEndTheGame(int gameResult)
 {
-	s_matchEnds = true;
-	s_result = gameResult;
+	m_context.m_matchEnds = true;
+	m_context.m_result = gameResult;
 	HandleMatchEnd();
 }
 
-void ChessMatch::MovePieceOnLayout(IntVec2 const& fromCoords, IntVec2 const& toCoords, char const glyph)
-{
-	//move piece on layout
-	SetPieceToCoords('.', fromCoords);
-	SetPieceToCoords(glyph, toCoords);
-}
-
 void ChessMatch::MovePieceInVector(int fromPieceIndex, IntVec2 const& toCoords)
 {
 	//move piece in vector
+	int fromSquare = GetBoardStateIndexForBoardCoords(m_pieces[fromPieceIndex].m_currentCoords);
+	if (m_pieceIndexBySquare[fromSquare] == fromPieceIndex)
+	{
+		m_pieceIndexBySquare[fromSquare] = -1;
+	}
+	m_pieceIndexBySquare[GetBoardStateIndexForBoardCoords(toCoords)] = fromPieceIndex;
+
 	m_pieces[fromPieceIndex].m_prevCoords = m_pieces[fromPieceIndex].m_currentCoords;
 	m_pieces[fromPieceIndex].m_currentCoords = toCoords;
 
@@ -392,10 +489,8 @@ void ChessMatch::MovePieceInVector(int fromPieceIndex, IntVec2 const& toCoords)
 	m_pieces[fromPieceIndex].m_turnLastMoved = m_turnNumber;
 }
 
-void ChessMatch::ChangePieceForIndex(int pieceIndex, const ChessPieceDefinition* def, IntVec2 const& coords, char const glyph)
+void ChessMatch::ChangePieceForIndex(int pieceIndex, const ChessPieceDefinition* def)
 {
-	int layoutIndex = GetBoardStateIndexForBoardCoords(coords);
-	m_layout[layoutIndex] = glyph;
 	m_pieces[pieceIndex].m_pieceDef = def;
 }
 
@@ -403,79 +498,54 @@ bool ChessMatch::CheckMoveValidity(IntVec2 const& fromCoords, IntVec2 const& toC
 {
 	if (fromCoords == toCoords)
 	{
-		result.m_errorMessage = "Invalid format: FROM piece is equal to TO piece";
-		return true;
+		result.m_error = ChessMoveError::FROM_EQUALS_TO;
+		return false;
 	}
 
-	int pieceNum = (int)m_pieces.size();
-	int pieceIndexFrom = -1;
-	int pieceIndexToErase = -1;
+	int pieceIndexFrom = GetPieceIndexForCoords(fromCoords);
+	int pieceIndexToCapture = GetPieceIndexForCoords(toCoords);
+	int fromSquare = GetBoardStateIndexForBoardCoords(fromCoords);
+	int toSquare = GetBoardStateIndexForBoardCoords(toCoords);
 
-	std::string fromStr = GetSquareCoordsForBoardCoords(fromCoords);
-	std::string toStr = GetSquareCoordsForBoardCoords(toCoords);
-	result.m_fromChessPieceCoordsStr = fromStr;
-	result.m_toChessPieceCoordsStr = toStr;
-
-	std::string fromChessPiece, toChessPiece;
-	char fromChessPieceGlyph = '.';
-	char toChessPieceGlyph = '.';
-	char promoteToPieceGlyph = s_promoteToPiece;
-
-	//get glyph and def from vector of existing pieces
-	for (int i = 0; i < pieceNum; i++)
-	{
-		if (m_pieces[i].m_currentCoords == fromCoords)
-		{
-			pieceIndexFrom = i;
-			fromChessPiece = m_pieces[i].m_pieceDef->m_name;
-			fromChessPieceGlyph = m_pieces[i].m_player1Side ? m_pieces[i].m_pieceDef->m_glyphlowerCase : m_pieces[i].m_pieceDef->m_glyphUpperCase;
-		}
-		else if (m_pieces[i].m_currentCoords == toCoords)
-		{
-			pieceIndexToErase = i;
-			toChessPiece = m_pieces[i].m_pieceDef->m_name;
-			toChessPieceGlyph = m_pieces[i].m_player1Side ? m_pieces[i].m_pieceDef->m_glyphlowerCase : m_pieces[i].m_pieceDef->m_glyphUpperCase;
-		}
-	}
+	char fromChessPieceGlyph = GetGlyphAtCoords(fromCoords);
+	char toChessPieceGlyph = GetGlyphAtCoords(toCoords);
+	char promoteToPieceGlyph = m_context.m_promoteToPiece;
 
 	result.m_pieceIndexFrom = pieceIndexFrom;
-	result.m_fromChessPieceStr = fromChessPiece;
 	result.m_fromChessPieceGlyph = fromChessPieceGlyph;
-
-	result.m_pieceIndexTo = pieceIndexToErase;
-	result.m_toChessPieceStr = toChessPiece;
 	result.m_toChessPieceGlyph = toChessPieceGlyph;
+	result.m_pieceIndexToCapture = pieceIndexToCapture;
 
-	result.m_pieceIndexToErase = pieceIndexToErase;
-	result.m_isCapturing = pieceIndexToErase != -1;
+	//special rules found below add to these flags, the move is packed once at the end
+	int moveFlags = pieceIndexToCapture != -1 ? MOVE_FLAG_CAPTURE : MOVE_FLAG_QUIET;
+	result.m_move = ChessMove(fromSquare, toSquare, moveFlags);
 
 
 	int playerIndexTo = GetPlayerIndexForPieceAtCoords(toCoords);
-	if (playerIndexTo == (int)s_player1Turn)
+	if (playerIndexTo == (int)m_context.m_player1Turn)
 	{
-		result.m_errorMessage = "Invalid TO args: TO Piece is your piece";
+		result.m_error = ChessMoveError::TO_PIECE_IS_OWN;
 		return false;
 	}
 	
 
-	if (!s_isTeleporting)
+	if (!m_context.m_isTeleporting)
 	{
 		ChessPieceType fromPieceType = m_pieces[pieceIndexFrom].m_pieceDef->m_type;
 		if (fromPieceType != ChessPieceType::PAWN && promoteToPieceGlyph != '?')
 		{
-			result.m_errorMessage = "Invalid move: cannot promote non-pawn piece";
+			result.m_error = ChessMoveError::PROMOTE_NON_PAWN;
 			return false;
 		}
 		else {
-			s_promoteToPiece = '?';
+			m_context.m_promoteToPiece = '?';
 		}
 
 		//check if the move is valid for FROM piece
 		bool isToCoordsValidForFromPiece = m_pieces[pieceIndexFrom].IsValidMoveForCoords(toCoords);
 		if (!isToCoordsValidForFromPiece)
 		{
-			std::string fromPieceInvalidMove = Stringf("Invalid move: %s cannot move to this place by rule", fromChessPiece.c_str());
-			result.m_errorMessage = fromPieceInvalidMove;
+			result.m_error = ChessMoveError::NOT_A_MOVE_FOR_PIECE;
 			return false;
 		}
 
@@ -488,30 +558,13 @@ bool ChessMatch::CheckMoveValidity(IntVec2 const& fromCoords, IntVec2 const& toC
 		if (fromPieceType != ChessPieceType::KNIGHT)
 		{
 			//check if there is a piece between from and to piece
-			IntVec2 tempMoveCase = IntVec2(0, 0);
-			int tempDist = 0;
-
-			for (int i = 0; i < pieceNum; i++)
+			int blockingSquare = GetBlockingSquareBetween(fromCoords, toCoords);
+			if (blockingSquare != NO_SQUARE)
 			{
-				IntVec2 tempCoords = m_pieces[i].m_currentCoords;
-				if (tempCoords == fromCoords || tempCoords == toCoords)
-				{//ignore the from piece and to piece
-					continue;
-				}
-				tempMoveCase = GetMoveCase(fromCoords, m_pieces[i].m_currentCoords);
-				tempDist = GetTaxicabDistance2D(fromCoords, tempCoords);
-
-				if (tempDist < fromToDist
-					&& tempMoveCase == fromToMoveCase
-					&& m_pieces[pieceIndexFrom].IsValidMoveForCoords(tempCoords))
-				{
-					std::string fromPieceBlocked = Stringf("Invalid move: %s is blocked by %s at %s",
-						fromChessPiece.c_str(),
-						m_pieces[i].m_pieceDef->m_name.c_str(),
-						GetSquareCoordsForBoardCoords(m_pieces[i].m_currentCoords).c_str());
-					result.m_errorMessage = fromPieceBlocked;
-					return false;
-				}
+				result.m_error = ChessMoveError::PATH_BLOCKED;
+				result.m_blockingGlyph = m_position.GetGlyphAtSquare(blockingSquare);
+				result.m_blockingSquare = blockingSquare;
+				return false;
 			}
 
 			if (fromPieceType == ChessPieceType::PAWN)
@@ -519,7 +572,7 @@ bool ChessMatch::CheckMoveValidity(IntVec2 const& fromCoords, IntVec2 const& toC
 
 				if (fromToMoveCase.x == 0 && toChessPieceGlyph != '.')
 				{//something is in to piece
-					result.m_errorMessage = "Invalid move: pawn cannot move vertically to capture TO piece";
+					result.m_error = ChessMoveError::PAWN_FORWARD_CAPTURE;
 					return false;
 				}
 
@@ -531,22 +584,19 @@ bool ChessMatch::CheckMoveValidity(IntVec2 const& fromCoords, IntVec2 const& toC
 					|| (fromChessPieceGlyph == 'p' && moveSouth && toCoords.y == 0);
 				if (reachEndOfBoard)
 				{
-					if (promoteToPieceGlyph == '?' && !ChessMatch::s_autoPromoteToQueen)
+					if (promoteToPieceGlyph == '?' && !m_context.m_autoPromoteToQueen)
 					{
-						result.m_errorMessage = "Invalid args: moving pawn to far rank without promoteTo args";
+						result.m_error = ChessMoveError::MISSING_PROMOTE_TO;
 						return false;
 					}
 
-					if (ChessMatch::s_autoPromoteToQueen)
+					if (m_context.m_autoPromoteToQueen)
 					{
-						result.m_promoteToPieceGlyph = ChessMatch::s_player1Turn ? 'q' : 'Q';
-						ChessMatch::s_autoPromoteToQueen = false;
-					}
-					else {
-						result.m_promoteToPieceGlyph = promoteToPieceGlyph;
+						promoteToPieceGlyph = m_context.m_player1Turn ? 'q' : 'Q';
+						m_context.m_autoPromoteToQueen = false;
 					}
 
-					result.m_isPromotion = true;
+					moveFlags |= ChessMove::GetPromotionFlag(GetPieceTypeForGlyph(promoteToPieceGlyph));
 
 				}
 
@@ -559,25 +609,19 @@ bool ChessMatch::CheckMoveValidity(IntVec2 const& fromCoords, IntVec2 const& toC
 					char opponentPawnGlyph = fromChessPieceGlyph == 'P' ? 'p' : 'P';
 					IntVec2 adjCoord(fromCoords.x + fromToMoveCase.x, fromCoords.y);
 
+					//the position knows the square a pawn skipped over last move
 					char tempGlyph = GetGlyphAtCoords(adjCoord);
-					if (tempGlyph == opponentPawnGlyph)
+					bool isEnPassantSquare = GetBoardStateIndexForBoardCoords(toCoords) == m_position.GetEnPassantSquare();
+					bool isEnPassant = tempGlyph == opponentPawnGlyph && isEnPassantSquare;
+					if (isEnPassant)
 					{
-						int tempIndex = GetPieceIndexForCoords(adjCoord);
-						int absDistYOp = abs(m_pieces[tempIndex].m_currentCoords.y - m_pieces[tempIndex].m_prevCoords.y);
-
-
-						if (m_pieces[tempIndex].m_turnLastMoved == m_turnNumber - 1
-							&& absDistYOp == 2)
-						{
-							result.m_isCapturing = true;
-							result.m_isEnpassant = true;
-							result.m_pieceIndexToErase = tempIndex;
-						}
+						moveFlags = MOVE_FLAG_EN_PASSANT;
+						result.m_pieceIndexToCapture = GetPieceIndexForCoords(adjCoord);
 					}
 
-					if (!result.m_isEnpassant && toChessPieceGlyph == '.')
+					if (!isEnPassant && toChessPieceGlyph == '.')
 					{//nothing is in the diagonal TO coords
-						result.m_errorMessage = "Invalid move: pawn cannot move diagonally to empty TO coords";
+						result.m_error = ChessMoveError::PAWN_DIAGONAL_TO_EMPTY;
 						return false;
 					}
 				}
@@ -587,83 +631,37 @@ bool ChessMatch::CheckMoveValidity(IntVec2 const& fromCoords, IntVec2 const& toC
 			else if (fromPieceType == ChessPieceType::KING)
 			{//check Kings Apart rule
 
-				IntVec2 nearby8Coords[8];
-				toCoords.GetNearby8Coords(nearby8Coords);
-				char opponentKingGlyph = fromChessPieceGlyph == 'K' ? 'k' : 'K';
-				char tempGlyph = '?';
-				for (int i = 0; i < 8; i++)
+				int opponentPlayerIndex = fromChessPieceGlyph == 'K' ? 1 : 0;
+				Bitboard opponentKing = m_position.GetPieces(opponentPlayerIndex, ChessPieceType::KING);
+				if (GetKingAttacks(GetBoardStateIndexForBoardCoords(toCoords)) & opponentKing)
 				{
-					tempGlyph = GetGlyphAtCoords(nearby8Coords[i]);
-					if (tempGlyph == opponentKingGlyph)
-					{
-						result.m_errorMessage = "Invalid move: kings cannot be adjacent to each other";
-						return false;
-					}
+					result.m_error = ChessMoveError::KINGS_ADJACENT;
+					return false;
 				}
-				tempMoveCase = IntVec2(0, 0);
-
-				//check castling
-				if (fromToDist == 2)
+				//check castling, a diagonal step is also 2 squares away by taxicab distance
+				if (fromToDist == 2 && fromToMoveCase.y == 0)
 				{
 
-					//if there is a rook in the king's moving direction
-					char rookGlyph = m_pieces[pieceIndexFrom].m_player1Side ? 'r' : 'R';
-					result.m_rookGlyph = rookGlyph;
-					std::vector<int> rookIndexArr = GetIndexArrForGlyph(rookGlyph);
-					int rookNum = (int)rookIndexArr.size();
-
-					bool isToPieceEmpty = GetGlyphAtCoords(toCoords) == '.';
-
-					if (!isToPieceEmpty)
+					//castling rights are tracked by the position, the rook is on its start square while the right is kept
+					int playerIndex = m_pieces[pieceIndexFrom].m_player1Side ? 1 : 0;
+					bool isKingside = fromToMoveCase.x > 0;
+					int castlingRight = isKingside ? GetKingsideCastlingRight(playerIndex) : GetQueensideCastlingRight(playerIndex);
+					if (!m_position.HasCastlingRight(castlingRight))
 					{
-						result.m_errorMessage = "Invalid move: cannot perform castling, a piece is between the king and rook";
+						result.m_error = ChessMoveError::CASTLING_RIGHT_LOST;
 						return false;
 					}
 
-					//check if there is a piece between king's to coords and rook
-					int distBWToAndRook = 0;
-					IntVec2 rookFromCoords, rookToCoords;
-					for (int i = 0; i < rookNum; i++)
+					int rookSquare = isKingside ? KINGSIDE_ROOK_START_SQUARES[playerIndex] : QUEENSIDE_ROOK_START_SQUARES[playerIndex];
+					int kingSquare = GetBoardStateIndexForBoardCoords(fromCoords);
+					if (GetSquaresBetween(kingSquare, rookSquare) & m_position.GetOccupied())
 					{
-						if (m_pieces[rookIndexArr[i]].m_turnLastMoved != 0)
-						{
-							continue;
-						}
-						tempMoveCase = GetMoveCase(toCoords, m_pieces[rookIndexArr[i]].m_currentCoords);
-						distBWToAndRook = GetTaxicabDistance2D(toCoords, m_pieces[rookIndexArr[i]].m_currentCoords);
-
-						if (tempMoveCase != fromToMoveCase)
-						{
-							continue;
-						}
-
-						IntVec2 tempCoordsBWToAndRook;
-						for (int j = 1; j < distBWToAndRook; j++)
-						{
-							tempCoordsBWToAndRook = toCoords + tempMoveCase;
-							if (GetGlyphAtCoords(tempCoordsBWToAndRook) != '.')
-							{
-								result.m_errorMessage = "Invalid move: cannot perform castling, a piece is between the king and rook";
-								return false;
-							}
-
-						}
-
-						if (tempMoveCase == fromToMoveCase)
-						{
-							result.m_isCastling = true;
-							result.m_rookFromCoords = m_pieces[rookIndexArr[i]].m_currentCoords;
-							result.m_rookToCoords = toCoords - tempMoveCase;
-							result.m_rookIndex = rookIndexArr[i];
-							break;
-						}
-					}
-
-					if (!result.m_isCastling)
-					{
-						result.m_errorMessage = "Invalid move: cannot perform castling, the rook has moved";
+						result.m_error = ChessMoveError::CASTLING_PATH_BLOCKED;
 						return false;
 					}
+
+					moveFlags = isKingside ? MOVE_FLAG_KING_CASTLE : MOVE_FLAG_QUEEN_CASTLE;
+					result.m_rookIndex = GetPieceIndexForCoords(GetBoardCoordsForBoardStateIndex(rookSquare));
 				}
 
 
@@ -672,11 +670,26 @@ bool ChessMatch::CheckMoveValidity(IntVec2 const& fromCoords, IntVec2 const& toC
 
 		}
 
+		//the piece rules passed, the mover still may not leave its own king attacked
+		UpdateLegalTargetCache();
+		if (!IsSquareInBitboard(GetLegalTargetsForCoords(fromCoords), toSquare))
+		{
+			result.m_error = ChessMoveError::LEAVES_KING_IN_CHECK;
+			return false;
+		}
 	}
 
 	
 
-	s_isTeleporting = false;
+	//a straight two square pawn step leaves an en passant square, teleported pawns included
+	bool isPawn = GetPieceTypeForGlyph(fromChessPieceGlyph) == ChessPieceType::PAWN;
+	if (moveFlags == MOVE_FLAG_QUIET && isPawn && fromCoords.x == toCoords.x && abs(toCoords.y - fromCoords.y) == 2)
+	{
+		moveFlags = MOVE_FLAG_DOUBLE_PAWN_PUSH;
+	}
+	result.m_move = ChessMove(fromSquare, toSquare, moveFlags);
+
+	m_context.m_isTeleporting = false;
 	result.m_isValidMove = true;
 
 	return true;
@@ -685,28 +698,17 @@ bool ChessMatch::CheckMoveValidity(IntVec2 const& fromCoords, IntVec2 const& toC
 void ChessMatch::MovePiece(IntVec2 const& fromCoords, IntVec2 const& toCoords)
 {
 	ChessMoveResult result;
-	bool isValid = false;
-	if (ChessMatch::s_hasPreDefinedResult)
-	{
-		result = ChessMatch::s_chessMoveResult;
-		isValid = result.m_isValidMove;
-
-		ChessMatch::s_chessMoveResult = ChessMoveResult();
-		ChessMatch::s_hasPreDefinedResult = false;
-	}
-	else {
-		isValid = CheckMoveValidity(fromCoords, toCoords, result);
-	}
+	bool isValid = CheckMoveValidity(fromCoords, toCoords, result);
 
 
 	if (!isValid)
 	{
-		PrintErrorMsgToConsole(result.m_errorMessage);
+		PrintErrorMsgToConsole(result.GetErrorMessage());
 		return;
 	}
 
 	//if it is my turn and I'm not a spectator
-	if (Game::s_isPlayingRemotely && (s_player1Turn == Game::s_myPlayerIndex) && !Game::s_isSpectator)
+	if (m_context.m_isPlayingRemotely && (m_context.m_player1Turn == m_context.m_myPlayerIndex) && !m_context.m_isSpectator)
 	{
 		//IntVec2 fromFlippedVertically(fromCoords.x, 7 - fromCoords.y);
 		//IntVec2 toFlippedVertically(toCoords.x, 7 - toCoords.y);
@@ -714,13 +716,13 @@ void ChessMatch::MovePiece(IntVec2 const& fromCoords, IntVec2 const& toCoords)
 		//std::string toStr = GetSquareCoordsForBoardCoords(toFlippedVertically);
 
 		EventArgs args;
-		args.SetValue("from", result.m_fromChessPieceCoordsStr.c_str());
-		args.SetValue("to", result.m_toChessPieceCoordsStr.c_str());
-		if (s_isTeleporting)
+		args.SetValue("from", GetSquareCoordsForBoardCoords(fromCoords));
+		args.SetValue("to", GetSquareCoordsForBoardCoords(toCoords));
+		if (m_context.m_isTeleporting)
 		{
 			args.SetValue("teleport", "true");
 		}
-		if (result.m_isPromotion)
+		if (result.IsPromotion())
 		{
 			args.SetValue("promoteTo", "Queen");
 		}
@@ -728,35 +730,31 @@ void ChessMatch::MovePiece(IntVec2 const& fromCoords, IntVec2 const& toCoords)
 	}
 	
 
-	if (result.m_isCastling)
-	{
-		//move piece on layout
-		MovePieceOnLayout(result.m_rookFromCoords, result.m_rookToCoords, result.m_rookGlyph);
+	//the position moves every piece of the move (rook, captured pawn, promotion) and records the undo
+	m_position.MakeMove(result.m_move);
+	m_attackMap.UpdateForMove(m_position, result.m_move);
+	m_isLegalTargetCacheValid = false;
 
+	if (result.IsCastling())
+	{
 		//move piece in vector
-		MovePieceInVector(result.m_rookIndex, result.m_rookToCoords);
+		MovePieceInVector(result.m_rookIndex, GetBoardCoordsForBoardStateIndex(result.GetRookToSquare()));
 	}
 
-	//move piece on layout
-	MovePieceOnLayout(fromCoords, toCoords, result.m_fromChessPieceGlyph);
-
 	//move piece in vector
 	MovePieceInVector(result.m_pieceIndexFrom, toCoords);
 
+	int gameResult = -1;
 
-	if (result.m_isCapturing)
+	std::string const& fromPieceName = m_pieces[result.m_pieceIndexFrom].m_pieceDef->m_name;
+	if (result.IsCapturing())
 	{
-		std::string capturedPieceStr = result.m_toChessPieceStr;
-		std::string coordsString = result.m_toChessPieceCoordsStr;
-		if (result.m_isEnpassant)
-		{
-			capturedPieceStr = m_pieces[result.m_pieceIndexToErase].m_pieceDef->m_name;
-			coordsString = GetSquareCoordsForBoardCoords(m_pieces[result.m_pieceIndexToErase].m_currentCoords);
-		}
+		ChessPiece const& capturedPiece = m_pieces[result.m_pieceIndexToCapture];
 		std::string captureText = Stringf("%s at %s captures %s at %s", 
-			result.m_fromChessPieceStr.c_str(), result.m_fromChessPieceCoordsStr.c_str(), capturedPieceStr.c_str(), coordsString.c_str());
+			fromPieceName.c_str(), GetSquareCoordsForBoardCoords(fromCoords).c_str(),
+			capturedPiece.m_pieceDef->m_name.c_str(), GetSquareCoordsForBoardCoords(capturedPiece.m_currentCoords).c_str());
 		
-		if (result.m_isEnpassant)
+		if (result.IsEnPassant())
 		{
 			captureText.append(": En Passant");
 		}
@@ -765,23 +763,26 @@ void ChessMatch::MovePiece(IntVec2 const& fromCoords, IntVec2 const& toCoords)
 
 		if (result.m_toChessPieceGlyph == 'K')
 		{
-			s_matchEnds = true;
-			s_result = 1;
-
+			gameResult = 1;
 		}
 		else if (result.m_toChessPieceGlyph == 'k')
 		{
-			s_matchEnds = true;
-			s_result = 0;
+			gameResult = 0;
 		}
 
-		m_pieces.erase(m_pieces.begin() + result.m_pieceIndexToErase);
+		//the capturing piece already took over the square, except for en passant
+		int capturedSquare = GetBoardStateIndexForBoardCoords(m_pieces[result.m_pieceIndexToCapture].m_currentCoords);
+		if (m_pieceIndexBySquare[capturedSquare] == result.m_pieceIndexToCapture)
+		{
+			m_pieceIndexBySquare[capturedSquare] = -1;
+		}
+		m_pieces[result.m_pieceIndexToCapture].m_isCaptured = true;
 	}
 	else {
 		std::string moveText = Stringf("%s at %s moves to %s",
-			result.m_fromChessPieceStr.c_str(), result.m_fromChessPieceCoordsStr.c_str(), result.m_toChessPieceCoordsStr.c_str());
+			fromPieceName.c_str(), GetSquareCoordsForBoardCoords(fromCoords).c_str(), GetSquareCoordsForBoardCoords(toCoords).c_str());
 
-		if (result.m_isCastling)
+		if (result.IsCastling())
 		{
 			moveText.append(": Castling");
 		}
@@ -789,40 +790,135 @@ void ChessMatch::MovePiece(IntVec2 const& fromCoords, IntVec2 const& toCoords)
 		
 	}
 
-	if (result.m_isPromotion)
+	if (result.IsPromotion())
 	{
-		const ChessPieceDefinition* promoteToDef = ChessPieceDefinition::GetByGlyph(result.m_promoteToPieceGlyph);
+		const ChessPieceDefinition* promoteToDef = ChessPieceDefinition::GetByGlyph(result.GetPromoteToPieceGlyph());
 		GUARANTEE_OR_DIE(promoteToDef != nullptr, "Error: promoteTo piece glyph cannot be found");
-		ChangePieceForIndex(result.m_pieceIndexFrom, promoteToDef, toCoords, result.m_promoteToPieceGlyph);
-
 		std::string promoteText = Stringf("%s is promoted to %s",
-			result.m_fromChessPieceStr.c_str(), promoteToDef->m_name.c_str());
+			fromPieceName.c_str(), promoteToDef->m_name.c_str());
+		ChangePieceForIndex(result.m_pieceIndexFrom, promoteToDef);
 		g_theDevConsole->Addline(DevConsole::INFO_MAJOR, promoteText);
 	}
 
-	
-	if (s_matchEnds)
+	if (gameResult == -1)
 	{
-		HandleMatchEnd();
+		gameResult = GetGameResultAfterMove();
+	}
+
+	if (gameResult != -1)
+	{
+		SetMatchResultAndEndTheGame(gameResult);
 		//de-highlight the pieces
 		m_highlightingCoords = IntVec2(-1, -1);
 	}
 	else {
 		m_turnNumber++;
-		s_player1Turn = !s_player1Turn;
-		m_game->HandleTurnChange();
+		m_context.m_player1Turn = !m_context.m_player1Turn;
+		m_position.SetPlayerToMove((int)m_context.m_player1Turn);
+		if (m_onTurnChange != nullptr)
+		{
+			m_onTurnChange(*this);
+		}
+	}
+}
+
+int ChessMatch::GetGameResultAfterMove() const
+{
+	//the position already has the opponent to move
+	int opponentIndex = m_position.GetPlayerToMove();
+	std::string const& opponentName = m_players[opponentIndex].m_playerName;
+	switch (GetGameStatus(m_position, m_attackMap))
+	{
+	case ChessGameStatus::CHECK:
+		g_theDevConsole->Addline(DevConsole::INFO_MAJOR, Stringf("%s is in check", opponentName.c_str()));
+		break;
+	case ChessGameStatus::CHECKMATE:
+		g_theDevConsole->Addline(DevConsole::INFO_MAJOR, Stringf("Checkmate: %s has no legal move out of check", opponentName.c_str()));
+		return 1 - opponentIndex;
+	case ChessGameStatus::STALEMATE:
+		g_theDevConsole->Addline(DevConsole::INFO_MAJOR, Stringf("Stalemate: %s has no legal move", opponentName.c_str()));
+		return 2;
+	case ChessGameStatus::ONGOING:
+	default:
+		break;
+	}
+
+	//draws by rule, checkmate on the last move takes precedence
+	if (m_position.IsThreefoldRepetition())
+	{
+		g_theDevConsole->Addline(DevConsole::INFO_MAJOR, "Draw: the same position occurred three times");
+		return 2;
 	}
+	if (m_position.IsFiftyMoveRuleDraw())
+	{
+		g_theDevConsole->Addline(DevConsole::INFO_MAJOR, "Draw: fifty moves without a capture or pawn move");
+		return 2;
+	}
+	return -1;
+}
+
+int ChessMatch::ApplyMoveSequence(const char* moveListText)
+{
+	if (m_context.m_matchEnds)
+	{
+		PrintErrorMsgToConsole(GetMessageForMoveError(ChessMoveError::MATCH_ENDED));
+		return 0;
+	}
+	//the moves are not sent one by one like chessmove commands, so the other machine's board would not follow
+	if (m_context.m_isPlayingRemotely || m_context.m_isSpectator)
+	{
+		PrintErrorMsgToConsole("Invalid command: move sequences can only be replayed in offline matches");
+		return 0;
+	}
+
+	//the whole list is validated and made on the headless position, the pieces are rebuilt once at the end
+	ChessPosition replayedPosition = m_position;
+	int numMovesApplied = 0;
+	int firstIllegalIndex = ::ApplyMoveSequence(replayedPosition, moveListText, numMovesApplied, true);
+	if (firstIllegalIndex != MOVE_SEQUENCE_ALL_APPLIED && IsGameOverPosition(replayedPosition))
+	{
+		PrintErrorMsgToConsole(Stringf("Invalid move sequence: move %d ends the game, the moves after it were not applied", firstIllegalIndex));
+	}
+	else if (firstIllegalIndex != MOVE_SEQUENCE_ALL_APPLIED)
+	{
+		PrintErrorMsgToConsole(Stringf("Invalid move sequence: move %d is illegal or malformed, %d moves were applied", firstIllegalIndex + 1, numMovesApplied));
+	}
+	if (numMovesApplied == 0)
+	{
+		return numMovesApplied;
+	}
+
+	m_position = replayedPosition;
+	m_attackMap.Rebuild(m_position);
+	m_isLegalTargetCacheValid = false;
+	m_turnNumber += numMovesApplied;
+	m_context.m_player1Turn = m_position.GetPlayerToMove() == 1;
+	m_highlightingCoords = IntVec2(-1, -1);
+	m_selectedPiece = nullptr;
+	InitPiecesToMatchBoardState(m_players[0], m_players[1]);
+	PrintInfoMsgToConsole(Stringf("Replayed %d moves", numMovesApplied));
+
+	int gameResult = GetGameResultAfterMove();
+	if (gameResult != -1)
+	{
+		SetMatchResultAndEndTheGame(gameResult);
+	}
+	else if (m_onTurnChange != nullptr)
+	{
+		m_onTurnChange(*this);
+	}
+	return numMovesApplied;
 }
 
 void ChessMatch::HandleMatchEnd()
 {
 	std::string winningPlayer = "Non-Determined";
 
-	switch (s_result)
+	switch (m_context.m_result)
 	{
-	case 0: winningPlayer = App::s_theGame->m_players[0].m_playerName;
+	case 0: winningPlayer = m_players[0].m_playerName;
 		break;
-	case 1: winningPlayer = App::s_theGame->m_players[1].m_playerName;
+	case 1: winningPlayer = m_players[1].m_playerName;
 		break;
 	case 2: winningPlayer = "No One (Draw)";
 		break;
@@ -839,39 +935,79 @@ void ChessMatch::HandleMatchEnd()
 	
 }
 
-void ChessMatch::ResetMatchData()
+void ChessMatch::RegisterMatch()
 {
-	ChessMatch::s_formerCoords = IntVec2(0, 0);
-	ChessMatch::s_desiredCoords = IntVec2(0, 0);
-	ChessMatch::s_promoteToPiece = '?';
-	ChessMatch::s_matchEnds = false;
-	ChessMatch::s_result = -1;
-	ChessMatch::s_player1Turn = false;
-	
+	std::lock_guard<std::mutex> lock(s_matchesByIDMutex);
+	m_context.m_matchID = s_nextMatchID++;
+	s_matchesByID[m_context.m_matchID] = this;
+}
+
+void ChessMatch::SetNetworkRole(bool isPlayingRemotely, bool myPlayerIndex, bool isSpectator)
+{
+	m_context.m_isPlayingRemotely = isPlayingRemotely;
+	m_context.m_myPlayerIndex = myPlayerIndex;
+	m_context.m_isSpectator = isSpectator;
+}
+
+void ChessMatch::SetPlayerName(int playerIndex, std::string const& name)
+{
+	m_players[playerIndex].m_playerName = name;
+}
+
+void ChessMatch::SetTurnChangeCallback(ChessMatchCallback callback)
+{
+	m_onTurnChange = callback;
 }
 
 void ChessMatch::SetBoardStateByString(std::string const& layout)
 {
-	layout.copy(m_layout, 64, 0);
+	//a FEN also carries castling rights, en passant and both move counters, a 64 character layout only the pieces
+	if (layout.find('/') != std::string::npos)
+	{
+		ChessPosition parsedPosition;
+		if (!parsedPosition.SetFromFEN(layout.c_str()))
+		{
+			PrintErrorMsgToConsole(Stringf("Invalid board state: cannot parse FEN \"%s\"", layout.c_str()));
+			return;
+		}
+		m_position = parsedPosition;
+		m_context.m_player1Turn = m_position.GetPlayerToMove() == 1;
+		m_turnNumber = (m_position.GetFullmoveNumber() - 1) * 2 + m_position.GetPlayerToMove() + 1;
+	}
+	else
+	{
+		if (layout.size() < 64)
+		{
+			PrintErrorMsgToConsole("Invalid board state: layout must have 64 characters");
+			return;
+		}
+		m_position.SetFromBoardState(layout.c_str(), (int)m_context.m_player1Turn);
+	}
+	m_attackMap.Rebuild(m_position);
+	m_isLegalTargetCacheValid = false;
 }
 
 void ChessMatch::InitPiecesToMatchBoardState(Player const& player0, Player const& player1)
 {
+	m_players[0] = player0;
+	m_players[1] = player1;
 	const ChessPieceDefinition* tempDef = nullptr;
 	m_pieces.clear();
 	m_pieces.reserve(64);
-	int layoutNum = 64;
+	for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+	{
+		m_pieceIndexBySquare[square] = -1;
+	}
 	IntVec2 tempBoardCoords;
-	Texture* tempTexture = m_game->m_pieceTexturePack[0];
-	Texture* tempNormalTexture = m_game->m_pieceTexturePack[1];
-	Texture* tempSGETexture = m_game->m_pieceTexturePack[2];
-
-	for (int i = 0; i < layoutNum; i++) {
-		if (m_layout[i] == '.')
-		{
-			continue;
-		}
-		tempDef = ChessPieceDefinition::GetByGlyph(m_layout[i]);
+	Texture* tempTexture = m_game != nullptr ? m_game->m_pieceTexturePack[0] : nullptr;
+	Texture* tempNormalTexture = m_game != nullptr ? m_game->m_pieceTexturePack[1] : nullptr;
+	Texture* tempSGETexture = m_game != nullptr ? m_game->m_pieceTexturePack[2] : nullptr;
+
+	Bitboard occupied = m_position.GetOccupied();
+	while (occupied != EMPTY_BITBOARD) {
+		int i = PopLowestSquare(occupied);
+		char glyph = m_position.GetGlyphAtSquare(i);
+		tempDef = ChessPieceDefinition::GetByGlyph(glyph);
 		if (tempDef == nullptr)
 		{
 			continue;
@@ -885,7 +1021,7 @@ void ChessMatch::InitPiecesToMatchBoardState(Player const& player0, Player const
 		tempPiece.m_prevCoords = tempBoardCoords;
 		tempPiece.m_currentCoords = tempBoardCoords;
 		tempPiece.m_position = Vec3(tempBoardCoords.x + 0.5f, tempBoardCoords.y + 0.5f, BOARD_HEIGHT);
-		bool player1Side = islower(m_layout[i]) != 0; //if is lower case, returns nonzero
+		bool player1Side = m_position.GetPlayerIndexAtSquare(i) == 1;
 		tempPiece.m_player1Side = player1Side;
 		tempPiece.m_color = player1Side ? player1.m_playerColor : player0.m_playerColor;
 		tempPiece.m_orientation = player1Side ? EulerAngles(-90, 0, 0) : EulerAngles(90, 0, 0);
@@ -893,6 +1029,7 @@ void ChessMatch::InitPiecesToMatchBoardState(Player const& player0, Player const
 		tempPiece.m_normalTexture = tempNormalTexture;
 		tempPiece.m_sgeTexture = tempSGETexture;
 		tempPiece.m_numIndices = tempDef->m_numIndices;
+		m_pieceIndexBySquare[i] = (int)m_pieces.size();
 		m_pieces.push_back(tempPiece);
 	}
 }
@@ -900,23 +1037,34 @@ void ChessMatch::InitPiecesToMatchBoardState(Player const& player0, Player const
 void ChessMatch::SetPieceToCoords(char piece, IntVec2 const& coords)
 {
 	int index = GetBoardStateIndexForBoardCoords(coords);
-	m_layout[index] = piece;
+	m_position.SetGlyphAtSquare(index, piece);
+	m_attackMap.UpdateForChangedSquares(m_position, GetBitboardForSquare(index));
+	m_isLegalTargetCacheValid = false;
 
 }
 
 
 std::string ChessMatch::GetBoardStateAsString() const
 {
-	return std::string(m_layout);
+	char layout[64];
+	m_position.WriteBoardState(layout);
+	return std::string(layout, 64);
+}
+
+std::string ChessMatch::GetFEN() const
+{
+	char fen[ChessPosition::MAX_FEN_LENGTH];
+	int length = m_position.WriteFEN(fen, ChessPosition::MAX_FEN_LENGTH);
+	return std::string(fen, length);
 }
 
 std::string ChessMatch::GetGameStateAsString() const
 {
-	if (s_matchEnds)
+	if (m_context.m_matchEnds)
 	{
 		return std::string("GameOver");
 	}
-	if (s_player1Turn)
+	if (m_context.m_player1Turn)
 	{
 		return std::string("Player2Moving");
 	}else
@@ -928,71 +1076,55 @@ std::string ChessMatch::GetGameStateAsString() const
 
 char ChessMatch::GetGlyphAtCoords(IntVec2 const& coords) const
 {
-	int index = GetBoardStateIndexForBoardCoords(coords);
-	if (index < 0 || index > 63)
+	if (!IsBoardCoordsValid(coords))
 	{
 		return '?';
 	}
-	return m_layout[index];
+	return m_position.GetGlyphAtSquare(GetBoardStateIndexForBoardCoords(coords));
 }
 
 std::vector<int> ChessMatch::GetIndexArrForGlyph(char const glyph) const
 {
 	std::vector<int> arr;
-	int layoutNum = 64;
-	for (int i = 0; i < layoutNum; i++) {
-		if (m_layout[i] == '.')
-		{
-			continue;
-		}
-		if (m_layout[i] == glyph)
-		{
-			arr.push_back(i);
-		}
+	ChessPieceType type = GetPieceTypeForGlyph(glyph);
+	if (type == ChessPieceType::NONE)
+	{
+		return arr;
+	}
+	Bitboard pieces = m_position.GetPieces(GetPlayerIndexForGlyph(glyph), type);
+	while (pieces != EMPTY_BITBOARD)
+	{
+		arr.push_back(PopLowestSquare(pieces));
 	}
 	return arr;
 }
 
 int ChessMatch::GetPlayerIndexForPieceAtCoords(IntVec2 const& coords) const
 {
-	char glyph = GetGlyphAtCoords(coords);
-
-	if (glyph == 'P' || glyph == 'R' || glyph == 'N' || glyph == 'B' || glyph == 'Q'||  glyph == 'K')
-	{
-		return 0;
-	}
-	if (glyph == 'p' || glyph == 'r' || glyph == 'n' || glyph == 'b' || glyph == 'q' || glyph == 'k')
+	if (!IsBoardCoordsValid(coords))
 	{
-		return 1;
+		return -1;
 	}
-
-	return -1;
+	return m_position.GetPlayerIndexAtSquare(GetBoardStateIndexForBoardCoords(coords));
 }
 
 int ChessMatch::GetPieceIndexForCoords(IntVec2 const& coords) const
 {
-	int numPieces = (int)m_pieces.size();
-	for (int i = 0; i < numPieces; i++)
+	if (!IsBoardCoordsValid(coords))
 	{
-		if (m_pieces[i].m_currentCoords == coords)
-		{
-			return i;
-		}
+		return -1;
 	}
-	return -1;
+	return m_pieceIndexBySquare[GetBoardStateIndexForBoardCoords(coords)];
 }
 
 const ChessPiece* ChessMatch::GetPieceAtCoords(IntVec2 const& coords) const
 {
-	int numPieces = (int)m_pieces.size();
-	for (int i = 0; i < numPieces; i++)
+	int pieceIndex = GetPieceIndexForCoords(coords);
+	if (pieceIndex == -1)
 	{
-		if (m_pieces[i].m_currentCoords == coords)
-		{
-			return &m_pieces[i];
-		}
+		return nullptr;
 	}
-	return nullptr;
+	return &m_pieces[pieceIndex];
 }
 
 const ChessPiece* ChessMatch::GetPieceAtIndex(int index) const
@@ -1000,9 +1132,28 @@ const ChessPiece* ChessMatch::GetPieceAtIndex(int index) const
 	return &m_pieces[index];
 }
 
+const ChessPosition& ChessMatch::GetPosition() const
+{
+	return m_position;
+}
+
+Bitboard ChessMatch::GetLegalTargetsForCoords(IntVec2 const& coords) const
+{
+	if (!IsBoardCoordsValid(coords))
+	{
+		return EMPTY_BITBOARD;
+	}
+	return m_legalTargetsBySquare[GetBoardStateIndexForBoardCoords(coords)];
+}
+
+uint64_t ChessMatch::GetPositionHash() const
+{
+	return m_position.GetHash();
+}
+
 bool ChessMatch::GetIsPlayer1Turn() const
 {
-	return s_player1Turn;
+	return m_context.m_player1Turn;
 }
 
 int ChessMatch::GetTurnNum() const
@@ -1012,12 +1163,21 @@ int ChessMatch::GetTurnNum() const
 
 bool ChessMatch::IsMatchFinished() const
 {
-	return s_matchEnds;
+	return m_context.m_matchEnds;
+}
+
+bool ChessMatch::IsLocalPlayerTurn() const
+{
+	if (!m_context.m_isPlayingRemotely)
+	{
+		return true;
+	}
+	return m_context.m_player1Turn == m_context.m_myPlayerIndex && !m_context.m_isSpectator;
 }
 
 int ChessMatch::GetResult() const
 {
-	return s_result;
+	return m_context.m_result;
 }
 
 IntVec2 ChessMatch::GetMoveCase(IntVec2 const& fromCoords, IntVec2 const& toCoords) const
@@ -1065,7 +1225,135 @@ IntVec2 ChessMatch::GetBoardCoordsForWorldPos(Vec3 const& pos) const
 	return coords;
 }
 
+int ChessMatch::GetBlockingSquareBetween(IntVec2 const& fromCoords, IntVec2 const& toCoords) const
+{
+	int fromSquare = GetBoardStateIndexForBoardCoords(fromCoords);
+	int toSquare = GetBoardStateIndexForBoardCoords(toCoords);
+
+	//knight shaped moves have nothing in between
+	Bitboard blockers = GetSquaresBetween(fromSquare, toSquare) & m_position.GetOccupied();
+	if (blockers == EMPTY_BITBOARD)
+	{
+		return NO_SQUARE;
+	}
+
+	//report the blocker closest to the moving piece
+	return toSquare > fromSquare ? GetLowestSquare(blockers) : GetHighestSquare(blockers);
+}
+
+int ChessMatch::GetBlockingSquareByPieceScan(int fromPieceIndex, IntVec2 const& toCoords) const
+{
+	IntVec2 fromCoords = m_pieces[fromPieceIndex].m_currentCoords;
+	IntVec2 fromToMoveCase = GetMoveCase(fromCoords, toCoords);
+	int fromToDist = GetTaxicabDistance2D(fromCoords, toCoords);
+
+	int pieceNum = (int)m_pieces.size();
+	for (int i = 0; i < pieceNum; i++)
+	{
+		IntVec2 tempCoords = m_pieces[i].m_currentCoords;
+		if (m_pieces[i].m_isCaptured || tempCoords == fromCoords || tempCoords == toCoords)
+		{//ignore the from piece and to piece
+			continue;
+		}
+		IntVec2 tempMoveCase = GetMoveCase(fromCoords, tempCoords);
+		int tempDist = GetTaxicabDistance2D(fromCoords, tempCoords);
+
+		if (tempDist < fromToDist
+			&& tempMoveCase == fromToMoveCase
+			&& m_pieces[fromPieceIndex].IsValidMoveForCoords(tempCoords))
+		{
+			return GetBoardStateIndexForBoardCoords(tempCoords);
+		}
+	}
+	return NO_SQUARE;
+}
+
+void ChessMatch::RunBlockerBenchmark(int iterations) const
+{
+	//collect every (piece, destination) pair the blocker test runs for
+	std::vector<int> pieceIndices;
+	std::vector<IntVec2> toCoordsArr;
+	int numPieces = (int)m_pieces.size();
+	for (int i = 0; i < numPieces; i++)
+	{
+		if (m_pieces[i].m_isCaptured || m_pieces[i].m_pieceDef->m_type == ChessPieceType::KNIGHT)
+		{
+			continue;
+		}
+		for (int square = 0; square < 64; square++)
+		{
+			IntVec2 toCoords = GetBoardCoordsForBoardStateIndex(square);
+			if (toCoords != m_pieces[i].m_currentCoords && m_pieces[i].IsValidMoveForCoords(toCoords))
+			{
+				pieceIndices.push_back(i);
+				toCoordsArr.push_back(toCoords);
+			}
+		}
+	}
+
+	int numQueries = (int)pieceIndices.size();
+	if (numQueries == 0 || iterations <= 0)
+	{
+		PrintErrorMsgToConsole("ChessBenchmark: nothing to benchmark");
+		return;
+	}
+
+	//both must agree on whether the move is blocked
+	int numMismatches = 0;
+	for (int q = 0; q < numQueries; q++)
+	{
+		bool isBlockedByScan = GetBlockingSquareByPieceScan(pieceIndices[q], toCoordsArr[q]) != NO_SQUARE;
+		bool isBlockedByTable = GetBlockingSquareBetween(m_pieces[pieceIndices[q]].m_currentCoords, toCoordsArr[q]) != NO_SQUARE;
+		if (isBlockedByScan != isBlockedByTable)
+		{
+			numMismatches++;
+		}
+	}
+
+	volatile int sink = 0;
+	double scanStartTime = GetCurrentTimeSeconds();
+	for (int n = 0; n < iterations; n++)
+	{
+		for (int q = 0; q < numQueries; q++)
+		{
+			sink = sink + GetBlockingSquareByPieceScan(pieceIndices[q], toCoordsArr[q]);
+		}
+	}
+	double scanSeconds = GetCurrentTimeSeconds() - scanStartTime;
+
+	double tableStartTime = GetCurrentTimeSeconds();
+	for (int n = 0; n < iterations; n++)
+	{
+		for (int q = 0; q < numQueries; q++)
+		{
+			sink = sink + GetBlockingSquareBetween(m_pieces[pieceIndices[q]].m_currentCoords, toCoordsArr[q]);
+		}
+	}
+	double tableSeconds = GetCurrentTimeSeconds() - tableStartTime;
+
+	double totalQueries = (double)numQueries * (double)iterations;
+	double scanNanoseconds = scanSeconds * 1000000000.0 / totalQueries;
+	double tableNanoseconds = tableSeconds * 1000000000.0 / totalQueries;
+	PrintInfoMsgToConsole(Stringf("ChessBenchmark: %d queries x %d iterations, %d pieces on board", numQueries, iterations, numPieces));
+	PrintInfoMsgToConsole(Stringf("ChessBenchmark: piece scan %.2f ns/query, attack tables %.2f ns/query (%.1fx)",
+		scanNanoseconds, tableNanoseconds, tableNanoseconds > 0.0 ? scanNanoseconds / tableNanoseconds : 0.0));
+	if (numMismatches > 0)
+	{
+		PrintErrorMsgToConsole(Stringf("ChessBenchmark: %d queries disagree between piece scan and attack tables", numMismatches));
+	}
+}
+
 bool ChessMatch::Event_ChessMove(EventArgs& args)
+{
+	ChessMatch* match = GetMatchForEventArgs(args);
+	if (match == nullptr)
+	{
+		return false;
+	}
+	return match->QueueMoveCommand(args);
+}
+
+bool ChessMatch::QueueMoveCommand(EventArgs& args)
 {
 	if (args.GetKeyNums() < 2)// && args.GetKeyNums() > 4)
 	{
@@ -1115,38 +1403,118 @@ bool ChessMatch::Event_ChessMove(EventArgs& args)
 		PrintErrorMsgToConsole("Invalid teleport args format, Correct format: teleport=true");
 		return false;
 	}
-	s_isTeleporting = isTeleporting == "true";
+	m_context.m_isTeleporting = isTeleporting == "true";
 
 
-	ChessMatch::s_formerCoords = GetBoardCoordsForUserString(fromSquareCoords);
-	ChessMatch::s_desiredCoords = GetBoardCoordsForUserString(toSquareCoords);
+	m_context.m_formerCoords = GetBoardCoordsForUserString(fromSquareCoords);
+	m_context.m_desiredCoords = GetBoardCoordsForUserString(toSquareCoords);
 
 	if (hasPromoteToArgs)
 	{
 		const ChessPieceDefinition* def = ChessPieceDefinition::GetByName(promoteToPiece);
-		ChessMatch::s_promoteToPiece = s_player1Turn ? def->m_glyphlowerCase : def->m_glyphUpperCase;
+		m_context.m_promoteToPiece = m_context.m_player1Turn ? def->m_glyphlowerCase : def->m_glyphUpperCase;
 	}
 	
 	return true;
 }
 
-bool ChessMatch::Event_Resign(EventArgs& args)
+/* [local] ChessBenchmark [iterations=<count>]
+Times the old per-piece blocker loop against the attack table lookup on the current board
+a.	Example: ChessBenchmark iterations=1000
+*/
+bool ChessMatch::Event_ChessBenchmark(EventArgs& args)
 {
-	if (s_matchEnds)
+	const ChessMatch* match = GetMatchForEventArgs(args);
+	if (match == nullptr)
 	{
-		PrintErrorMsgToConsole("Invalid command: Match Ended");
+		return false;
+	}
+	int iterations = args.GetValue("iterations", 1000);
+	match->RunBlockerBenchmark(iterations);
+	return true;
+}
+
+/* [local] ChessReplay moves=<e2e4,e7e5,...> [matchID=<id>]
+Validates and plays a whole move list in coordinate notation, stops at the first illegal move
+or after the move that ends the game, offline matches only
+a.	Example: ChessReplay moves=e2e4,e7e5,g1f3,b8c6
+*/
+bool ChessMatch::Event_ChessReplay(EventArgs& args)
+{
+	std::string moves = args.GetValue("moves", "");
+	if (moves.empty())
+	{
+		PrintErrorMsgToConsole("Invalid command args, Correct format: ChessReplay moves=e2e4,e7e5");
 		return true;
 	}
+	ChessMatch* match = GetMatchForEventArgs(args);
+	if (match == nullptr)
+	{
+		return true;
+	}
+	match->ApplyMoveSequence(moves.c_str());
+	return true;
+}
 
-	if (args.GetKeyNums() > 0)
+bool ChessMatch::Event_Resign(EventArgs& args)
+{
+	int numMatchIDArgs = args.GetValue("matchID", "") != "" ? 1 : 0;
+	if (args.GetKeyNums() > numMatchIDArgs)
 	{
 		PrintErrorMsgToConsole("Invalid command args number, Correct format: resign");
 		return true;
 	}
 
-	s_matchEnds = true;
-	s_result = s_player1Turn? 0 : 1;
-	HandleMatchEnd();
+	ChessMatch* match = GetMatchForEventArgs(args);
+	if (match == nullptr)
+	{
+		return true;
+	}
+	if (match->m_context.m_matchEnds)
+	{
+		PrintErrorMsgToConsole("Invalid command: Match Ended");
+		return true;
+	}
+	match->SetMatchResultAndEndTheGame(match->m_context.m_player1Turn ? 0 : 1);
 
 	return true;
 }
+
+ChessMatch* ChessMatch::GetMatchByID(int matchID)
+{
+	std::lock_guard<std::mutex> lock(s_matchesByIDMutex);
+	auto found = s_matchesByID.find(matchID);
+	return found == s_matchesByID.end() ? nullptr : found->second;
+}
+
+ChessMatch* ChessMatch::GetMatchForEventArgs(EventArgs& args)
+{
+	//without a matchID the command goes to the match this process is showing
+	int matchID = args.GetValue("matchID", -1);
+	ChessMatch* match = matchID == -1 ? App::s_theGame->m_currentMatch : GetMatchByID(matchID);
+	if (match == nullptr)
+	{
+		PrintErrorMsgToConsole(matchID == -1 ? "Error: there is no ongoing match" : Stringf("Error: there is no match with matchID=%d", matchID));
+	}
+	return match;
+}
+
+int ChessMatch::GetMatchID() const
+{
+	return m_context.m_matchID;
+}
+
+MatchContext& ChessMatch::GetContext()
+{
+	return m_context;
+}
+
+MatchContext const& ChessMatch::GetContext() const
+{
+	return m_context;
+}
+
+Player const& ChessMatch::GetPlayerByIndex(int playerIndex) const
+{
+	return m_players[playerIndex];
+}
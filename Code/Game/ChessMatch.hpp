@@ -1,50 +1,103 @@
 #pragma once
 #include "Game/ChessPiece.hpp"
 #include "Game/ChessPieceDefinition.hpp"
+#include "Game/ChessPosition.hpp"
+#include "Game/ChessAttacks.hpp"
+#include "Game/ChessAttackMap.hpp"
 #include "Game/Player.hpp"
 
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
 
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
 class Game;
+class ChessMatch;
+
+typedef void (*ChessMatchCallback)(ChessMatch& match);
+
+
+//why a move command was rejected, the sentence for the console is only built by GetMessageForMoveError
+enum class ChessMoveError {
+	NONE,
+	MATCH_ENDED,
+	FROM_SQUARE_EMPTY,
+	FROM_PIECE_IS_OPPONENTS,
+	TO_PIECE_IS_OWN,
+	FROM_EQUALS_TO,
+	PROMOTE_NON_PAWN,
+	NOT_A_MOVE_FOR_PIECE,
+	PATH_BLOCKED,
+	PAWN_FORWARD_CAPTURE,
+	MISSING_PROMOTE_TO,
+	PAWN_DIAGONAL_TO_EMPTY,
+	KINGS_ADJACENT,
+	CASTLING_RIGHT_LOST,
+	CASTLING_PATH_BLOCKED,
+	LEAVES_KING_IN_CHECK,
+	COUNT
+};
+
+//pieceGlyph and square give the context some reasons need (moving piece, blocking piece and its square)
+std::string GetMessageForMoveError(ChessMoveError error, char pieceGlyph = '.', char blockingGlyph = '.', int blockingSquare = NO_SQUARE);
 
 
+//outcome of CheckMoveValidity: the packed move carries squares and special rules,
+//piece names and coordinate strings are only derived when a console line or network message is written
 struct ChessMoveResult {
 
 	ChessMoveResult() = default;
 	~ChessMoveResult() = default;
 
-	int m_pieceIndexToErase = -1;
+	ChessMove m_move;
+	int m_pieceIndexToCapture = -1;
 	int m_pieceIndexFrom = -1;
-	int m_pieceIndexTo = -1;
-	std::string m_fromChessPieceStr;
-	std::string m_toChessPieceStr;
-	std::string m_fromChessPieceCoordsStr;
-	std::string m_toChessPieceCoordsStr;
+	int m_rookIndex = -1;//castling only
 	char m_fromChessPieceGlyph = '.';
 	char m_toChessPieceGlyph = '.';
 
-	std::string m_errorMessage = "UNKNOWN ERROR";
+	//rejection reason with its context, formatting is left to whoever reports it
+	ChessMoveError m_error = ChessMoveError::NONE;
+	char m_blockingGlyph = '.';
+	int m_blockingSquare = NO_SQUARE;
+
+	bool m_isValidMove = false;
 
-	//castling special
-	int m_rookIndex = -1;
-	IntVec2 m_rookFromCoords;
-	IntVec2 m_rookToCoords;
-	char m_rookGlyph = '.';
+	bool IsCastling()const { return m_move.IsCastling(); }
+	bool IsPromotion()const { return m_move.IsPromotion(); }
+	bool IsEnPassant()const { return m_move.IsEnPassant(); }
+	bool IsCapturing()const { return m_move.IsCapture(); }
+	char GetPromoteToPieceGlyph()const { return GetGlyphForPiece(m_move.GetPromotionType(), GetPlayerIndexForGlyph(m_fromChessPieceGlyph)); }
+	int GetRookToSquare()const { return m_move.GetFlags() == MOVE_FLAG_KING_CASTLE ? m_move.GetToSquare() - 1 : m_move.GetToSquare() + 1; }
+	std::string GetErrorMessage()const { return GetMessageForMoveError(m_error, m_fromChessPieceGlyph, m_blockingGlyph, m_blockingSquare); }
+};
 
-	//promotion special
-	char m_promoteToPieceGlyph = '.';
 
-	//special rules
-	bool m_isValidMove = false;
-	bool m_isCastling = false;
-	bool m_isPromotion = false;
-	bool m_isEnpassant = false;
-	bool m_isCapturing = false;
+//all state of one match that used to live in statics, so one process can run many matches at once
+struct MatchContext
+{
+	int m_matchID = -1;
+
+	//move command waiting for the next update
+	IntVec2 m_formerCoords = IntVec2(0, 0);
+	IntVec2 m_desiredCoords = IntVec2(0, 0);
+	char m_promoteToPiece = '?';
+	bool m_autoPromoteToQueen = false;
+	bool m_isTeleporting = false;
+
+	bool m_matchEnds = false;
+	int m_result = -1; //0 = player 0 wins, 1 = player 1 wins, 2 = draw, -1 = non-determined
+	bool m_player1Turn = false;
+
+	//network role of the local process in this match, nothing else keeps a copy of it
+	bool m_isPlayingRemotely = false;
+	bool m_myPlayerIndex = false;
+	bool m_isSpectator = false;
 };
 
 
@@ -74,21 +127,29 @@ public:
 	void HandlePlayerTeleporting(bool isTeleporting);
 
 	void UpdateMovePieceCommand();
-	void MovePieceOnLayout(IntVec2 const& fromCoords, IntVec2 const& toCoords, char const glyph);
 	void MovePieceInVector(int fromPieceIndex, IntVec2 const& toCoords);
-	void ChangePieceForIndex(int pieceIndex, const ChessPieceDefinition* def, IntVec2 const& coords, char const glyph);
+	void ChangePieceForIndex(int pieceIndex, const ChessPieceDefinition* def);
 	bool CheckMoveValidity(IntVec2 const& fromCoords, IntVec2 const& toCoords, ChessMoveResult& result);
 	void MovePiece(IntVec2 const& fromCoords, IntVec2 const& toCoords);
+	void UpdateLegalTargetCache();//regenerates the legal moves once after the position changed
 
 	//set function
-	void SetBoardStateByString(std::string const& layout);
+	void SetBoardStateByString(std::string const& layout);//64 character layout or FEN
 	void InitPiecesToMatchBoardState(Player const& player0, Player const& player1);
 	void SetPieceToCoords(char piece, IntVec2 const& coords);
 	void SetTurnNumber(int turnNumber);
 	void SetMatchResultAndEndTheGame(int gameResult);
+	void SetNetworkRole(bool isPlayingRemotely, bool myPlayerIndex, bool isSpectator);
+	void SetPlayerName(int playerIndex, std::string const& name);
+	void SetTurnChangeCallback(ChessMatchCallback callback);//called after every move that does not end the match
 
 	//get function
+	int GetMatchID()const;
+	MatchContext& GetContext();
+	MatchContext const& GetContext()const;
+	Player const& GetPlayerByIndex(int playerIndex)const;
 	std::string GetBoardStateAsString()const;
+	std::string GetFEN()const;
 	std::string GetGameStateAsString()const;
 	char GetGlyphAtCoords(IntVec2 const& coords)const;
 	std::vector<int> GetIndexArrForGlyph(char const glyph)const;
@@ -96,34 +157,48 @@ public:
 	int GetPieceIndexForCoords(IntVec2 const& coords)const;
 	const ChessPiece* GetPieceAtCoords(IntVec2 const& coords)const;
 	const ChessPiece* GetPieceAtIndex(int index)const;
+	const ChessPosition& GetPosition()const;
+	uint64_t GetPositionHash()const;//zobrist key of the current position, no allocation unlike GetBoardStateAsString
+	Bitboard GetLegalTargetsForCoords(IntVec2 const& coords)const;//from the cache, empty for invalid coords
 	bool GetIsPlayer1Turn()const;
 	int GetTurnNum()const;
 	bool IsMatchFinished()const;
+	bool IsLocalPlayerTurn()const;//the player to move sits at this machine, not across the network
 	int GetResult()const;
 	IntVec2 GetMoveCase(IntVec2 const& fromCoords, IntVec2 const& toCoords)const;
 	IntVec2 GetBoardCoordsForWorldPos(Vec3 const& pos)const;
+	int GetBlockingSquareBetween(IntVec2 const& fromCoords, IntVec2 const& toCoords)const;//NO_SQUARE if the path is clear
+	int GetBlockingSquareByPieceScan(int fromPieceIndex, IntVec2 const& toCoords)const;//old per-piece loop, kept for benchmarking
+	void RunBlockerBenchmark(int iterations)const;
+
+	bool QueueMoveCommand(EventArgs& args);
+	int ApplyMoveSequence(const char* moveListText);//returns the number of moves played, stops at the first illegal one or at the end of the game
+	int GetGameResultAfterMove()const;//-1 if the match goes on, prints check, mate and draws to the console
+	void HandleMatchEnd();
 
+	//events take an optional matchID=<id>, without it they go to the game's current match
 	static bool Event_ChessMove(EventArgs& args);
 	static bool Event_Resign(EventArgs& args);
-	static void HandleMatchEnd();
-	static void ResetMatchData();
-
-	static ChessMoveResult s_chessMoveResult;
-	static bool s_hasPreDefinedResult;
-	static IntVec2 s_formerCoords;
-	static IntVec2 s_desiredCoords;
-	static char s_promoteToPiece;
-	static bool s_autoPromoteToQueen;
-	static bool s_matchEnds;
-	static int s_result; //0 = player 0 wins, 1 = player 1 wins, 2 = draw, -1 = non-determined
-	static bool s_player1Turn;
-	static bool s_isTeleporting;
-	
+	static bool Event_ChessBenchmark(EventArgs& args);
+	static bool Event_ChessReplay(EventArgs& args);
+	static ChessMatch* GetMatchByID(int matchID);
+	static ChessMatch* GetMatchForEventArgs(EventArgs& args);
 
 private:
+	void RegisterMatch();
+
+private:
+	static std::map<int, ChessMatch*> s_matchesByID;
+	static std::mutex s_matchesByIDMutex;
+	static int s_nextMatchID;
 
 	Game* m_game = nullptr;
-	char m_layout[64] = {};
+	MatchContext m_context;
+	//names for the console and piece colors, a match without a Game keeps these defaults
+	Player m_players[2] = { Player(0, "Player0", Rgba8::WHITE), Player(1, "Player1", Rgba8::BLACK) };
+	ChessMatchCallback m_onTurnChange = nullptr;
+	ChessPosition m_position;
+	ChessAttackMap m_attackMap;
 	int m_turnNumber = 1;
 
 	//player selection
@@ -132,7 +207,15 @@ private:
 	ChessPiece* m_selectedPiece = nullptr;
 
 
+	//pieces keep their slot for the whole match, captured ones are only flagged,
+	//so piece indices and pointers stay valid; the mailbox maps a square to its slot
 	std::vector<ChessPiece> m_pieces;
+	int m_pieceIndexBySquare[NUM_BOARD_SQUARES] = {};
+
+	//legal destinations of the player to move by origin square, so highlighting is a bit test
+	Bitboard m_legalTargetsBySquare[NUM_BOARD_SQUARES] = {};
+	bool m_isLegalTargetCacheValid = false;
+	mutable std::vector<Vertex_PCU> m_selectionVerts;//kept between frames so rendering the selection does not allocate
 
 
 };
@@ -0,0 +1,108 @@
+#pragma once
+#include "Game/ChessCommon.hpp"
+
+
+//move flags, stored in the top 4 bits of a ChessMove
+enum ChessMoveFlag : unsigned short
+{
+	MOVE_FLAG_QUIET = 0,
+	MOVE_FLAG_DOUBLE_PAWN_PUSH = 1,
+	MOVE_FLAG_KING_CASTLE = 2,
+	MOVE_FLAG_QUEEN_CASTLE = 3,
+	MOVE_FLAG_CAPTURE = 4,
+	MOVE_FLAG_EN_PASSANT = 5,
+	MOVE_FLAG_PROMOTION = 8,//+0 knight, +1 bishop, +2 rook, +3 queen, +MOVE_FLAG_CAPTURE if capturing
+};
+
+
+//16 bit move: bits 0-5 from square, bits 6-11 to square, bits 12-15 ChessMoveFlag
+struct ChessMove
+{
+public:
+	ChessMove() = default;
+	constexpr ChessMove(int fromSquare, int toSquare, int flags)
+		:m_data((unsigned short)(fromSquare | (toSquare << 6) | (flags << 12)))
+	{
+	}
+
+	constexpr int GetFromSquare()const { return m_data & 0x3F; }
+	constexpr int GetToSquare()const { return (m_data >> 6) & 0x3F; }
+	constexpr int GetFlags()const { return m_data >> 12; }
+
+	constexpr bool IsNull()const { return m_data == 0; }
+	constexpr bool IsCapture()const { return (GetFlags() & MOVE_FLAG_CAPTURE) != 0; }
+	constexpr bool IsPromotion()const { return (GetFlags() & MOVE_FLAG_PROMOTION) != 0; }
+	constexpr bool IsEnPassant()const { return GetFlags() == MOVE_FLAG_EN_PASSANT; }
+	constexpr bool IsCastling()const { return GetFlags() == MOVE_FLAG_KING_CASTLE || GetFlags() == MOVE_FLAG_QUEEN_CASTLE; }
+	constexpr bool IsDoublePawnPush()const { return GetFlags() == MOVE_FLAG_DOUBLE_PAWN_PUSH; }
+	constexpr ChessPieceType GetPromotionType()const
+	{
+		return IsPromotion() ? PROMOTION_TYPES[GetFlags() & 3] : ChessPieceType::NONE;
+	}
+
+	constexpr bool operator==(ChessMove const& compare)const { return m_data == compare.m_data; }
+	constexpr bool operator!=(ChessMove const& compare)const { return m_data != compare.m_data; }
+
+	static constexpr int GetPromotionFlag(ChessPieceType promoteTo)
+	{
+		return MOVE_FLAG_PROMOTION | (promoteTo == ChessPieceType::KNIGHT ? 0 : promoteTo == ChessPieceType::BISHOP ? 1 : promoteTo == ChessPieceType::ROOK ? 2 : 3);
+	}
+
+public:
+	static constexpr ChessPieceType PROMOTION_TYPES[4] = { ChessPieceType::KNIGHT, ChessPieceType::BISHOP, ChessPieceType::ROOK, ChessPieceType::QUEEN };
+
+	unsigned short m_data = 0;
+};
+
+static_assert(sizeof(ChessMove) == 2, "ChessMove must stay 16 bits");
+static_assert(ChessMove(12, 28, MOVE_FLAG_DOUBLE_PAWN_PUSH).GetToSquare() == 28, "to square is packed in bits 6-11");
+static_assert(ChessMove(52, 60, ChessMove::GetPromotionFlag(ChessPieceType::ROOK)).GetPromotionType() == ChessPieceType::ROOK, "promotion type round trips");
+
+
+//fixed capacity move buffer, lives on the stack so generating moves never allocates
+struct ChessMoveList
+{
+public:
+	static constexpr int MAX_MOVES = 256;//the most legal moves known in any position is 218
+
+	void Clear() { m_numMoves = 0; }
+	void Add(ChessMove move) { m_moves[m_numMoves++] = move; }
+	int GetSize()const { return m_numMoves; }
+	bool IsEmpty()const { return m_numMoves == 0; }
+	ChessMove operator[](int index)const { return m_moves[index]; }
+	ChessMove* begin() { return m_moves; }
+	ChessMove* end() { return m_moves + m_numMoves; }
+	ChessMove const* begin()const { return m_moves; }
+	ChessMove const* end()const { return m_moves + m_numMoves; }
+
+	bool Contains(ChessMove move)const
+	{
+		for (int i = 0; i < m_numMoves; i++)
+		{
+			if (m_moves[i] == move)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//first move matching from and to (and the promotion type when promoting), null move if none
+	ChessMove FindMove(int fromSquare, int toSquare, ChessPieceType promoteTo = ChessPieceType::QUEEN)const
+	{
+		for (int i = 0; i < m_numMoves; i++)
+		{
+			ChessMove move = m_moves[i];
+			if (move.GetFromSquare() == fromSquare && move.GetToSquare() == toSquare
+				&& (!move.IsPromotion() || move.GetPromotionType() == promoteTo))
+			{
+				return move;
+			}
+		}
+		return ChessMove();
+	}
+
+public:
+	ChessMove m_moves[MAX_MOVES];
+	int m_numMoves = 0;
+};
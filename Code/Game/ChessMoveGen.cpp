@@ -0,0 +1,353 @@
+#include "Game/ChessMoveGen.hpp"
+#include "Game/ChessAttacks.hpp"
+
+
+static constexpr int PAWN_FORWARD_OFFSETS[NUM_CHESS_PLAYERS] = { 8, -8 };
+static constexpr int PAWN_START_RANKS[NUM_CHESS_PLAYERS] = { 1, 6 };
+static constexpr int PAWN_PROMOTION_RANKS[NUM_CHESS_PLAYERS] = { 7, 0 };
+
+
+static void AddPawnMove(ChessMoveList& moves, int fromSquare, int toSquare, int playerIndex, bool isCapture)
+{
+	int captureFlag = isCapture ? MOVE_FLAG_CAPTURE : 0;
+	if (GetRankForSquare(toSquare) == PAWN_PROMOTION_RANKS[playerIndex])
+	{
+		for (ChessPieceType promoteTo : ChessMove::PROMOTION_TYPES)
+		{
+			moves.Add(ChessMove(fromSquare, toSquare, ChessMove::GetPromotionFlag(promoteTo) | captureFlag));
+		}
+		return;
+	}
+	moves.Add(ChessMove(fromSquare, toSquare, captureFlag));
+}
+
+static void AddPawnMovesForSquare(ChessPosition const& position, ChessMoveList& moves, int fromSquare, ChessMoveGenType genType)
+{
+	int playerIndex = position.GetPlayerToMove();
+	int forward = PAWN_FORWARD_OFFSETS[playerIndex];
+
+	//pushes, a pawn on its last rank (only reachable by teleporting) has nowhere to go
+	int oneStepSquare = fromSquare + forward;
+	if (oneStepSquare >= 0 && oneStepSquare < NUM_BOARD_SQUARES && position.IsSquareEmpty(oneStepSquare))
+	{
+		bool isPromotion = GetRankForSquare(oneStepSquare) == PAWN_PROMOTION_RANKS[playerIndex];
+		if (isPromotion ? genType != ChessMoveGenType::QUIETS : genType != ChessMoveGenType::CAPTURES)
+		{
+			AddPawnMove(moves, fromSquare, oneStepSquare, playerIndex, false);
+		}
+		int twoStepSquare = oneStepSquare + forward;
+		if (genType != ChessMoveGenType::CAPTURES && GetRankForSquare(fromSquare) == PAWN_START_RANKS[playerIndex] && position.IsSquareEmpty(twoStepSquare))
+		{
+			moves.Add(ChessMove(fromSquare, twoStepSquare, MOVE_FLAG_DOUBLE_PAWN_PUSH));
+		}
+	}
+	if (genType == ChessMoveGenType::QUIETS)
+	{
+		return;
+	}
+
+	Bitboard attacks = GetPawnAttacks(playerIndex, fromSquare);
+	Bitboard captures = attacks & position.GetPiecesForPlayer(1 - playerIndex);
+	while (captures != EMPTY_BITBOARD)
+	{
+		AddPawnMove(moves, fromSquare, PopLowestSquare(captures), playerIndex, true);
+	}
+
+	//the skipped square is empty and the pawn that skipped it sits one step behind
+	int enPassantSquare = position.GetEnPassantSquare();
+	if (enPassantSquare != NO_SQUARE && IsSquareInBitboard(attacks, enPassantSquare)
+		&& IsSquareInBitboard(position.GetPieces(1 - playerIndex, ChessPieceType::PAWN), enPassantSquare - forward))
+	{
+		moves.Add(ChessMove(fromSquare, enPassantSquare, MOVE_FLAG_EN_PASSANT));
+	}
+}
+
+static void AddPawnMoves(ChessPosition const& position, ChessMoveList& moves, ChessMoveGenType genType)
+{
+	Bitboard pawns = position.GetPieces(position.GetPlayerToMove(), ChessPieceType::PAWN);
+	while (pawns != EMPTY_BITBOARD)
+	{
+		AddPawnMovesForSquare(position, moves, PopLowestSquare(pawns), genType);
+	}
+}
+
+//the squares a piece of the player to move may land on for this kind of move
+static Bitboard GetTargetsForGenType(ChessPosition const& position, ChessMoveGenType genType)
+{
+	int playerIndex = position.GetPlayerToMove();
+	switch (genType)
+	{
+	case ChessMoveGenType::CAPTURES:	return position.GetPiecesForPlayer(1 - playerIndex);
+	case ChessMoveGenType::QUIETS:		return ~position.GetOccupied();
+	default:							return ~position.GetPiecesForPlayer(playerIndex);
+	}
+}
+
+static void AddMovesForTargets(ChessPosition const& position, ChessMoveList& moves, int fromSquare, Bitboard targets)
+{
+	while (targets != EMPTY_BITBOARD)
+	{
+		int toSquare = PopLowestSquare(targets);
+		moves.Add(ChessMove(fromSquare, toSquare, position.IsSquareEmpty(toSquare) ? MOVE_FLAG_QUIET : MOVE_FLAG_CAPTURE));
+	}
+}
+
+template <ChessPieceType TYPE>
+static void AddMovesForPieceType(ChessPosition const& position, ChessMoveList& moves, Bitboard targets)
+{
+	int playerIndex = position.GetPlayerToMove();
+	Bitboard occupied = position.GetOccupied();
+
+	Bitboard pieces = position.GetPieces(playerIndex, TYPE);
+	while (pieces != EMPTY_BITBOARD)
+	{
+		int fromSquare = PopLowestSquare(pieces);
+		AddMovesForTargets(position, moves, fromSquare, GetAttacksForPieceType<TYPE>(playerIndex, fromSquare, occupied) & targets);
+	}
+}
+
+static void AddPieceMoves(ChessPosition const& position, ChessMoveList& moves, ChessMoveGenType genType)
+{
+	Bitboard targets = GetTargetsForGenType(position, genType);
+	AddMovesForPieceType<ChessPieceType::ROOK>(position, moves, targets);
+	AddMovesForPieceType<ChessPieceType::KNIGHT>(position, moves, targets);
+	AddMovesForPieceType<ChessPieceType::BISHOP>(position, moves, targets);
+	AddMovesForPieceType<ChessPieceType::QUEEN>(position, moves, targets);
+	AddMovesForPieceType<ChessPieceType::KING>(position, moves, targets);
+}
+
+//only checks rights and empty squares, attacked squares are left to the legal filter
+static void AddCastlingMoves(ChessPosition const& position, ChessMoveList& moves)
+{
+	int playerIndex = position.GetPlayerToMove();
+	int kingSquare = KING_START_SQUARES[playerIndex];
+	if (!IsSquareInBitboard(position.GetPieces(playerIndex, ChessPieceType::KING), kingSquare))
+	{
+		return;
+	}
+
+	Bitboard rooks = position.GetPieces(playerIndex, ChessPieceType::ROOK);
+	Bitboard occupied = position.GetOccupied();
+	int kingsideRookSquare = KINGSIDE_ROOK_START_SQUARES[playerIndex];
+	if (position.HasCastlingRight(GetKingsideCastlingRight(playerIndex)) && IsSquareInBitboard(rooks, kingsideRookSquare)
+		&& (GetSquaresBetween(kingSquare, kingsideRookSquare) & occupied) == EMPTY_BITBOARD)
+	{
+		moves.Add(ChessMove(kingSquare, kingSquare + 2, MOVE_FLAG_KING_CASTLE));
+	}
+	int queensideRookSquare = QUEENSIDE_ROOK_START_SQUARES[playerIndex];
+	if (position.HasCastlingRight(GetQueensideCastlingRight(playerIndex)) && IsSquareInBitboard(rooks, queensideRookSquare)
+		&& (GetSquaresBetween(kingSquare, queensideRookSquare) & occupied) == EMPTY_BITBOARD)
+	{
+		moves.Add(ChessMove(kingSquare, kingSquare - 2, MOVE_FLAG_QUEEN_CASTLE));
+	}
+}
+
+void GeneratePseudoLegalMoves(ChessPosition const& position, ChessMoveList& moves, ChessMoveGenType genType)
+{
+	AddPawnMoves(position, moves, genType);
+	AddPieceMoves(position, moves, genType);
+	if (genType != ChessMoveGenType::CAPTURES)
+	{
+		AddCastlingMoves(position, moves);
+	}
+}
+
+//every pseudo legal move of the piece on fromSquare, which must belong to the player to move
+static void AddPseudoLegalMovesForSquare(ChessPosition const& position, ChessMoveList& moves, int fromSquare)
+{
+	ChessPieceType type = position.GetPieceTypeAtSquare(fromSquare);
+	if (type == ChessPieceType::PAWN)
+	{
+		AddPawnMovesForSquare(position, moves, fromSquare, ChessMoveGenType::ALL);
+		return;
+	}
+	Bitboard targets = GetTargetsForGenType(position, ChessMoveGenType::ALL);
+	AddMovesForTargets(position, moves, fromSquare, GetAttacksForPiece(type, position.GetPlayerToMove(), fromSquare, position.GetOccupied()) & targets);
+	if (type == ChessPieceType::KING)
+	{
+		AddCastlingMoves(position, moves);
+	}
+}
+
+//what every non king move of the player to move has to respect
+struct ChessLegalityMasks
+{
+	int m_kingSquare = NO_SQUARE;
+	Bitboard m_checkers = EMPTY_BITBOARD;
+	Bitboard m_checkMask = ~EMPTY_BITBOARD;
+	Bitboard m_pinned = EMPTY_BITBOARD;
+};
+
+static void GetLegalityMasks(ChessPosition const& position, ChessLegalityMasks& masks)
+{
+	int playerIndex = position.GetPlayerToMove();
+	int kingSquare = position.GetKingSquare(playerIndex);
+	masks.m_kingSquare = kingSquare;
+	if (kingSquare == NO_SQUARE)
+	{
+		return;
+	}
+
+	int enemyIndex = 1 - playerIndex;
+	Bitboard occupied = position.GetOccupied();
+	Bitboard ownPieces = position.GetPiecesForPlayer(playerIndex);
+	Bitboard checkers = GetAttackersToSquare(position, kingSquare, occupied) & position.GetPiecesForPlayer(enemyIndex);
+	masks.m_checkers = checkers;
+
+	//non king moves must capture the checker or block its ray, with two checkers only the king can move
+	if (checkers != EMPTY_BITBOARD)
+	{
+		masks.m_checkMask = EMPTY_BITBOARD;
+		if (GetNumSetBits(checkers) == 1)
+		{
+			int checkerSquare = GetLowestSquare(checkers);
+			masks.m_checkMask = GetSquaresBetween(kingSquare, checkerSquare) | checkers;
+		}
+	}
+
+	//a piece is pinned if it is the only piece between the king and an enemy slider on the same line
+	Bitboard enemyQueens = position.GetPieces(enemyIndex, ChessPieceType::QUEEN);
+	Bitboard snipers = (GetRookAttacks(kingSquare, EMPTY_BITBOARD) & (position.GetPieces(enemyIndex, ChessPieceType::ROOK) | enemyQueens))
+		| (GetBishopAttacks(kingSquare, EMPTY_BITBOARD) & (position.GetPieces(enemyIndex, ChessPieceType::BISHOP) | enemyQueens));
+	while (snipers != EMPTY_BITBOARD)
+	{
+		Bitboard blockers = GetSquaresBetween(kingSquare, PopLowestSquare(snipers)) & occupied;
+		if (GetNumSetBits(blockers) == 1)
+		{
+			masks.m_pinned |= blockers & ownPieces;
+		}
+	}
+}
+
+static bool IsMoveLegalForMasks(ChessPosition const& position, ChessMove move, ChessLegalityMasks const& masks)
+{
+	int kingSquare = masks.m_kingSquare;
+	Bitboard checkers = masks.m_checkers;
+	Bitboard checkMask = masks.m_checkMask;
+	Bitboard pinned = masks.m_pinned;
+
+	int playerIndex = position.GetPlayerToMove();
+	int enemyIndex = 1 - playerIndex;
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	Bitboard occupied = position.GetOccupied();
+
+	if (fromSquare == kingSquare)
+	{
+		if (move.IsCastling())
+		{
+			if (checkers != EMPTY_BITBOARD)
+			{
+				return false;
+			}
+			//the king may not pass through or land on an attacked square
+			int step = toSquare > fromSquare ? 1 : -1;
+			for (int square = fromSquare + step; square != toSquare + step; square += step)
+			{
+				if (IsSquareAttackedByPlayer(position, square, enemyIndex))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		//look through the king so it cannot step back along the checking ray
+		Bitboard occupiedWithoutKing = occupied & ~GetBitboardForSquare(kingSquare);
+		return (GetAttackersToSquare(position, toSquare, occupiedWithoutKing) & position.GetPiecesForPlayer(enemyIndex)) == EMPTY_BITBOARD;
+	}
+
+	if (move.IsEnPassant())
+	{
+		//two pawns leave the same rank at once, so replay the capture on the occupancy
+		int capturedSquare = toSquare - PAWN_FORWARD_OFFSETS[playerIndex];
+		Bitboard capturedBB = GetBitboardForSquare(capturedSquare);
+		Bitboard occupiedAfter = (occupied & ~GetBitboardForSquare(fromSquare) & ~capturedBB) | GetBitboardForSquare(toSquare);
+		Bitboard enemiesAfter = position.GetPiecesForPlayer(enemyIndex) & ~capturedBB;
+		return (GetAttackersToSquare(position, kingSquare, occupiedAfter) & enemiesAfter) == EMPTY_BITBOARD;
+	}
+
+	if (!IsSquareInBitboard(checkMask, toSquare))
+	{
+		return false;
+	}
+	if (IsSquareInBitboard(pinned, fromSquare) && !IsSquareInBitboard(GetLineThrough(kingSquare, fromSquare), toSquare))
+	{
+		return false;
+	}
+	return true;
+}
+
+void GenerateLegalMoves(ChessPosition const& position, ChessMoveList& moves, ChessMoveGenType genType)
+{
+	ChessMoveList pseudoLegalMoves;
+	GeneratePseudoLegalMoves(position, pseudoLegalMoves, genType);
+
+	ChessLegalityMasks masks;
+	GetLegalityMasks(position, masks);
+	if (masks.m_kingSquare == NO_SQUARE)
+	{
+		//nothing to keep safe, every pseudo legal move is legal
+		for (ChessMove move : pseudoLegalMoves)
+		{
+			moves.Add(move);
+		}
+		return;
+	}
+
+	for (ChessMove move : pseudoLegalMoves)
+	{
+		if (IsMoveLegalForMasks(position, move, masks))
+		{
+			moves.Add(move);
+		}
+	}
+}
+
+bool IsMoveLegal(ChessPosition const& position, ChessMove move)
+{
+	//only the moving piece's moves are generated, so checking a remembered move stays cheap
+	int fromSquare = move.GetFromSquare();
+	if (move.IsNull() || position.GetPlayerIndexAtSquare(fromSquare) != position.GetPlayerToMove())
+	{
+		return false;
+	}
+	ChessMoveList pieceMoves;
+	AddPseudoLegalMovesForSquare(position, pieceMoves, fromSquare);
+	if (!pieceMoves.Contains(move))
+	{
+		return false;
+	}
+
+	ChessLegalityMasks masks;
+	GetLegalityMasks(position, masks);
+	return masks.m_kingSquare == NO_SQUARE || IsMoveLegalForMasks(position, move, masks);
+}
+
+Bitboard GetAttackersToSquare(ChessPosition const& position, int square, Bitboard occupied)
+{
+	Bitboard rooksAndQueens = position.GetPiecesForType(ChessPieceType::ROOK) | position.GetPiecesForType(ChessPieceType::QUEEN);
+	Bitboard bishopsAndQueens = position.GetPiecesForType(ChessPieceType::BISHOP) | position.GetPiecesForType(ChessPieceType::QUEEN);
+
+	//a player 1 pawn attacks square if a player 0 pawn on square would attack it, and the other way around
+	return (GetPawnAttacks(1, square) & position.GetPieces(0, ChessPieceType::PAWN))
+		| (GetPawnAttacks(0, square) & position.GetPieces(1, ChessPieceType::PAWN))
+		| (GetKnightAttacks(square) & position.GetPiecesForType(ChessPieceType::KNIGHT))
+		| (GetKingAttacks(square) & position.GetPiecesForType(ChessPieceType::KING))
+		| (GetRookAttacks(square, occupied) & rooksAndQueens)
+		| (GetBishopAttacks(square, occupied) & bishopsAndQueens);
+}
+
+bool IsSquareAttackedByPlayer(ChessPosition const& position, int square, int attackerPlayerIndex)
+{
+	return (GetAttackersToSquare(position, square, position.GetOccupied()) & position.GetPiecesForPlayer(attackerPlayerIndex)) != EMPTY_BITBOARD;
+}
+
+bool IsPlayerInCheck(ChessPosition const& position, int playerIndex)
+{
+	int kingSquare = position.GetKingSquare(playerIndex);
+	if (kingSquare == NO_SQUARE)
+	{
+		return false;
+	}
+	return IsSquareAttackedByPlayer(position, kingSquare, 1 - playerIndex);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "Game/ChessMove.hpp"
+#include "Game/ChessPosition.hpp"
+
+
+//move generation for the player to move, InitializeChessAttackTables() must have been called
+//moves are appended to the list, it is not cleared first
+
+//a search can generate the moves most likely to cut off first and the rest only when they did not
+enum class ChessMoveGenType
+{
+	ALL,
+	CAPTURES,//captures, en passant and every promotion
+	QUIETS//everything else, castling included
+};
+
+//moves that follow the piece rules but may leave the mover's own king attacked
+void GeneratePseudoLegalMoves(ChessPosition const& position, ChessMoveList& moves, ChessMoveGenType genType = ChessMoveGenType::ALL);
+//pseudo legal moves filtered with the pin and check masks, castling and en passant included
+void GenerateLegalMoves(ChessPosition const& position, ChessMoveList& moves, ChessMoveGenType genType = ChessMoveGenType::ALL);
+//true if the move appears in GenerateLegalMoves(), for moves remembered from another position (killers, table moves)
+bool IsMoveLegal(ChessPosition const& position, ChessMove move);
+
+//pieces of both players attacking square, occupied lets callers look through pieces that are about to move
+Bitboard GetAttackersToSquare(ChessPosition const& position, int square, Bitboard occupied);
+bool IsSquareAttackedByPlayer(ChessPosition const& position, int square, int attackerPlayerIndex);
+bool IsPlayerInCheck(ChessPosition const& position, int playerIndex);//false if the king is missing
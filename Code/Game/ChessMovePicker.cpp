@@ -0,0 +1,248 @@
+#include "Game/ChessMovePicker.hpp"
+#include "Game/ChessMoveGen.hpp"
+#include "Game/ChessEvaluation.hpp"
+
+#include <cstdlib>
+#include <utility>
+
+
+void ChessMoveHistory::Clear()
+{
+	*this = ChessMoveHistory();
+}
+
+int ChessMoveHistory::GetScore(int playerIndex, ChessMove move) const
+{
+	return m_scores[playerIndex][move.GetFromSquare()][move.GetToSquare()];
+}
+
+void ChessMoveHistory::Update(int playerIndex, ChessMove move, int bonus)
+{
+	//the closer a score gets to the limit, the less a bonus moves it, so old lessons fade instead of saturating
+	bonus = bonus < -MAX_HISTORY_SCORE ? -MAX_HISTORY_SCORE : (bonus > MAX_HISTORY_SCORE ? MAX_HISTORY_SCORE : bonus);
+	int& score = m_scores[playerIndex][move.GetFromSquare()][move.GetToSquare()];
+	score += bonus - score * abs(bonus) / MAX_HISTORY_SCORE;
+}
+
+ChessMove ChessMoveHistory::GetCounterMove(ChessPosition const& position) const
+{
+	ChessMove lastMove = position.GetLastMove();
+	if (lastMove.IsNull())
+	{
+		return ChessMove();
+	}
+	int lastSquare = lastMove.GetToSquare();
+	return m_counterMoves[1 - position.GetPlayerToMove()][(int)position.GetPieceTypeAtSquare(lastSquare)][lastSquare];
+}
+
+void ChessMoveHistory::SetCounterMove(ChessPosition const& position, ChessMove move)
+{
+	ChessMove lastMove = position.GetLastMove();
+	if (lastMove.IsNull())
+	{
+		return;
+	}
+	int lastSquare = lastMove.GetToSquare();
+	m_counterMoves[1 - position.GetPlayerToMove()][(int)position.GetPieceTypeAtSquare(lastSquare)][lastSquare] = move;
+}
+
+
+ChessMovePicker::ChessMovePicker(ChessPosition const& position, ChessMove tableMove, ChessMove const* killers, ChessMove counterMove, ChessMoveHistory const& history)
+	:m_position(position), m_history(history), m_tableMove(tableMove), m_counterMove(counterMove)
+{
+	if (killers != nullptr)
+	{
+		m_killers[0] = killers[0];
+		m_killers[1] = killers[1];
+	}
+}
+
+ChessMovePicker::ChessMovePicker(ChessPosition const& position, ChessMoveHistory const& history)
+	:m_position(position), m_history(history), m_stage(Stage::GENERATE_CAPTURES), m_isCapturesOnly(true)
+{
+}
+
+ChessMove ChessMovePicker::GetNextMove()
+{
+	while (true)
+	{
+		switch (m_stage)
+		{
+		case Stage::TABLE_MOVE:
+		{
+			m_stage = Stage::GENERATE_CAPTURES;
+			ChessMove move = PickSingleMove(m_tableMove);
+			if (!move.IsNull())
+			{
+				return move;
+			}
+			break;
+		}
+		case Stage::GENERATE_CAPTURES:
+			m_moves.Clear();
+			GenerateLegalMoves(m_position, m_moves, ChessMoveGenType::CAPTURES);
+			ScoreCaptures();
+			m_nextIndex = 0;
+			m_stage = Stage::CAPTURES;
+			break;
+		case Stage::CAPTURES:
+		{
+			ChessMove move = PickBestRemainingMove();
+			if (move.IsNull())
+			{
+				m_stage = m_isCapturesOnly ? Stage::DONE : Stage::FIRST_KILLER;
+			}
+			else if (IsCaptureLosing(move))
+			{
+				//every slot before m_nextIndex was handed out already
+				m_moves.m_moves[m_numBadCaptures++] = move;
+			}
+			else if (!IsAlreadyPicked(move))
+			{
+				return move;
+			}
+			break;
+		}
+		case Stage::FIRST_KILLER:
+		case Stage::SECOND_KILLER:
+		case Stage::COUNTER_MOVE:
+		{
+			ChessMove candidate = m_stage == Stage::FIRST_KILLER ? m_killers[0] : (m_stage == Stage::SECOND_KILLER ? m_killers[1] : m_counterMove);
+			m_stage = (Stage)((int)m_stage + 1);
+			//captures and promotions were all handed out already
+			if (candidate.IsCapture() || candidate.IsPromotion())
+			{
+				break;
+			}
+			ChessMove move = PickSingleMove(candidate);
+			if (!move.IsNull())
+			{
+				return move;
+			}
+			break;
+		}
+		case Stage::GENERATE_QUIETS:
+			m_moves.m_numMoves = m_numBadCaptures;
+			GenerateLegalMoves(m_position, m_moves, ChessMoveGenType::QUIETS);
+			m_nextIndex = m_numBadCaptures;
+			ScoreQuiets();
+			m_stage = Stage::QUIETS;
+			break;
+		case Stage::QUIETS:
+		{
+			ChessMove move = PickBestRemainingMove();
+			if (move.IsNull())
+			{
+				m_stage = Stage::BAD_CAPTURES;
+			}
+			else if (!IsAlreadyPicked(move))
+			{
+				return move;
+			}
+			break;
+		}
+		case Stage::BAD_CAPTURES:
+		{
+			//already in MVV-LVA order
+			if (m_nextBadCaptureIndex >= m_numBadCaptures)
+			{
+				m_stage = Stage::DONE;
+				break;
+			}
+			ChessMove move = m_moves[m_nextBadCaptureIndex++];
+			if (!IsAlreadyPicked(move))
+			{
+				return move;
+			}
+			break;
+		}
+		default:
+			return ChessMove();
+		}
+	}
+}
+
+void ChessMovePicker::ScoreCaptures()
+{
+	//most valuable victim first, least valuable attacker among equal victims; queen promotions rank like winning a queen,
+	//underpromotions go last
+	for (int i = 0; i < m_moves.GetSize(); i++)
+	{
+		ChessMove move = m_moves[i];
+		ChessPieceType victim = move.IsEnPassant() ? ChessPieceType::PAWN : m_position.GetPieceTypeAtSquare(move.GetToSquare());
+		ChessPieceType attacker = m_position.GetPieceTypeAtSquare(move.GetFromSquare());
+		int score = GetPieceValue(victim) * 8 - GetPieceValue(attacker);
+		if (move.IsPromotion())
+		{
+			int queenValue = GetPieceValue(ChessPieceType::QUEEN) * 8;
+			score += move.GetPromotionType() == ChessPieceType::QUEEN ? queenValue : -queenValue;
+		}
+		m_scores[i] = score;
+	}
+}
+
+void ChessMovePicker::ScoreQuiets()
+{
+	int playerIndex = m_position.GetPlayerToMove();
+	for (int i = m_nextIndex; i < m_moves.GetSize(); i++)
+	{
+		m_scores[i] = m_history.GetScore(playerIndex, m_moves[i]);
+	}
+}
+
+ChessMove ChessMovePicker::PickBestRemainingMove()
+{
+	int numMoves = m_moves.GetSize();
+	if (m_nextIndex >= numMoves)
+	{
+		return ChessMove();
+	}
+	int bestIndex = m_nextIndex;
+	for (int i = m_nextIndex + 1; i < numMoves; i++)
+	{
+		if (m_scores[i] > m_scores[bestIndex])
+		{
+			bestIndex = i;
+		}
+	}
+	std::swap(m_moves.m_moves[bestIndex], m_moves.m_moves[m_nextIndex]);
+	std::swap(m_scores[bestIndex], m_scores[m_nextIndex]);
+	return m_moves[m_nextIndex++];
+}
+
+ChessMove ChessMovePicker::PickSingleMove(ChessMove move)
+{
+	if (move.IsNull() || IsAlreadyPicked(move) || !IsMoveLegal(m_position, move))
+	{
+		return ChessMove();
+	}
+	m_pickedMoves[m_numPickedMoves++] = move;
+	return move;
+}
+
+bool ChessMovePicker::IsCaptureLosing(ChessMove move) const
+{
+	//taking something at least as valuable cannot lose material, and promotions are worth trying anyway
+	if (move.IsPromotion() || move.IsEnPassant())
+	{
+		return false;
+	}
+	int victimValue = GetPieceValue(m_position.GetPieceTypeAtSquare(move.GetToSquare()));
+	if (victimValue >= GetPieceValue(m_position.GetPieceTypeAtSquare(move.GetFromSquare())))
+	{
+		return false;
+	}
+	return GetStaticExchangeScore(m_position, move) < 0;
+}
+
+bool ChessMovePicker::IsAlreadyPicked(ChessMove move) const
+{
+	for (int i = 0; i < m_numPickedMoves; i++)
+	{
+		if (m_pickedMoves[i] == move)
+		{
+			return true;
+		}
+	}
+	return false;
+}
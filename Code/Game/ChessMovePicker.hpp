@@ -0,0 +1,81 @@
+#pragma once
+#include "Game/ChessMove.hpp"
+#include "Game/ChessPosition.hpp"
+
+
+//what the search has learned about quiet moves, one per search thread so nothing is shared or locked
+struct ChessMoveHistory
+{
+public:
+	void Clear();
+
+	int GetScore(int playerIndex, ChessMove move)const;
+	//bonus > 0 for a move that cut off, < 0 for the quiet moves tried before it; scores stay within +-MAX_HISTORY_SCORE
+	void Update(int playerIndex, ChessMove move, int bonus);
+
+	//the reply that last refuted the opponent's previous move (by moved piece and its square), null if none
+	ChessMove GetCounterMove(ChessPosition const& position)const;
+	void SetCounterMove(ChessPosition const& position, ChessMove move);
+
+public:
+	static constexpr int MAX_HISTORY_SCORE = 16384;
+
+private:
+	int m_scores[NUM_CHESS_PLAYERS][NUM_BOARD_SQUARES][NUM_BOARD_SQUARES] = {};//by from and to square
+	ChessMove m_counterMoves[NUM_CHESS_PLAYERS][NUM_CHESS_PIECE_TYPES][NUM_BOARD_SQUARES] = {};
+};
+
+
+//hands out the legal moves of a position best first, generating each group only when the earlier ones did not cut off:
+//the table move, captures and promotions that do not lose material by MVV-LVA, the two killers, the counter move,
+//quiets by history, then the captures the static exchange evaluation says lose material
+class ChessMovePicker
+{
+public:
+	//killers points to the two killer moves of this ply, tableMove, killers and counterMove may be null or illegal here
+	ChessMovePicker(ChessPosition const& position, ChessMove tableMove, ChessMove const* killers, ChessMove counterMove, ChessMoveHistory const& history);
+	//for the quiescence search: only captures and promotions that do not lose material
+	ChessMovePicker(ChessPosition const& position, ChessMoveHistory const& history);
+
+	ChessMove GetNextMove();//null once every legal move was handed out
+
+private:
+	enum class Stage
+	{
+		TABLE_MOVE,
+		GENERATE_CAPTURES,
+		CAPTURES,
+		FIRST_KILLER,
+		SECOND_KILLER,
+		COUNTER_MOVE,
+		GENERATE_QUIETS,
+		QUIETS,
+		BAD_CAPTURES,
+		DONE
+	};
+
+	void ScoreCaptures();
+	void ScoreQuiets();
+	ChessMove PickBestRemainingMove();//selection sort one step at a time, most nodes cut off after a few moves
+	ChessMove PickSingleMove(ChessMove move);//move if it is legal here and was not handed out yet, null otherwise
+	bool IsAlreadyPicked(ChessMove move)const;//handed out by one of the single move stages
+	bool IsCaptureLosing(ChessMove move)const;
+
+private:
+	ChessPosition const& m_position;
+	ChessMoveHistory const& m_history;
+	Stage m_stage = Stage::TABLE_MOVE;
+	bool m_isCapturesOnly = false;
+	ChessMove m_tableMove;
+	ChessMove m_killers[2];
+	ChessMove m_counterMove;
+	ChessMove m_pickedMoves[4];
+	int m_numPickedMoves = 0;
+
+	//losing captures are moved to the front of the list as they come up, the quiets are generated behind them
+	ChessMoveList m_moves;
+	int m_scores[ChessMoveList::MAX_MOVES];//only the first m_moves.GetSize() are set
+	int m_nextIndex = 0;
+	int m_numBadCaptures = 0;
+	int m_nextBadCaptureIndex = 0;
+};
@@ -0,0 +1,124 @@
+#include "Game/ChessMoveSequence.hpp"
+#include "Game/ChessMoveGen.hpp"
+
+
+static bool IsMoveSeparator(char c)
+{
+	return c == ' ' || c == ',' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static ChessPieceType GetPromotionTypeForLetter(char letter)
+{
+	ChessPieceType type = GetPieceTypeForGlyph(letter);
+	bool isPromotionType = type == ChessPieceType::KNIGHT || type == ChessPieceType::BISHOP
+		|| type == ChessPieceType::ROOK || type == ChessPieceType::QUEEN;
+	return isPromotionType ? type : ChessPieceType::NONE;
+}
+
+ChessMove GetLegalMoveForMoveText(ChessPosition const& position, const char* moveText, int textLength)
+{
+	if (textLength != 4 && textLength != 5)
+	{
+		return ChessMove();
+	}
+	char fromText[3] = { moveText[0], moveText[1], '\0' };
+	char toText[3] = { moveText[2], moveText[3], '\0' };
+	int fromSquare = GetSquareForSquareCoords(fromText);
+	int toSquare = GetSquareForSquareCoords(toText);
+	ChessPieceType promoteTo = textLength == 5 ? GetPromotionTypeForLetter(moveText[4]) : ChessPieceType::NONE;
+	if (fromSquare == NO_SQUARE || toSquare == NO_SQUARE || (textLength == 5 && promoteTo == ChessPieceType::NONE))
+	{
+		return ChessMove();
+	}
+
+	ChessMoveList legalMoves;
+	GenerateLegalMoves(position, legalMoves);
+	for (ChessMove move : legalMoves)
+	{
+		if (move.GetFromSquare() == fromSquare && move.GetToSquare() == toSquare && move.GetPromotionType() == promoteTo)
+		{
+			return move;
+		}
+	}
+	return ChessMove();
+}
+
+void WriteMoveText(ChessMove move, char* out)
+{
+	WriteSquareCoordsForSquare(move.GetFromSquare(), out);
+	WriteSquareCoordsForSquare(move.GetToSquare(), out + 2);
+	int length = 4;
+	if (move.IsPromotion())
+	{
+		out[length++] = GetGlyphForPiece(move.GetPromotionType(), 1);
+	}
+	out[length] = '\0';
+	out[0] = (char)(out[0] - 'A' + 'a');
+	out[2] = (char)(out[2] - 'A' + 'a');
+}
+
+int ApplyMoveSequence(ChessPosition& position, ChessMove const* moves, int numMoves)
+{
+	ChessMoveList legalMoves;
+	for (int i = 0; i < numMoves; i++)
+	{
+		legalMoves.Clear();
+		GenerateLegalMoves(position, legalMoves);
+		if (!legalMoves.Contains(moves[i]))
+		{
+			return i;
+		}
+		position.MakeMove(moves[i]);
+	}
+	return MOVE_SEQUENCE_ALL_APPLIED;
+}
+
+int ApplyMoveSequence(ChessPosition& position, const char* moveListText, int& numMovesApplied, bool stopAtGameEnd)
+{
+	numMovesApplied = 0;
+	const char* cursor = moveListText;
+	while (*cursor != '\0')
+	{
+		while (IsMoveSeparator(*cursor))
+		{
+			cursor++;
+		}
+		if (*cursor == '\0')
+		{
+			break;
+		}
+		const char* moveText = cursor;
+		while (*cursor != '\0' && !IsMoveSeparator(*cursor))
+		{
+			cursor++;
+		}
+
+		ChessMove move = GetLegalMoveForMoveText(position, moveText, (int)(cursor - moveText));
+		if (move.IsNull())
+		{
+			return numMovesApplied;
+		}
+		position.MakeMove(move);
+		numMovesApplied++;
+		if (stopAtGameEnd && IsGameOverPosition(position))
+		{
+			while (IsMoveSeparator(*cursor))
+			{
+				cursor++;
+			}
+			return *cursor == '\0' ? MOVE_SEQUENCE_ALL_APPLIED : numMovesApplied;
+		}
+	}
+	return MOVE_SEQUENCE_ALL_APPLIED;
+}
+
+bool IsGameOverPosition(ChessPosition const& position)
+{
+	if (position.IsThreefoldRepetition() || position.IsFiftyMoveRuleDraw())
+	{
+		return true;
+	}
+	ChessMoveList legalMoves;
+	GenerateLegalMoves(position, legalMoves);
+	return legalMoves.IsEmpty();
+}
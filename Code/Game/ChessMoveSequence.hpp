@@ -0,0 +1,26 @@
+#pragma once
+#include "Game/ChessMove.hpp"
+#include "Game/ChessPosition.hpp"
+
+
+//replaying whole move lists in one loop (archived games, resyncing a reconnecting client, recorded matches)
+//instead of one chessmove command per move; InitializeChessAttackTables() must have been called
+
+constexpr int MOVE_SEQUENCE_ALL_APPLIED = -1;
+constexpr int MAX_MOVE_TEXT_LENGTH = 6;//"e7e8q" and the terminator
+
+
+//coordinate notation "e2e4", promotions add the piece "e7e8q", either case;
+//the flags are taken from the legal move list, so the null move means malformed or illegal
+ChessMove GetLegalMoveForMoveText(ChessPosition const& position, const char* moveText, int textLength);
+//lower case and null terminated, out must hold MAX_MOVE_TEXT_LENGTH characters
+void WriteMoveText(ChessMove move, char* out);
+
+//each move is checked against the legal moves of the position it is played in, then made;
+//returns the index of the first illegal move, with position left right before it, or MOVE_SEQUENCE_ALL_APPLIED
+int ApplyMoveSequence(ChessPosition& position, ChessMove const* moves, int numMoves);
+//moves in coordinate notation separated by spaces or commas, numMovesApplied counts the moves that were made;
+//with stopAtGameEnd the list also ends after a move that ends the game, the move after it is returned as not applied
+int ApplyMoveSequence(ChessPosition& position, const char* moveListText, int& numMovesApplied, bool stopAtGameEnd = false);
+//the player to move has no legal move (mate or stalemate) or the position is drawn by repetition or the fifty move rule
+bool IsGameOverPosition(ChessPosition const& position);
@@ -0,0 +1,240 @@
+#include "Game/ChessNNUE.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+//compile time choice like the PEXT attacks, CHESS_NNUE_NO_SIMD forces the scalar kernels for comparing results
+#if defined(CHESS_NNUE_NO_SIMD)
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define CHESS_NNUE_USE_AVX2
+#elif defined(__SSE4_1__) || defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CHESS_NNUE_USE_SSE
+#endif
+
+
+//at most two pieces appear (moved piece, castling rook) and two disappear (moved piece, captured piece or castling rook)
+struct ChessNNUEFeatureChanges
+{
+	int m_added[2][3] = {};//player, piece type, square
+	int m_removed[2][3] = {};
+	int m_numAdded = 0;
+	int m_numRemoved = 0;
+};
+
+static int GetFeatureIndex(int perspective, int playerIndex, int type, int square)
+{
+	int relativeSquare = perspective == 0 ? square : square ^ 56;
+	return ((playerIndex == perspective ? 0 : 1) * NUM_CHESS_PIECE_TYPES + type) * NUM_BOARD_SQUARES + relativeSquare;
+}
+
+static void GetFeatureChangesForMove(ChessPosition const& position, ChessMove move, ChessNNUEFeatureChanges& changes)
+{
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	int playerIndex = position.GetPlayerIndexAtSquare(fromSquare);
+	int movingType = (int)position.GetPieceTypeAtSquare(fromSquare);
+	int landingType = move.IsPromotion() ? (int)move.GetPromotionType() : movingType;
+
+	auto addChange = [](int (*list)[3], int& count, int player, int type, int square)
+		{
+			list[count][0] = player;
+			list[count][1] = type;
+			list[count][2] = square;
+			count++;
+		};
+	addChange(changes.m_removed, changes.m_numRemoved, playerIndex, movingType, fromSquare);
+	addChange(changes.m_added, changes.m_numAdded, playerIndex, landingType, toSquare);
+
+	if (move.IsEnPassant())
+	{
+		int capturedSquare = GetSquareForFileAndRank(GetFileForSquare(toSquare), GetRankForSquare(fromSquare));
+		addChange(changes.m_removed, changes.m_numRemoved, 1 - playerIndex, (int)ChessPieceType::PAWN, capturedSquare);
+	}
+	else if (move.GetFlags() == MOVE_FLAG_KING_CASTLE)
+	{
+		addChange(changes.m_removed, changes.m_numRemoved, playerIndex, (int)ChessPieceType::ROOK, KINGSIDE_ROOK_START_SQUARES[playerIndex]);
+		addChange(changes.m_added, changes.m_numAdded, playerIndex, (int)ChessPieceType::ROOK, toSquare - 1);
+	}
+	else if (move.GetFlags() == MOVE_FLAG_QUEEN_CASTLE)
+	{
+		addChange(changes.m_removed, changes.m_numRemoved, playerIndex, (int)ChessPieceType::ROOK, QUEENSIDE_ROOK_START_SQUARES[playerIndex]);
+		addChange(changes.m_added, changes.m_numAdded, playerIndex, (int)ChessPieceType::ROOK, toSquare + 1);
+	}
+	else if (!position.IsSquareEmpty(toSquare))
+	{
+		addChange(changes.m_removed, changes.m_numRemoved, 1 - playerIndex, (int)position.GetPieceTypeAtSquare(toSquare), toSquare);
+	}
+}
+
+
+//out = in + every added row - every removed row, out may be in
+static void AddAndSubtractRows(int16_t const* in, int16_t* out, int16_t const* const* addedRows, int numAdded, int16_t const* const* removedRows, int numRemoved)
+{
+#if defined(CHESS_NNUE_USE_AVX2)
+	for (int i = 0; i < NNUE_HIDDEN_SIZE; i += 16)
+	{
+		__m256i values = _mm256_load_si256(reinterpret_cast<__m256i const*>(in + i));
+		for (int row = 0; row < numAdded; row++)
+		{
+			values = _mm256_add_epi16(values, _mm256_load_si256(reinterpret_cast<__m256i const*>(addedRows[row] + i)));
+		}
+		for (int row = 0; row < numRemoved; row++)
+		{
+			values = _mm256_sub_epi16(values, _mm256_load_si256(reinterpret_cast<__m256i const*>(removedRows[row] + i)));
+		}
+		_mm256_store_si256(reinterpret_cast<__m256i*>(out + i), values);
+	}
+#elif defined(CHESS_NNUE_USE_SSE)
+	for (int i = 0; i < NNUE_HIDDEN_SIZE; i += 8)
+	{
+		__m128i values = _mm_load_si128(reinterpret_cast<__m128i const*>(in + i));
+		for (int row = 0; row < numAdded; row++)
+		{
+			values = _mm_add_epi16(values, _mm_load_si128(reinterpret_cast<__m128i const*>(addedRows[row] + i)));
+		}
+		for (int row = 0; row < numRemoved; row++)
+		{
+			values = _mm_sub_epi16(values, _mm_load_si128(reinterpret_cast<__m128i const*>(removedRows[row] + i)));
+		}
+		_mm_store_si128(reinterpret_cast<__m128i*>(out + i), values);
+	}
+#else
+	for (int i = 0; i < NNUE_HIDDEN_SIZE; i++)
+	{
+		int value = in[i];
+		for (int row = 0; row < numAdded; row++)
+		{
+			value += addedRows[row][i];
+		}
+		for (int row = 0; row < numRemoved; row++)
+		{
+			value -= removedRows[row][i];
+		}
+		out[i] = (int16_t)value;
+	}
+#endif
+}
+
+//sum of clamp(values, 0, NNUE_ACTIVATION_SCALE) * weights
+static int32_t GetClippedDotProduct(int16_t const* values, int16_t const* weights)
+{
+#if defined(CHESS_NNUE_USE_AVX2)
+	__m256i zero = _mm256_setzero_si256();
+	__m256i maxActivation = _mm256_set1_epi16(NNUE_ACTIVATION_SCALE);
+	__m256i total = _mm256_setzero_si256();
+	for (int i = 0; i < NNUE_HIDDEN_SIZE; i += 16)
+	{
+		__m256i activations = _mm256_load_si256(reinterpret_cast<__m256i const*>(values + i));
+		activations = _mm256_min_epi16(_mm256_max_epi16(activations, zero), maxActivation);
+		total = _mm256_add_epi32(total, _mm256_madd_epi16(activations, _mm256_load_si256(reinterpret_cast<__m256i const*>(weights + i))));
+	}
+	__m128i sum = _mm_add_epi32(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+#elif defined(CHESS_NNUE_USE_SSE)
+	__m128i zero = _mm_setzero_si128();
+	__m128i maxActivation = _mm_set1_epi16(NNUE_ACTIVATION_SCALE);
+	__m128i total = _mm_setzero_si128();
+	for (int i = 0; i < NNUE_HIDDEN_SIZE; i += 8)
+	{
+		__m128i activations = _mm_load_si128(reinterpret_cast<__m128i const*>(values + i));
+		activations = _mm_min_epi16(_mm_max_epi16(activations, zero), maxActivation);
+		total = _mm_add_epi32(total, _mm_madd_epi16(activations, _mm_load_si128(reinterpret_cast<__m128i const*>(weights + i))));
+	}
+	total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(1, 0, 3, 2)));
+	total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(total);
+#else
+	int32_t total = 0;
+	for (int i = 0; i < NNUE_HIDDEN_SIZE; i++)
+	{
+		int activation = values[i] < 0 ? 0 : (values[i] > NNUE_ACTIVATION_SCALE ? NNUE_ACTIVATION_SCALE : values[i]);
+		total += activation * weights[i];
+	}
+	return total;
+#endif
+}
+
+
+bool ChessNNUENetwork::LoadFromFile(const char* filePath)
+{
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	fopen_s(&file, filePath, "rb");
+#else
+	file = fopen(filePath, "rb");
+#endif
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	char magic[4] = {};
+	uint32_t hiddenSize = 0;
+	bool isLoaded = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, "CNN1", sizeof(magic)) == 0
+		&& fread(&hiddenSize, sizeof(hiddenSize), 1, file) == 1 && hiddenSize == (uint32_t)NNUE_HIDDEN_SIZE
+		&& fread(m_featureWeights, sizeof(m_featureWeights), 1, file) == 1
+		&& fread(m_featureBiases, sizeof(m_featureBiases), 1, file) == 1
+		&& fread(m_outputWeights, sizeof(m_outputWeights), 1, file) == 1
+		&& fread(&m_outputBias, sizeof(m_outputBias), 1, file) == 1;
+	fclose(file);
+	return isLoaded;
+}
+
+void ChessNNUENetwork::RefreshAccumulator(ChessPosition const& position, ChessNNUEAccumulator& out) const
+{
+	for (int perspective = 0; perspective < NUM_CHESS_PLAYERS; perspective++)
+	{
+		int16_t* values = out.m_values[perspective];
+		memcpy(values, m_featureBiases, sizeof(m_featureBiases));
+		Bitboard occupied = position.GetOccupied();
+		while (occupied != EMPTY_BITBOARD)
+		{
+			int square = PopLowestSquare(occupied);
+			int16_t const* row = m_featureWeights[GetFeatureIndex(perspective, position.GetPlayerIndexAtSquare(square), (int)position.GetPieceTypeAtSquare(square), square)];
+			AddAndSubtractRows(values, values, &row, 1, nullptr, 0);
+		}
+	}
+}
+
+void ChessNNUENetwork::UpdateAccumulator(ChessNNUEAccumulator const& parent, ChessNNUEAccumulator& child, ChessPosition const& position, ChessMove move) const
+{
+	ChessNNUEFeatureChanges changes;
+	GetFeatureChangesForMove(position, move, changes);
+	for (int perspective = 0; perspective < NUM_CHESS_PLAYERS; perspective++)
+	{
+		int16_t const* addedRows[2] = {};
+		int16_t const* removedRows[2] = {};
+		for (int i = 0; i < changes.m_numAdded; i++)
+		{
+			addedRows[i] = m_featureWeights[GetFeatureIndex(perspective, changes.m_added[i][0], changes.m_added[i][1], changes.m_added[i][2])];
+		}
+		for (int i = 0; i < changes.m_numRemoved; i++)
+		{
+			removedRows[i] = m_featureWeights[GetFeatureIndex(perspective, changes.m_removed[i][0], changes.m_removed[i][1], changes.m_removed[i][2])];
+		}
+		AddAndSubtractRows(parent.m_values[perspective], child.m_values[perspective], addedRows, changes.m_numAdded, removedRows, changes.m_numRemoved);
+	}
+}
+
+int ChessNNUENetwork::Evaluate(ChessNNUEAccumulator const& accumulator, int playerToMove) const
+{
+	int64_t output = m_outputBias;
+	output += GetClippedDotProduct(accumulator.m_values[playerToMove], m_outputWeights);
+	output += GetClippedDotProduct(accumulator.m_values[1 - playerToMove], m_outputWeights + NNUE_HIDDEN_SIZE);
+	return (int)(output * NNUE_OUTPUT_SCALE / (NNUE_ACTIVATION_SCALE * NNUE_WEIGHT_SCALE));
+}
+
+const char* ChessNNUENetwork::GetInstructionSetName()
+{
+#if defined(CHESS_NNUE_USE_AVX2)
+	return "AVX2";
+#elif defined(CHESS_NNUE_USE_SSE)
+	return "SSE";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Game/ChessPosition.hpp"
+
+#include <cstdint>
+
+
+//optional neural evaluation (NNUE): 768 piece-square inputs -> 2 x 256 clipped ReLU -> 1 output, int16 weights.
+//the first layer is an accumulator per player, the sum of the weights of every piece seen from that player's side;
+//a move only changes two to four inputs, so the search updates the accumulator instead of recomputing it.
+//
+//weight file, little endian:
+//	char		magic[4] = "CNN1"
+//	uint32_t	hiddenSize = NNUE_HIDDEN_SIZE
+//	int16_t		featureWeights[NNUE_NUM_FEATURES][NNUE_HIDDEN_SIZE]	feature = (isTheirs * 6 + pieceType) * 64 + square,
+//																	squares flipped vertically for player 1, piece types in ChessPieceType order
+//	int16_t		featureBiases[NNUE_HIDDEN_SIZE]
+//	int16_t		outputWeights[2 * NNUE_HIDDEN_SIZE]					player to move first
+//	int32_t		outputBias
+//activations are clipped to [0, NNUE_ACTIVATION_SCALE], the output is scaled by NNUE_OUTPUT_SCALE / (NNUE_ACTIVATION_SCALE * NNUE_WEIGHT_SCALE)
+
+constexpr int NNUE_NUM_FEATURES = NUM_CHESS_PLAYERS * NUM_CHESS_PIECE_TYPES * NUM_BOARD_SQUARES;
+constexpr int NNUE_HIDDEN_SIZE = 256;
+constexpr int NNUE_ACTIVATION_SCALE = 255;
+constexpr int NNUE_WEIGHT_SCALE = 64;
+constexpr int NNUE_OUTPUT_SCALE = 400;
+
+
+struct alignas(32) ChessNNUEAccumulator
+{
+	int16_t m_values[NUM_CHESS_PLAYERS][NNUE_HIDDEN_SIZE];//indexed by perspective
+};
+
+
+class ChessNNUENetwork
+{
+public:
+	bool LoadFromFile(const char* filePath);//false if missing, truncated or built for another hidden size
+
+	void RefreshAccumulator(ChessPosition const& position, ChessNNUEAccumulator& out)const;
+	//child = parent plus the move, position is the one before the move is made
+	void UpdateAccumulator(ChessNNUEAccumulator const& parent, ChessNNUEAccumulator& child, ChessPosition const& position, ChessMove move)const;
+	int Evaluate(ChessNNUEAccumulator const& accumulator, int playerToMove)const;//centipawns for the player to move
+
+	static const char* GetInstructionSetName();//the kernels this build was compiled with
+
+private:
+	alignas(32) int16_t m_featureWeights[NNUE_NUM_FEATURES][NNUE_HIDDEN_SIZE] = {};
+	alignas(32) int16_t m_featureBiases[NNUE_HIDDEN_SIZE] = {};
+	alignas(32) int16_t m_outputWeights[NUM_CHESS_PLAYERS * NNUE_HIDDEN_SIZE] = {};
+	int32_t m_outputBias = 0;
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include "Game/ChessMove.hpp"
+#include "Game/ChessPosition.hpp"
+#include "Game/ChessMappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+//opening book in the Polyglot .bin layout: 16 byte big endian entries sorted by key,
+//	uint64_t	key			GetPolyglotKey() of the position
+//	uint16_t	move		bits 0-5 to square, 6-11 from square, 12-14 promotion (0 none, 1 knight, 2 bishop, 3 rook, 4 queen),
+//							castling is written as the king taking its own rook (e1h1, e1a1)
+//	uint16_t	weight		relative chance of playing the move
+//	uint32_t	learn		unused
+//the key is Polyglot's own Random64 hash, so books written by other programs probe the same as WriteFile() (chess_perft makebook=) ones
+
+struct ChessBookMove
+{
+	ChessMove m_move;
+	int m_weight = 0;
+};
+
+struct ChessBookEntry
+{
+	uint64_t m_key = 0;
+	uint16_t m_move = 0;
+	uint16_t m_weight = 0;
+};
+
+
+//the file is memory mapped and searched in place, opening it reads nothing and the OS pages in what probes touch
+class ChessOpeningBook
+{
+public:
+	ChessOpeningBook();
+	~ChessOpeningBook();
+	ChessOpeningBook(ChessOpeningBook const& copyFrom) = delete;
+	ChessOpeningBook& operator=(ChessOpeningBook const& copyFrom) = delete;
+
+	bool Open(const char* filePath);//false (and closed) if missing or not a whole number of entries
+	void Close();
+	bool IsOpen()const;
+	size_t GetNumEntries()const;
+
+	//legal book moves for the position with a weight above 0, entries whose move is not legal here are skipped;
+	//returns how many were written to out, at most maxMoves
+	int GetBookMoves(ChessPosition const& position, ChessBookMove* out, int maxMoves)const;
+
+	static uint64_t GetPolyglotKey(ChessPosition const& position);//not GetHash(), Polyglot has its own random keys
+	static uint16_t GetMoveCode(ChessPosition const& position, ChessMove move);
+	//sorts the entries by key, merges duplicates by adding their weights (scaled down to fit 16 bits per key)
+	static bool WriteFile(const char* filePath, std::vector<ChessBookEntry> entries);
+
+public:
+	static constexpr int ENTRY_SIZE = 16;
+	static constexpr int MAX_MOVES_PER_POSITION = 64;
+
+private:
+	ChessMappedFile m_file;
+	unsigned char const* m_data = nullptr;
+	size_t m_numEntries = 0;
+};
@@ -2,6 +2,7 @@
 #include "Game/ChessMatch.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/Game.hpp"
+#include "Game/ChessPieceRules.hpp"
 
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Renderer/Renderer.hpp"
@@ -86,81 +87,13 @@ bool ChessPiece::IsValidMoveForCoords(IntVec2 nextCoords) const
 {
 	//assumes the nextcoords is valid coords
 	//coords are not equal, and no piece is on the way
-
-	ChessPieceType type = m_pieceDef->m_type;
-	int absDistX = abs(nextCoords.x - m_currentCoords.x);
-	int absDistY = abs(nextCoords.y - m_currentCoords.y);
-	int taxicabDist = absDistX + absDistY;
-
-	bool firstMove = m_turnLastMoved == 0;
-
-	bool movesDiagonally = absDistX == absDistY;
-	bool movesStraight = (nextCoords.x == m_currentCoords.x) || (nextCoords.y == m_currentCoords.y);
-	bool diagonallyNear = (taxicabDist == 2) && movesDiagonally;
-	
-	int forwardSign = m_player1Side ? -1 : 1;
-	int movesYDirection = (nextCoords.y - m_currentCoords.y) * forwardSign;
-	bool movesForward = movesYDirection > 0;
-
-	if (type == ChessPieceType::PAWN)
-	{//moves forward 2 north, 1 north, or 1 diagonally
-		if (!movesForward)
-		{
-			return false;
-		}
-		bool verticalValid = movesStraight && ((firstMove && absDistY == 2) || absDistY == 1);
-
-		/*
-		bool enPassant = false;
-		const ChessPiece* capturingPiece = m_currentMatch->GetPieceAtCoords(nextCoords);
-		bool hasPieceAtDestination = capturingPiece != nullptr;
-		bool pieceAtDestinationIsEnemyPiece = hasPieceAtDestination && capturingPiece->m_player1Side != m_player1Side;
-		
-		if (!hasPieceAtDestination && movesDiagonally)
-		{
-			capturingPiece = m_currentMatch->GetPieceAtCoords(IntVec2(nextCoords.x, m_currentCoords.y));
-			if (capturingPiece !=nullptr && capturingPiece->m_pieceDef->m_type == ChessPieceType::PAWN)
-			{
-				int absDistYOp = abs(capturingPiece->m_currentCoords.y - capturingPiece->m_prevCoords.y);
-				bool isAdjacentToMeHoriztonally = m_currentCoords.y == capturingPiece->m_currentCoords.y && abs(m_currentCoords.x - capturingPiece->m_currentCoords.x) == 1;
-				if (isAdjacentToMeHoriztonally && capturingPiece->m_turnLastMoved == m_currentMatch->GetTurnNum() - 1 && absDistYOp == 2)
-				{
-					enPassant = true;
-				}
-			}
-		}
-
-		return verticalValid || (diagonallyNear && (pieceAtDestinationIsEnemyPiece || enPassant));*/
-		return verticalValid || diagonallyNear;
-
-
-	}
-	else if (type == ChessPieceType::KING)
-	{//moves to nearby 8 tiles
-		bool NSWE = taxicabDist == 1;
-		bool castling = firstMove && absDistX == 2 && absDistY == 0;
-
-		return NSWE || diagonallyNear || castling;
-	}
-	else if (type == ChessPieceType::ROOK)
-	{//moves horizontally or vertically
-		return movesStraight;
-	}
-	else if (type == ChessPieceType::BISHOP)
-	{//moves diagonally
-		return movesDiagonally;
-	}
-	else if (type == ChessPieceType::KNIGHT)
-	{//moves L shape
-		return (absDistX == 1 && absDistY == 2) || (absDistX == 2 && absDistY == 1);
-	}
-	else if (type == ChessPieceType::QUEEN)
-	{//moves L shape
-		return movesDiagonally || movesStraight;
-	}
-	
-
-	ERROR_AND_DIE("piece type not fitting any of the definitions");
-	//return false;
+	//the per type shape rules are one compile time table lookup, see ChessPieceRules.hpp
+	//the first move steps only exist from the start squares, castling rights and the en passant square live in the position
+	int playerIndex = (int)m_player1Side;
+	int square = GetSquareForFileAndRank(m_currentCoords.x, m_currentCoords.y);
+	bool firstMove = m_pieceDef->m_type == ChessPieceType::KING ? square == KING_START_SQUARES[playerIndex]
+		: GetRankForSquare(square) == (playerIndex == 0 ? 1 : 6);
+	return IsMoveShapeValidForPiece(m_pieceDef->m_type, playerIndex,
+		nextCoords.x - m_currentCoords.x, nextCoords.y - m_currentCoords.y, firstMove);
 }
 
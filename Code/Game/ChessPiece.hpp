@@ -34,5 +34,6 @@ public:
 	SoundID m_moveSFXID = MISSING_SOUND_ID;
 
 	bool m_player1Side = false; //0 = player 0, 1 = player 1
+	bool m_isCaptured = false; //captured pieces keep their slot so piece indices and pointers stay valid
 };
 
@@ -1,4 +1,5 @@
 #pragma once
+#include "Game/ChessCommon.hpp"
 
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Core/Vertex_PCUTBN.hpp"
@@ -10,17 +11,6 @@
 class VertexBuffer;
 class IndexBuffer;
 
-enum class ChessPieceType {
-	NONE = -1,
-	PAWN,
-	ROOK,
-	KNIGHT,
-	BISHOP,
-	QUEEN,
-	KING,
-	COUNT
-};
-
 
 class ChessPieceDefinition
 {
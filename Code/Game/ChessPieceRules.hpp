@@ -0,0 +1,82 @@
+#pragma once
+#include "Game/ChessCommon.hpp"
+#include "Game/ChessAttacks.hpp"
+
+
+//the shape rules of every piece type folded into one compile time table:
+//for each player and (deltaX, deltaY) the entry holds one bit per piece type that may make that step,
+//the bits shifted by FIRST_MOVE_SHIFT are only allowed while the piece has not moved yet
+//(pawn double step, king castling step); blockers and checks are not part of the shape
+constexpr int MOVE_SHAPE_DELTA_RANGE = 15;//deltas -7..7
+constexpr int MOVE_SHAPE_FIRST_MOVE_SHIFT = 8;
+
+constexpr unsigned short GetPieceTypeBit(ChessPieceType type)
+{
+	return type == ChessPieceType::NONE ? 0 : (unsigned short)(1 << (int)type);
+}
+
+struct ChessMoveShapeTable
+{
+	unsigned short m_typeBits[NUM_CHESS_PLAYERS][MOVE_SHAPE_DELTA_RANGE][MOVE_SHAPE_DELTA_RANGE] = {};
+
+	constexpr void Add(int playerIndex, int deltaX, int deltaY, unsigned short typeBits)
+	{
+		m_typeBits[playerIndex][deltaY + 7][deltaX + 7] |= typeBits;
+	}
+};
+
+constexpr ChessMoveShapeTable MakeMoveShapeTable()
+{
+	ChessMoveShapeTable table;
+	constexpr unsigned short straightSliders = GetPieceTypeBit(ChessPieceType::ROOK) | GetPieceTypeBit(ChessPieceType::QUEEN);
+	constexpr unsigned short diagonalSliders = GetPieceTypeBit(ChessPieceType::BISHOP) | GetPieceTypeBit(ChessPieceType::QUEEN);
+	constexpr unsigned short pawn = GetPieceTypeBit(ChessPieceType::PAWN);
+	constexpr unsigned short king = GetPieceTypeBit(ChessPieceType::KING);
+
+	for (int player = 0; player < NUM_CHESS_PLAYERS; player++)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			for (int distance = 1; distance < 8; distance++)
+			{
+				table.Add(player, ROOK_DIRECTIONS[i][0] * distance, ROOK_DIRECTIONS[i][1] * distance, straightSliders);
+				table.Add(player, BISHOP_DIRECTIONS[i][0] * distance, BISHOP_DIRECTIONS[i][1] * distance, diagonalSliders);
+			}
+		}
+		for (int i = 0; i < 8; i++)
+		{
+			table.Add(player, KNIGHT_OFFSETS[i][0], KNIGHT_OFFSETS[i][1], GetPieceTypeBit(ChessPieceType::KNIGHT));
+			table.Add(player, KING_OFFSETS[i][0], KING_OFFSETS[i][1], king);
+		}
+		table.Add(player, 2, 0, king << MOVE_SHAPE_FIRST_MOVE_SHIFT);
+		table.Add(player, -2, 0, king << MOVE_SHAPE_FIRST_MOVE_SHIFT);
+
+		int forward = player == 0 ? 1 : -1;
+		table.Add(player, 0, forward, pawn);
+		table.Add(player, 0, 2 * forward, pawn << MOVE_SHAPE_FIRST_MOVE_SHIFT);
+		table.Add(player, PAWN_ATTACK_OFFSETS[player][0][0], PAWN_ATTACK_OFFSETS[player][0][1], pawn);
+		table.Add(player, PAWN_ATTACK_OFFSETS[player][1][0], PAWN_ATTACK_OFFSETS[player][1][1], pawn);
+	}
+	return table;
+}
+
+inline constexpr ChessMoveShapeTable MOVE_SHAPE_TABLE = MakeMoveShapeTable();
+
+//deltas are toCoords - fromCoords and must be in -7..7
+constexpr bool IsMoveShapeValidForPiece(ChessPieceType type, int playerIndex, int deltaX, int deltaY, bool isFirstMove)
+{
+	unsigned short typeBits = MOVE_SHAPE_TABLE.m_typeBits[playerIndex][deltaY + 7][deltaX + 7];
+	unsigned short allowedBits = isFirstMove ? (unsigned short)(typeBits | (typeBits >> MOVE_SHAPE_FIRST_MOVE_SHIFT)) : typeBits;
+	return (allowedBits & GetPieceTypeBit(type)) != 0;
+}
+
+static_assert(NUM_CHESS_PIECE_TYPES <= MOVE_SHAPE_FIRST_MOVE_SHIFT, "first move bits must not overlap the type bits");
+static_assert(IsMoveShapeValidForPiece(ChessPieceType::KNIGHT, 0, 1, 2, false) && !IsMoveShapeValidForPiece(ChessPieceType::KNIGHT, 0, 2, 2, false), "knight moves in an L");
+static_assert(IsMoveShapeValidForPiece(ChessPieceType::ROOK, 1, 0, -7, false) && !IsMoveShapeValidForPiece(ChessPieceType::ROOK, 0, 1, 1, false), "rook moves straight");
+static_assert(IsMoveShapeValidForPiece(ChessPieceType::BISHOP, 0, -3, 3, false) && !IsMoveShapeValidForPiece(ChessPieceType::BISHOP, 0, 0, 1, false), "bishop moves diagonally");
+static_assert(IsMoveShapeValidForPiece(ChessPieceType::QUEEN, 0, 5, 0, false) && IsMoveShapeValidForPiece(ChessPieceType::QUEEN, 0, 5, -5, false), "queen moves like rook and bishop");
+static_assert(IsMoveShapeValidForPiece(ChessPieceType::KING, 0, 2, 0, true) && !IsMoveShapeValidForPiece(ChessPieceType::KING, 0, 2, 0, false), "king steps two only to castle");
+static_assert(IsMoveShapeValidForPiece(ChessPieceType::PAWN, 0, 0, 2, true) && !IsMoveShapeValidForPiece(ChessPieceType::PAWN, 0, 0, 2, false), "pawn double step only on its first move");
+static_assert(IsMoveShapeValidForPiece(ChessPieceType::PAWN, 1, 1, -1, false) && !IsMoveShapeValidForPiece(ChessPieceType::PAWN, 1, 1, 1, false), "pawns only move forward");
+static_assert(!IsMoveShapeValidForPiece(ChessPieceType::NONE, 0, 0, 1, true), "an empty square has no moves");
+static_assert(MOVE_SHAPE_TABLE.m_typeBits[0][7][7] == 0, "staying on the same square is never a move");
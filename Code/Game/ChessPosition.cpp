@@ -0,0 +1,799 @@
+#include "Game/ChessPosition.hpp"
+#include "Game/ChessAttacks.hpp"
+#include "Game/ChessZobrist.hpp"
+#include "Game/ChessPieceSquareTables.hpp"
+
+#include <cstdio>
+
+
+//castling rights that survive a move touching this square
+static constexpr int GetCastlingRightsKeptForSquare(int square)
+{
+	int kept = CASTLING_ALL;
+	for (int player = 0; player < NUM_CHESS_PLAYERS; player++)
+	{
+		if (square == KING_START_SQUARES[player])
+		{
+			kept &= ~(GetKingsideCastlingRight(player) | GetQueensideCastlingRight(player));
+		}
+		if (square == KINGSIDE_ROOK_START_SQUARES[player])
+		{
+			kept &= ~GetKingsideCastlingRight(player);
+		}
+		if (square == QUEENSIDE_ROOK_START_SQUARES[player])
+		{
+			kept &= ~GetQueensideCastlingRight(player);
+		}
+	}
+	return kept;
+}
+
+struct ChessCastlingRightsTable
+{
+	int m_kept[NUM_BOARD_SQUARES] = {};
+};
+
+static constexpr ChessCastlingRightsTable MakeCastlingRightsTable()
+{
+	ChessCastlingRightsTable table;
+	for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+	{
+		table.m_kept[square] = GetCastlingRightsKeptForSquare(square);
+	}
+	return table;
+}
+
+static constexpr ChessCastlingRightsTable CASTLING_RIGHTS_TABLE = MakeCastlingRightsTable();
+static_assert(CASTLING_RIGHTS_TABLE.m_kept[4] == (CASTLING_PLAYER1_KINGSIDE | CASTLING_PLAYER1_QUEENSIDE), "moving the e1 king drops both player 0 rights");
+static_assert(CASTLING_RIGHTS_TABLE.m_kept[63] == (CASTLING_ALL & ~CASTLING_PLAYER1_KINGSIDE), "touching h8 drops player 1 kingside");
+
+
+ChessPosition::ChessPosition()
+{
+	Clear();
+}
+
+ChessPosition::~ChessPosition()
+{
+}
+
+void ChessPosition::Clear()
+{
+	for (int player = 0; player < NUM_CHESS_PLAYERS; player++)
+	{
+		for (int type = 0; type < NUM_CHESS_PIECE_TYPES; type++)
+		{
+			m_piecesByType[player][type] = EMPTY_BITBOARD;
+		}
+		m_piecesByPlayer[player] = EMPTY_BITBOARD;
+	}
+	m_occupied = EMPTY_BITBOARD;
+	for (int i = 0; i < NUM_BOARD_SQUARES; i++)
+	{
+		m_mailbox[i] = EMPTY_PIECE_CODE;
+	}
+	m_playerToMove = 0;
+	m_castlingRights = CASTLING_NONE;
+	m_enPassantSquare = NO_SQUARE;
+	m_halfmoveClock = 0;
+	m_fullmoveNumber = 1;
+	m_hash = 0;
+	m_midgameScore = 0;
+	m_endgameScore = 0;
+	m_gamePhase = 0;
+	ClearUndoStack();
+}
+
+bool ChessPosition::SetFromBoardState(const char* layout, int playerToMove)
+{
+	Clear();
+	for (int i = 0; i < NUM_BOARD_SQUARES; i++)
+	{
+		if (layout[i] == '\0')
+		{
+			return false;
+		}
+		SetGlyphAtSquare(i, layout[i]);
+	}
+	SetPlayerToMove(playerToMove);
+	SetCastlingRightsFromPieces();
+	return true;
+}
+
+void ChessPosition::WriteBoardState(char* out64) const
+{
+	for (int i = 0; i < NUM_BOARD_SQUARES; i++)
+	{
+		out64[i] = GetGlyphAtSquare(i);
+	}
+}
+
+//FEN piece letter -> piece code, EMPTY_PIECE_CODE for anything else
+struct ChessFenPieceCodeTable
+{
+	unsigned char m_codes[128] = {};
+};
+
+static constexpr ChessFenPieceCodeTable MakeFenPieceCodeTable()
+{
+	ChessFenPieceCodeTable table;
+	for (int i = 0; i < 128; i++)
+	{
+		table.m_codes[i] = 0xFF;
+	}
+	constexpr char upperCaseGlyphs[NUM_CHESS_PIECE_TYPES] = { 'P', 'R', 'N', 'B', 'Q', 'K' };
+	constexpr char lowerCaseGlyphs[NUM_CHESS_PIECE_TYPES] = { 'p', 'r', 'n', 'b', 'q', 'k' };
+	for (int type = 0; type < NUM_CHESS_PIECE_TYPES; type++)
+	{
+		table.m_codes[(int)upperCaseGlyphs[type]] = (unsigned char)type;
+		table.m_codes[(int)lowerCaseGlyphs[type]] = (unsigned char)(NUM_CHESS_PIECE_TYPES + type);
+	}
+	return table;
+}
+
+static constexpr ChessFenPieceCodeTable FEN_PIECE_CODES = MakeFenPieceCodeTable();
+static_assert(FEN_PIECE_CODES.m_codes[(int)'N'] == (int)ChessPieceType::KNIGHT && FEN_PIECE_CODES.m_codes[(int)'k'] == NUM_CHESS_PIECE_TYPES + (int)ChessPieceType::KING, "FEN letters map to piece codes");
+
+static const char* SkipFenSpaces(const char* cursor)
+{
+	while (*cursor == ' ')
+	{
+		cursor++;
+	}
+	return cursor;
+}
+
+//reads an unsigned number, returns nullptr if there is none
+static const char* ParseFenNumber(const char* cursor, int& outNumber)
+{
+	if (*cursor < '0' || *cursor > '9')
+	{
+		return nullptr;
+	}
+	int number = 0;
+	while (*cursor >= '0' && *cursor <= '9' && number < 100000)
+	{
+		number = number * 10 + (*cursor - '0');
+		cursor++;
+	}
+	outNumber = number;
+	return cursor;
+}
+
+bool ChessPosition::SetFromFEN(const char* fen)
+{
+	Clear();
+	if (fen == nullptr)
+	{
+		return false;
+	}
+	const char* cursor = SkipFenSpaces(fen);
+
+	//piece placement, rank 8 first
+	int file = 0;
+	int rank = 7;
+	for (; *cursor != ' ' && *cursor != '\0'; cursor++)
+	{
+		char c = *cursor;
+		if (c == '/')
+		{
+			if (file != 8 || rank == 0)
+			{
+				break;
+			}
+			file = 0;
+			rank--;
+		}
+		else if (c >= '1' && c <= '8')
+		{
+			file += c - '0';
+		}
+		else
+		{
+			unsigned char code = (c & 0x80) ? EMPTY_PIECE_CODE : FEN_PIECE_CODES.m_codes[(int)c];
+			if (code == EMPTY_PIECE_CODE || file > 7)
+			{
+				break;
+			}
+			SetPieceAtSquare(GetSquareForFileAndRank(file, rank), (ChessPieceType)(code % NUM_CHESS_PIECE_TYPES), code / NUM_CHESS_PIECE_TYPES);
+			file++;
+		}
+	}
+	if (file != 8 || rank != 0 || *cursor != ' ')
+	{
+		Clear();
+		return false;
+	}
+
+	//player to move
+	cursor = SkipFenSpaces(cursor);
+	if ((*cursor != 'w' && *cursor != 'b') || cursor[1] != ' ')
+	{
+		Clear();
+		return false;
+	}
+	SetPlayerToMove(*cursor == 'b' ? 1 : 0);
+	cursor = SkipFenSpaces(cursor + 1);
+
+	//castling rights, a right without its king and rook on the start squares is dropped
+	int castlingRights = CASTLING_NONE;
+	if (*cursor == '-')
+	{
+		cursor++;
+	}
+	else
+	{
+		for (; *cursor != ' ' && *cursor != '\0'; cursor++)
+		{
+			switch (*cursor)
+			{
+			case 'K': castlingRights |= CASTLING_PLAYER0_KINGSIDE;	break;
+			case 'Q': castlingRights |= CASTLING_PLAYER0_QUEENSIDE;	break;
+			case 'k': castlingRights |= CASTLING_PLAYER1_KINGSIDE;	break;
+			case 'q': castlingRights |= CASTLING_PLAYER1_QUEENSIDE;	break;
+			default:
+				Clear();
+				return false;
+			}
+		}
+	}
+	SetCastlingRights(castlingRights & GetCastlingRightsFromPieces());
+	cursor = SkipFenSpaces(cursor);
+
+	//en passant target square
+	if (*cursor == '-')
+	{
+		cursor++;
+	}
+	else
+	{
+		int epFile = (*cursor | 0x20) - 'a';
+		int epRank = cursor[1] - '1';
+		if (!IsFileAndRankValid(epFile, epRank) || epRank != (m_playerToMove == 0 ? 5 : 2))
+		{
+			Clear();
+			return false;
+		}
+		SetEnPassantSquare(GetSquareForFileAndRank(epFile, epRank));
+		cursor += 2;
+	}
+	if (*cursor != ' ' && *cursor != '\0')
+	{
+		Clear();
+		return false;
+	}
+
+	//halfmove clock and fullmove number are optional (EPD), anything after them is ignored
+	int number = 0;
+	const char* afterNumber = ParseFenNumber(SkipFenSpaces(cursor), number);
+	if (afterNumber != nullptr)
+	{
+		SetHalfmoveClock(number);
+		afterNumber = ParseFenNumber(SkipFenSpaces(afterNumber), number);
+		if (afterNumber != nullptr && number > 0)
+		{
+			SetFullmoveNumber(number);
+		}
+	}
+	return true;
+}
+
+int ChessPosition::WriteFEN(char* out, int outSize) const
+{
+	if (outSize < MAX_FEN_LENGTH)
+	{
+		return 0;
+	}
+	int length = 0;
+	for (int rank = 7; rank >= 0; rank--)
+	{
+		int numEmpty = 0;
+		for (int file = 0; file < 8; file++)
+		{
+			int square = GetSquareForFileAndRank(file, rank);
+			if (m_mailbox[square] == EMPTY_PIECE_CODE)
+			{
+				numEmpty++;
+				continue;
+			}
+			if (numEmpty > 0)
+			{
+				out[length++] = (char)('0' + numEmpty);
+				numEmpty = 0;
+			}
+			out[length++] = GetGlyphAtSquare(square);
+		}
+		if (numEmpty > 0)
+		{
+			out[length++] = (char)('0' + numEmpty);
+		}
+		out[length++] = rank > 0 ? '/' : ' ';
+	}
+
+	out[length++] = m_playerToMove == 0 ? 'w' : 'b';
+	out[length++] = ' ';
+
+	if (m_castlingRights == CASTLING_NONE)
+	{
+		out[length++] = '-';
+	}
+	if (m_castlingRights & CASTLING_PLAYER0_KINGSIDE)	out[length++] = 'K';
+	if (m_castlingRights & CASTLING_PLAYER0_QUEENSIDE)	out[length++] = 'Q';
+	if (m_castlingRights & CASTLING_PLAYER1_KINGSIDE)	out[length++] = 'k';
+	if (m_castlingRights & CASTLING_PLAYER1_QUEENSIDE)	out[length++] = 'q';
+	out[length++] = ' ';
+
+	if (m_enPassantSquare == NO_SQUARE)
+	{
+		out[length++] = '-';
+	}
+	else
+	{
+		out[length++] = (char)('a' + GetFileForSquare(m_enPassantSquare));
+		out[length++] = (char)('1' + GetRankForSquare(m_enPassantSquare));
+	}
+
+	length += snprintf(out + length, outSize - length, " %d %d", m_halfmoveClock, m_fullmoveNumber);
+	return length;
+}
+
+void ChessPosition::SetPieceAtSquare(int square, ChessPieceType type, int playerIndex)
+{
+	ClearSquare(square);
+	Bitboard squareBB = GetBitboardForSquare(square);
+	m_piecesByType[playerIndex][(int)type] |= squareBB;
+	m_piecesByPlayer[playerIndex] |= squareBB;
+	m_occupied |= squareBB;
+	m_mailbox[square] = GetPieceCode(type, playerIndex);
+	m_hash ^= ZOBRIST_KEYS.m_pieces[playerIndex][(int)type][square];
+	m_midgameScore += PIECE_SQUARE_SCORES.m_midgame[playerIndex][(int)type][square];
+	m_endgameScore += PIECE_SQUARE_SCORES.m_endgame[playerIndex][(int)type][square];
+	m_gamePhase += GAME_PHASE_WEIGHTS[(int)type];
+}
+
+void ChessPosition::SetGlyphAtSquare(int square, char glyph)
+{
+	ChessPieceType type = GetPieceTypeForGlyph(glyph);
+	if (type == ChessPieceType::NONE)
+	{
+		ClearSquare(square);
+		return;
+	}
+	SetPieceAtSquare(square, type, GetPlayerIndexForGlyph(glyph));
+}
+
+void ChessPosition::ClearSquare(int square)
+{
+	unsigned char code = m_mailbox[square];
+	if (code == EMPTY_PIECE_CODE)
+	{
+		return;
+	}
+	int playerIndex = code / NUM_CHESS_PIECE_TYPES;
+	int type = code % NUM_CHESS_PIECE_TYPES;
+	Bitboard squareBB = GetBitboardForSquare(square);
+	m_piecesByType[playerIndex][type] &= ~squareBB;
+	m_piecesByPlayer[playerIndex] &= ~squareBB;
+	m_occupied &= ~squareBB;
+	m_mailbox[square] = EMPTY_PIECE_CODE;
+	m_hash ^= ZOBRIST_KEYS.m_pieces[playerIndex][type][square];
+	m_midgameScore -= PIECE_SQUARE_SCORES.m_midgame[playerIndex][type][square];
+	m_endgameScore -= PIECE_SQUARE_SCORES.m_endgame[playerIndex][type][square];
+	m_gamePhase -= GAME_PHASE_WEIGHTS[type];
+}
+
+void ChessPosition::MovePieceToSquare(int fromSquare, int toSquare)
+{
+	unsigned char code = m_mailbox[fromSquare];
+	if (code == EMPTY_PIECE_CODE || fromSquare == toSquare)
+	{
+		return;
+	}
+	ClearSquare(fromSquare);
+	SetPieceAtSquare(toSquare, (ChessPieceType)(code % NUM_CHESS_PIECE_TYPES), code / NUM_CHESS_PIECE_TYPES);
+}
+
+void ChessPosition::SetPlayerToMove(int playerIndex)
+{
+	if (playerIndex != m_playerToMove)
+	{
+		m_hash ^= ZOBRIST_KEYS.m_player1ToMove;
+	}
+	m_playerToMove = playerIndex;
+}
+
+void ChessPosition::SetCastlingRights(int castlingRights)
+{
+	m_hash ^= ZOBRIST_KEYS.m_castlingRights[m_castlingRights];
+	m_castlingRights = castlingRights & CASTLING_ALL;
+	m_hash ^= ZOBRIST_KEYS.m_castlingRights[m_castlingRights];
+}
+
+void ChessPosition::SetCastlingRightsFromPieces()
+{
+	SetCastlingRights(GetCastlingRightsFromPieces());
+}
+
+int ChessPosition::GetCastlingRightsFromPieces() const
+{
+	int castlingRights = CASTLING_NONE;
+	for (int player = 0; player < NUM_CHESS_PLAYERS; player++)
+	{
+		Bitboard rooks = m_piecesByType[player][(int)ChessPieceType::ROOK];
+		if (!IsSquareInBitboard(m_piecesByType[player][(int)ChessPieceType::KING], KING_START_SQUARES[player]))
+		{
+			continue;
+		}
+		if (IsSquareInBitboard(rooks, KINGSIDE_ROOK_START_SQUARES[player]))
+		{
+			castlingRights |= GetKingsideCastlingRight(player);
+		}
+		if (IsSquareInBitboard(rooks, QUEENSIDE_ROOK_START_SQUARES[player]))
+		{
+			castlingRights |= GetQueensideCastlingRight(player);
+		}
+	}
+	return castlingRights;
+}
+
+void ChessPosition::UpdateCastlingRightsForMove(int fromSquare, int toSquare)
+{
+	SetCastlingRights(m_castlingRights & CASTLING_RIGHTS_TABLE.m_kept[fromSquare] & CASTLING_RIGHTS_TABLE.m_kept[toSquare]);
+}
+
+void ChessPosition::SetEnPassantSquare(int square)
+{
+	m_enPassantSquare = square;
+}
+
+void ChessPosition::SetHalfmoveClock(int halfmoveClock)
+{
+	m_halfmoveClock = halfmoveClock;
+}
+
+void ChessPosition::SetFullmoveNumber(int fullmoveNumber)
+{
+	m_fullmoveNumber = fullmoveNumber;
+}
+
+void ChessPosition::MakeMove(ChessMove move)
+{
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+
+	//the captured pawn of an en passant sits beside the moving pawn, behind the skipped square
+	int capturedSquare = move.IsEnPassant() ? GetSquareForFileAndRank(GetFileForSquare(toSquare), GetRankForSquare(fromSquare)) : toSquare;
+
+	ChessUndoRecord& record = m_undoStack[m_undoStackTop];
+	record.m_move = move;
+	record.m_capturedPieceCode = m_mailbox[capturedSquare];
+	record.m_castlingRights = (unsigned char)m_castlingRights;
+	record.m_enPassantSquare = (signed char)m_enPassantSquare;
+	record.m_halfmoveClock = (unsigned short)m_halfmoveClock;
+	record.m_hash = m_hash;
+	record.m_positionKey = GetHash();
+	m_undoStackTop = (m_undoStackTop + 1) % MAX_UNDO_RECORDS;
+	if (m_numUndoRecords < MAX_UNDO_RECORDS)
+	{
+		m_numUndoRecords++;
+	}
+
+	bool isPawnMove = IsSquareInBitboard(m_piecesByType[m_playerToMove][(int)ChessPieceType::PAWN], fromSquare);
+	bool isCapture = record.m_capturedPieceCode != EMPTY_PIECE_CODE;
+	m_halfmoveClock = (isPawnMove || isCapture) ? 0 : m_halfmoveClock + 1;
+
+	if (move.IsEnPassant())
+	{
+		ClearSquare(capturedSquare);
+	}
+	else if (move.GetFlags() == MOVE_FLAG_KING_CASTLE)
+	{
+		MovePieceToSquare(KINGSIDE_ROOK_START_SQUARES[m_playerToMove], toSquare - 1);
+	}
+	else if (move.GetFlags() == MOVE_FLAG_QUEEN_CASTLE)
+	{
+		MovePieceToSquare(QUEENSIDE_ROOK_START_SQUARES[m_playerToMove], toSquare + 1);
+	}
+
+	MovePieceToSquare(fromSquare, toSquare);
+	if (move.IsPromotion())
+	{
+		SetPieceAtSquare(toSquare, move.GetPromotionType(), m_playerToMove);
+	}
+
+	UpdateCastlingRightsForMove(fromSquare, toSquare);
+	m_enPassantSquare = move.IsDoublePawnPush() ? (fromSquare + toSquare) / 2 : NO_SQUARE;
+	if (m_playerToMove == 1)
+	{
+		m_fullmoveNumber++;
+	}
+	SetPlayerToMove(1 - m_playerToMove);
+}
+
+void ChessPosition::UnmakeMove()
+{
+	if (m_numUndoRecords == 0)
+	{
+		return;
+	}
+	m_numUndoRecords--;
+	m_undoStackTop = (m_undoStackTop + MAX_UNDO_RECORDS - 1) % MAX_UNDO_RECORDS;
+	ChessUndoRecord const& record = m_undoStack[m_undoStackTop];
+
+	ChessMove move = record.m_move;
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	m_playerToMove = 1 - m_playerToMove;
+	if (m_playerToMove == 1)
+	{
+		m_fullmoveNumber--;
+	}
+
+	if (move.IsPromotion())
+	{
+		ClearSquare(toSquare);
+		SetPieceAtSquare(fromSquare, ChessPieceType::PAWN, m_playerToMove);
+	}
+	else
+	{
+		MovePieceToSquare(toSquare, fromSquare);
+	}
+
+	if (record.m_capturedPieceCode != EMPTY_PIECE_CODE)
+	{
+		int capturedSquare = move.IsEnPassant() ? GetSquareForFileAndRank(GetFileForSquare(toSquare), GetRankForSquare(fromSquare)) : toSquare;
+		unsigned char code = record.m_capturedPieceCode;
+		SetPieceAtSquare(capturedSquare, (ChessPieceType)(code % NUM_CHESS_PIECE_TYPES), code / NUM_CHESS_PIECE_TYPES);
+	}
+	else if (move.GetFlags() == MOVE_FLAG_KING_CASTLE)
+	{
+		MovePieceToSquare(toSquare - 1, KINGSIDE_ROOK_START_SQUARES[m_playerToMove]);
+	}
+	else if (move.GetFlags() == MOVE_FLAG_QUEEN_CASTLE)
+	{
+		MovePieceToSquare(toSquare + 1, QUEENSIDE_ROOK_START_SQUARES[m_playerToMove]);
+	}
+
+	m_castlingRights = record.m_castlingRights;
+	m_enPassantSquare = record.m_enPassantSquare;
+	m_halfmoveClock = record.m_halfmoveClock;
+	m_hash = record.m_hash;
+}
+
+void ChessPosition::ClearUndoStack()
+{
+	m_numUndoRecords = 0;
+	m_undoStackTop = 0;
+}
+
+bool ChessPosition::IsSquareEmpty(int square) const
+{
+	return m_mailbox[square] == EMPTY_PIECE_CODE;
+}
+
+char ChessPosition::GetGlyphAtSquare(int square) const
+{
+	unsigned char code = m_mailbox[square];
+	if (code == EMPTY_PIECE_CODE)
+	{
+		return '.';
+	}
+	return GetGlyphForPiece((ChessPieceType)(code % NUM_CHESS_PIECE_TYPES), code / NUM_CHESS_PIECE_TYPES);
+}
+
+ChessPieceType ChessPosition::GetPieceTypeAtSquare(int square) const
+{
+	unsigned char code = m_mailbox[square];
+	if (code == EMPTY_PIECE_CODE)
+	{
+		return ChessPieceType::NONE;
+	}
+	return (ChessPieceType)(code % NUM_CHESS_PIECE_TYPES);
+}
+
+int ChessPosition::GetPlayerIndexAtSquare(int square) const
+{
+	unsigned char code = m_mailbox[square];
+	if (code == EMPTY_PIECE_CODE)
+	{
+		return -1;
+	}
+	return code / NUM_CHESS_PIECE_TYPES;
+}
+
+Bitboard ChessPosition::GetPieces(int playerIndex, ChessPieceType type) const
+{
+	return m_piecesByType[playerIndex][(int)type];
+}
+
+Bitboard ChessPosition::GetPiecesForType(ChessPieceType type) const
+{
+	return m_piecesByType[0][(int)type] | m_piecesByType[1][(int)type];
+}
+
+Bitboard ChessPosition::GetPiecesForPlayer(int playerIndex) const
+{
+	return m_piecesByPlayer[playerIndex];
+}
+
+Bitboard ChessPosition::GetOccupied() const
+{
+	return m_occupied;
+}
+
+int ChessPosition::GetKingSquare(int playerIndex) const
+{
+	Bitboard kings = m_piecesByType[playerIndex][(int)ChessPieceType::KING];
+	if (kings == EMPTY_BITBOARD)
+	{
+		return NO_SQUARE;
+	}
+	return GetLowestSquare(kings);
+}
+
+int ChessPosition::GetPlayerToMove() const
+{
+	return m_playerToMove;
+}
+
+int ChessPosition::GetCastlingRights() const
+{
+	return m_castlingRights;
+}
+
+bool ChessPosition::HasCastlingRight(int castlingRight) const
+{
+	return (m_castlingRights & castlingRight) != 0;
+}
+
+int ChessPosition::GetEnPassantSquare() const
+{
+	return m_enPassantSquare;
+}
+
+int ChessPosition::GetHalfmoveClock() const
+{
+	return m_halfmoveClock;
+}
+
+int ChessPosition::GetFullmoveNumber() const
+{
+	return m_fullmoveNumber;
+}
+
+int ChessPosition::GetNumUndoRecords() const
+{
+	return m_numUndoRecords;
+}
+
+uint64_t ChessPosition::GetHash() const
+{
+	return m_hash ^ GetEnPassantKey();
+}
+
+uint64_t ChessPosition::ComputeHashFromScratch() const
+{
+	uint64_t hash = 0;
+	for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+	{
+		unsigned char code = m_mailbox[square];
+		if (code != EMPTY_PIECE_CODE)
+		{
+			hash ^= ZOBRIST_KEYS.m_pieces[code / NUM_CHESS_PIECE_TYPES][code % NUM_CHESS_PIECE_TYPES][square];
+		}
+	}
+	hash ^= ZOBRIST_KEYS.m_castlingRights[m_castlingRights];
+	if (m_playerToMove == 1)
+	{
+		hash ^= ZOBRIST_KEYS.m_player1ToMove;
+	}
+	return hash ^ GetEnPassantKey();
+}
+
+uint64_t ChessPosition::GetHashAfterMoveEstimate(ChessMove move) const
+{
+	//castling rights, en passant, promotions and the castling rook are left out, a wrong guess only costs a wasted prefetch
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	unsigned char movingCode = m_mailbox[fromSquare];
+	unsigned char capturedCode = m_mailbox[toSquare];
+	uint64_t hash = m_hash ^ ZOBRIST_KEYS.m_player1ToMove;
+	if (movingCode != EMPTY_PIECE_CODE)
+	{
+		uint64_t const* movingKeys = ZOBRIST_KEYS.m_pieces[movingCode / NUM_CHESS_PIECE_TYPES][movingCode % NUM_CHESS_PIECE_TYPES];
+		hash ^= movingKeys[fromSquare] ^ movingKeys[toSquare];
+	}
+	if (capturedCode != EMPTY_PIECE_CODE)
+	{
+		hash ^= ZOBRIST_KEYS.m_pieces[capturedCode / NUM_CHESS_PIECE_TYPES][capturedCode % NUM_CHESS_PIECE_TYPES][toSquare];
+	}
+	return hash;
+}
+
+int ChessPosition::GetMidgameScore() const
+{
+	return m_midgameScore;
+}
+
+int ChessPosition::GetEndgameScore() const
+{
+	return m_endgameScore;
+}
+
+int ChessPosition::GetGamePhase() const
+{
+	return m_gamePhase < MAX_GAME_PHASE ? m_gamePhase : MAX_GAME_PHASE;
+}
+
+void ChessPosition::ComputeScoresFromScratch(int& midgameScore, int& endgameScore, int& gamePhase) const
+{
+	midgameScore = 0;
+	endgameScore = 0;
+	gamePhase = 0;
+	for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+	{
+		unsigned char code = m_mailbox[square];
+		if (code != EMPTY_PIECE_CODE)
+		{
+			int playerIndex = code / NUM_CHESS_PIECE_TYPES;
+			int type = code % NUM_CHESS_PIECE_TYPES;
+			midgameScore += PIECE_SQUARE_SCORES.m_midgame[playerIndex][type][square];
+			endgameScore += PIECE_SQUARE_SCORES.m_endgame[playerIndex][type][square];
+			gamePhase += GAME_PHASE_WEIGHTS[type];
+		}
+	}
+	gamePhase = gamePhase < MAX_GAME_PHASE ? gamePhase : MAX_GAME_PHASE;
+}
+
+uint64_t ChessPosition::GetEnPassantKey() const
+{
+	//the en passant file only counts while a pawn of the player to move can actually capture there,
+	//otherwise the same position reached with and without a double push would hash differently
+	if (m_enPassantSquare == NO_SQUARE)
+	{
+		return 0;
+	}
+	Bitboard capturingPawns = GetPawnAttacks(1 - m_playerToMove, m_enPassantSquare) & m_piecesByType[m_playerToMove][(int)ChessPieceType::PAWN];
+	if (capturingPawns == EMPTY_BITBOARD)
+	{
+		return 0;
+	}
+	return ZOBRIST_KEYS.m_enPassantFiles[GetFileForSquare(m_enPassantSquare)];
+}
+
+int ChessPosition::GetRepetitionCount() const
+{
+	//a capture or pawn move can never be undone, so no position before it can come back;
+	//the player to move must match too, which leaves every second ply
+	uint64_t key = GetHash();
+	int pliesToScan = m_halfmoveClock < m_numUndoRecords ? m_halfmoveClock : m_numUndoRecords;
+	int count = 0;
+	for (int ply = 2; ply <= pliesToScan; ply += 2)
+	{
+		ChessUndoRecord const& record = m_undoStack[(m_undoStackTop + MAX_UNDO_RECORDS - ply) % MAX_UNDO_RECORDS];
+		if (record.m_positionKey == key)
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+bool ChessPosition::IsThreefoldRepetition() const
+{
+	return GetRepetitionCount() >= 2;
+}
+
+bool ChessPosition::IsFiftyMoveRuleDraw() const
+{
+	return m_halfmoveClock >= FIFTY_MOVE_RULE_PLIES;
+}
+
+ChessMove ChessPosition::GetLastMove() const
+{
+	if (m_numUndoRecords == 0)
+	{
+		return ChessMove();
+	}
+	return m_undoStack[(m_undoStackTop + MAX_UNDO_RECORDS - 1) % MAX_UNDO_RECORDS].m_move;
+}
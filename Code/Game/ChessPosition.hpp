@@ -0,0 +1,121 @@
+#pragma once
+#include "Game/ChessCommon.hpp"
+#include "Game/ChessMove.hpp"
+
+
+//everything MakeMove() overwrites that the move itself cannot give back
+struct ChessUndoRecord
+{
+	ChessMove m_move;
+	unsigned char m_capturedPieceCode = 0xFF;
+	unsigned char m_castlingRights = CASTLING_NONE;
+	signed char m_enPassantSquare = NO_SQUARE;
+	unsigned short m_halfmoveClock = 0;
+	uint64_t m_hash = 0;
+	uint64_t m_positionKey = 0;//GetHash() before the move, for repetition checks
+};
+
+
+//headless board representation: one bitboard per piece type and player,
+//plus a 64 entry mailbox so "what is on e4" is a single array read
+class ChessPosition
+{
+public:
+	ChessPosition();
+	~ChessPosition();
+
+	void Clear();
+
+	//layout is the 64 character board state (a1..h8, '.' = empty)
+	//a board state has no castling field, so rights are granted from the piece placement
+	bool SetFromBoardState(const char* layout, int playerToMove = 0);
+	void WriteBoardState(char* out64)const;
+
+	//FEN with all six fields, EPD style strings without the two counters (or with trailing operations) are accepted too
+	//no allocation; on failure the position is cleared and false is returned
+	bool SetFromFEN(const char* fen);
+	int WriteFEN(char* out, int outSize)const;//null terminated, returns the length or 0 if outSize is too small
+
+	//set functions, all of them keep bitboards and mailbox in sync
+	void SetPieceAtSquare(int square, ChessPieceType type, int playerIndex);
+	void SetGlyphAtSquare(int square, char glyph);
+	void ClearSquare(int square);
+	void MovePieceToSquare(int fromSquare, int toSquare);//whatever is on toSquare is removed
+	void SetPlayerToMove(int playerIndex);
+	void SetCastlingRights(int castlingRights);//ChessCastlingRight flags
+	void SetCastlingRightsFromPieces();//grants every right whose king and rook are still on their start squares
+	void UpdateCastlingRightsForMove(int fromSquare, int toSquare);//anything leaving or landing on a king or rook start square
+	void SetEnPassantSquare(int square);//the square a pawn skipped over last move, NO_SQUARE if none
+
+	void SetHalfmoveClock(int halfmoveClock);//plies since the last capture or pawn move
+	void SetFullmoveNumber(int fullmoveNumber);//starts at 1, goes up after every move of player 1
+
+	//plays a move generated for this position and passes the turn, no legality check
+	//the undo stack is a preallocated ring, only the last MAX_UNDO_RECORDS moves can be unmade
+	void MakeMove(ChessMove move);
+	void UnmakeMove();
+	void ClearUndoStack();
+
+	//get functions
+	bool IsSquareEmpty(int square)const;
+	char GetGlyphAtSquare(int square)const;
+	ChessPieceType GetPieceTypeAtSquare(int square)const;
+	int GetPlayerIndexAtSquare(int square)const;//0 = player 0, 1 = player 1, -1 = empty
+	Bitboard GetPieces(int playerIndex, ChessPieceType type)const;
+	Bitboard GetPiecesForType(ChessPieceType type)const;
+	Bitboard GetPiecesForPlayer(int playerIndex)const;
+	Bitboard GetOccupied()const;
+	int GetKingSquare(int playerIndex)const;//NO_SQUARE if the king is missing
+	int GetPlayerToMove()const;
+	int GetCastlingRights()const;
+	bool HasCastlingRight(int castlingRight)const;
+	int GetEnPassantSquare()const;
+	int GetHalfmoveClock()const;
+	int GetFullmoveNumber()const;
+	int GetCastlingRightsFromPieces()const;//every right whose king and rook are still on their start squares
+	int GetNumUndoRecords()const;
+	ChessMove GetLastMove()const;//null move if the undo stack is empty
+	uint64_t GetHash()const;//zobrist key, kept up to date by every set function
+	uint64_t ComputeHashFromScratch()const;//slow, for verifying the incremental key
+	uint64_t GetHashAfterMoveEstimate(ChessMove move)const;//moved and captured piece and player to move only, for prefetching
+
+	//tapered evaluation terms for player 0, kept up to date by every set function like the hash (see ChessPieceSquareTables.hpp)
+	int GetMidgameScore()const;
+	int GetEndgameScore()const;
+	int GetGamePhase()const;//MAX_GAME_PHASE with all pieces on the board down to 0 with only kings and pawns
+	void ComputeScoresFromScratch(int& midgameScore, int& endgameScore, int& gamePhase)const;//slow, for verifying the incremental scores
+
+	//draw rules, only the plies since the last capture or pawn move are scanned
+	int GetRepetitionCount()const;//how many earlier positions match this one
+	bool IsThreefoldRepetition()const;
+	bool IsFiftyMoveRuleDraw()const;
+
+public:
+	static constexpr int FIFTY_MOVE_RULE_PLIES = 100;
+	static constexpr int MAX_FEN_LENGTH = 100;//longest legal FEN is 92 characters, plus the terminator
+	static constexpr int MAX_UNDO_RECORDS = 1024;
+
+private:
+	static constexpr unsigned char EMPTY_PIECE_CODE = 0xFF;
+	static unsigned char GetPieceCode(ChessPieceType type, int playerIndex) { return (unsigned char)(playerIndex * NUM_CHESS_PIECE_TYPES + (int)type); }
+	uint64_t GetEnPassantKey()const;
+
+private:
+	Bitboard m_piecesByType[NUM_CHESS_PLAYERS][NUM_CHESS_PIECE_TYPES] = {};
+	Bitboard m_piecesByPlayer[NUM_CHESS_PLAYERS] = {};
+	Bitboard m_occupied = EMPTY_BITBOARD;
+	unsigned char m_mailbox[NUM_BOARD_SQUARES] = {};
+	int m_playerToMove = 0;
+	int m_castlingRights = CASTLING_NONE;
+	int m_enPassantSquare = NO_SQUARE;
+	int m_halfmoveClock = 0;
+	int m_fullmoveNumber = 1;
+	uint64_t m_hash = 0;//pieces, castling rights and player to move, en passant is added by GetHash()
+	int m_midgameScore = 0;
+	int m_endgameScore = 0;
+	int m_gamePhase = 0;
+
+	ChessUndoRecord m_undoStack[MAX_UNDO_RECORDS];
+	int m_numUndoRecords = 0;
+	int m_undoStackTop = 0;//next ring slot to write
+};
@@ -0,0 +1,491 @@
+#include "Game/ChessSearch.hpp"
+#include "Game/ChessMoveGen.hpp"
+#include "Game/ChessMovePicker.hpp"
+#include "Game/ChessEvaluation.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+
+//the clock, the stop flags and the shared node count are only looked at every few thousand nodes
+constexpr uint64_t LIMIT_CHECK_INTERVAL_MASK = 2047;
+constexpr int MAX_HISTORY_PENALTY_MOVES = 64;//quiet moves that tried and failed before a cutoff, later ones are not penalized
+constexpr int DELTA_PRUNING_MARGIN = 200;//how much the position may gain beyond the captured material, for delta pruning
+
+
+//mate scores are kept relative to the node in the table, so they stay right when the node is reached at another ply
+static int GetScoreForTable(int score, int ply)
+{
+	return score >= MATE_BOUND ? score + ply : (score <= -MATE_BOUND ? score - ply : score);
+}
+
+static int GetScoreFromTable(int score, int ply)
+{
+	return score >= MATE_BOUND ? score - ply : (score <= -MATE_BOUND ? score + ply : score);
+}
+
+//a mate score counted from the root like a searched mate, one further away than MAX_SEARCH_PLY is still scored as a mate
+static int GetScoreForTablebaseResult(ChessTablebaseResult const& result, int ply)
+{
+	int matePly = std::min(ply + result.m_pliesToMate, MAX_SEARCH_PLY);
+	return result.m_wdl > 0 ? MATE_SCORE - matePly : (result.m_wdl < 0 ? -MATE_SCORE + matePly : DRAW_SCORE);
+}
+
+
+ChessSearchWorker::ChessSearchWorker(ChessSearch& owner, int threadIndex)
+	:m_owner(owner), m_threadIndex(threadIndex)
+{
+}
+
+void ChessSearchWorker::Run(ChessPosition const& rootPosition, ChessMoveList const& rootMoves)
+{
+	m_position = rootPosition;
+	m_nodes = 0;
+	m_nodesNotReported = 0;
+	m_isAborted = false;
+	//even a search stopped before depth 1 finishes has to answer with a legal move
+	m_bestMove = rootMoves.IsEmpty() ? ChessMove() : rootMoves[0];
+	m_bestScore = 0;
+	m_completedDepth = 0;
+	m_history.Clear();
+	for (ChessMove* killers : m_killers)
+	{
+		killers[0] = ChessMove();
+		killers[1] = ChessMove();
+	}
+	if (m_owner.m_network != nullptr)
+	{
+		m_accumulators.resize(MAX_SEARCH_PLY + 1);
+		m_owner.m_network->RefreshAccumulator(m_position, m_accumulators[0]);
+	}
+
+	ChessSearchLimits const& limits = m_owner.m_limits;
+	int maxDepth = limits.m_maxDepth > 0 && limits.m_maxDepth < MAX_SEARCH_DEPTH ? limits.m_maxDepth : MAX_SEARCH_DEPTH;
+	//every other helper runs one ply ahead, so the threads spread over two depths instead of repeating the same work
+	int depthOffset = m_threadIndex & 1;
+	for (int depth = 1 + depthOffset; depth <= maxDepth && !rootMoves.IsEmpty(); depth++)
+	{
+		m_rootBestMove = ChessMove();
+		int score = Negamax(depth, 0, -SEARCH_INFINITY, SEARCH_INFINITY);
+		if (m_isAborted)
+		{
+			//the previous best move is searched first, so any move that beat it before the abort is an improvement
+			if (!m_rootBestMove.IsNull())
+			{
+				m_bestMove = m_rootBestMove;
+			}
+			break;
+		}
+
+		m_bestMove = m_rootBestMove;
+		m_bestScore = score;
+		m_completedDepth = depth;
+
+		//only the main thread decides when the search is over
+		if (m_threadIndex != 0)
+		{
+			continue;
+		}
+		//a shorter mate would have shown up at a lower depth
+		if (IsMateScore(score))
+		{
+			break;
+		}
+		//the next iteration takes several times longer, do not start what cannot finish
+		if (limits.m_maxMilliseconds > 0)
+		{
+			double elapsedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_owner.m_startTime).count();
+			if (elapsedMilliseconds * 2.0 > (double)limits.m_maxMilliseconds)
+			{
+				break;
+			}
+		}
+	}
+	m_owner.ReportNodes(m_nodesNotReported);
+	m_nodesNotReported = 0;
+}
+
+bool ChessSearchWorker::EnterNode()
+{
+	if ((m_nodes & LIMIT_CHECK_INTERVAL_MASK) == 0)
+	{
+		m_owner.ReportNodes(m_nodesNotReported);
+		m_nodesNotReported = 0;
+		if (m_owner.IsLimitReached())
+		{
+			m_isAborted = true;
+		}
+	}
+	if (m_isAborted)
+	{
+		return false;
+	}
+	m_nodes++;
+	m_nodesNotReported++;
+	return true;
+}
+
+int ChessSearchWorker::Negamax(int depth, int ply, int alpha, int beta)
+{
+	//the horizon is not scored with captures still hanging
+	if (depth <= 0)
+	{
+		return Quiescence(ply, alpha, beta);
+	}
+	if (!EnterNode())
+	{
+		return 0;
+	}
+
+	//a repetition inside the tree is scored as a draw right away, the opponent could repeat again
+	if (ply > 0 && (m_position.GetRepetitionCount() > 0 || m_position.IsFiftyMoveRuleDraw()))
+	{
+		return DRAW_SCORE;
+	}
+	//the tables know the result exactly, the fifty move rule aside
+	ChessTablebaseResult tablebaseResult;
+	if (ply > 0 && m_owner.m_tablebases.Probe(m_position, tablebaseResult))
+	{
+		return GetScoreForTablebaseResult(tablebaseResult, ply);
+	}
+
+	uint64_t key = m_position.GetHash();
+	ChessTTProbeResult entry;
+	ChessMove tableMove;
+	if (m_owner.m_table.Probe(key, entry))
+	{
+		tableMove = entry.m_move;
+		int tableScore = GetScoreFromTable(entry.m_score, ply);
+		bool isCutoff = entry.m_bound == BOUND_EXACT
+			|| (entry.m_bound == BOUND_LOWER && tableScore >= beta)
+			|| (entry.m_bound == BOUND_UPPER && tableScore <= alpha);
+		if (ply > 0 && entry.m_depth >= depth && isCutoff)
+		{
+			return tableScore;
+		}
+	}
+
+	int playerIndex = m_position.GetPlayerToMove();
+	bool isAtMaxPly = ply >= MAX_SEARCH_PLY;
+	ChessMove const* killers = isAtMaxPly ? nullptr : m_killers[ply];
+	ChessMove counterMove = isAtMaxPly ? ChessMove() : m_history.GetCounterMove(m_position);
+	//the table's (or at the root the previous iteration's) best move first
+	ChessMovePicker picker(m_position, (ply == 0 && tableMove.IsNull()) ? m_bestMove : tableMove, killers, counterMove, m_history);
+	ChessMove move = picker.GetNextMove();
+	if (move.IsNull())
+	{
+		return IsPlayerInCheck(m_position, playerIndex) ? -MATE_SCORE + ply : DRAW_SCORE;
+	}
+	if (isAtMaxPly)
+	{
+		return Evaluate(ply);
+	}
+
+	int originalAlpha = alpha;
+	int bestScore = -SEARCH_INFINITY;
+	ChessMove bestMove;
+	ChessMove triedQuietMoves[MAX_HISTORY_PENALTY_MOVES];
+	int numTriedQuietMoves = 0;
+	for (; !move.IsNull(); move = picker.GetNextMove())
+	{
+		//the child's bucket loads while MakeMove() runs
+		m_owner.m_table.Prefetch(m_position.GetHashAfterMoveEstimate(move));
+		if (m_owner.m_network != nullptr)
+		{
+			m_owner.m_network->UpdateAccumulator(m_accumulators[ply], m_accumulators[ply + 1], m_position, move);
+		}
+		m_position.MakeMove(move);
+		int score = -Negamax(depth - 1, ply + 1, -beta, -alpha);
+		m_position.UnmakeMove();
+		if (m_isAborted)
+		{
+			return 0;
+		}
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestMove = move;
+			if (ply == 0)
+			{
+				m_rootBestMove = move;
+			}
+		}
+		bool isQuiet = !move.IsCapture() && !move.IsPromotion();
+		if (score > alpha)
+		{
+			alpha = score;
+			if (alpha >= beta)
+			{
+				if (isQuiet)
+				{
+					UpdateQuietMoveStats(move, depth, ply, triedQuietMoves, numTriedQuietMoves);
+				}
+				break;
+			}
+		}
+		if (isQuiet && numTriedQuietMoves < MAX_HISTORY_PENALTY_MOVES)
+		{
+			triedQuietMoves[numTriedQuietMoves++] = move;
+		}
+	}
+
+	int bound = bestScore >= beta ? BOUND_LOWER : (bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER);
+	//when every move failed low none of them is known to be best
+	m_owner.m_table.Store(key, bound == BOUND_UPPER ? ChessMove() : bestMove, GetScoreForTable(bestScore, ply), depth, bound);
+	return bestScore;
+}
+
+int ChessSearchWorker::Quiescence(int ply, int alpha, int beta)
+{
+	if (!EnterNode())
+	{
+		return 0;
+	}
+	if (ply >= MAX_SEARCH_PLY)
+	{
+		return Evaluate(ply);
+	}
+
+	//in check every evasion is searched, standing pat is not an option
+	bool isInCheck = IsPlayerInCheck(m_position, m_position.GetPlayerToMove());
+	int bestScore = -SEARCH_INFINITY;
+	int standPatScore = 0;
+	if (!isInCheck)
+	{
+		//the player to move can usually do at least as well as the static score by not capturing
+		standPatScore = Evaluate(ply);
+		if (standPatScore >= beta)
+		{
+			return standPatScore;
+		}
+		if (standPatScore > alpha)
+		{
+			alpha = standPatScore;
+		}
+		bestScore = standPatScore;
+	}
+
+	//outside of check the picker leaves out the captures that lose material
+	ChessMovePicker picker = isInCheck ? ChessMovePicker(m_position, ChessMove(), nullptr, ChessMove(), m_history) : ChessMovePicker(m_position, m_history);
+	int numMovesSearched = 0;
+	for (ChessMove move = picker.GetNextMove(); !move.IsNull(); move = picker.GetNextMove())
+	{
+		numMovesSearched++;
+		//delta pruning: even winning the victim and a margin on top would not bring the score up to alpha
+		if (!isInCheck && !move.IsPromotion())
+		{
+			ChessPieceType victim = move.IsEnPassant() ? ChessPieceType::PAWN : m_position.GetPieceTypeAtSquare(move.GetToSquare());
+			if (standPatScore + GetPieceValue(victim) + DELTA_PRUNING_MARGIN <= alpha)
+			{
+				continue;
+			}
+		}
+
+		if (m_owner.m_network != nullptr)
+		{
+			m_owner.m_network->UpdateAccumulator(m_accumulators[ply], m_accumulators[ply + 1], m_position, move);
+		}
+		m_position.MakeMove(move);
+		int score = -Quiescence(ply + 1, -beta, -alpha);
+		m_position.UnmakeMove();
+		if (m_isAborted)
+		{
+			return 0;
+		}
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+		}
+		if (score > alpha)
+		{
+			alpha = score;
+			if (alpha >= beta)
+			{
+				break;
+			}
+		}
+	}
+
+	if (isInCheck && numMovesSearched == 0)
+	{
+		return -MATE_SCORE + ply;
+	}
+	return bestScore;
+}
+
+int ChessSearchWorker::Evaluate(int ply) const
+{
+	if (m_owner.m_network == nullptr)
+	{
+		return EvaluatePosition(m_position);
+	}
+	//an untrained or badly scaled network must not produce scores that read as mates
+	int score = m_owner.m_network->Evaluate(m_accumulators[ply], m_position.GetPlayerToMove());
+	return score < -MATE_BOUND + 1 ? -MATE_BOUND + 1 : (score > MATE_BOUND - 1 ? MATE_BOUND - 1 : score);
+}
+
+void ChessSearchWorker::UpdateQuietMoveStats(ChessMove cutoffMove, int depth, int ply, ChessMove const* triedQuietMoves, int numTriedQuietMoves)
+{
+	ChessMove* killers = m_killers[ply];
+	if (killers[0] != cutoffMove)
+	{
+		killers[1] = killers[0];
+		killers[0] = cutoffMove;
+	}
+
+	//deeper cutoffs say more, the quiet moves searched first were wrong to come first
+	int playerIndex = m_position.GetPlayerToMove();
+	int bonus = depth * depth;
+	m_history.Update(playerIndex, cutoffMove, bonus);
+	for (int i = 0; i < numTriedQuietMoves; i++)
+	{
+		m_history.Update(playerIndex, triedQuietMoves[i], -bonus);
+	}
+	m_history.SetCounterMove(m_position, cutoffMove);
+}
+
+
+ChessSearch::ChessSearch()
+{
+	m_table.Resize(ChessTranspositionTable::DEFAULT_SIZE_MB);
+}
+
+ChessSearch::~ChessSearch()
+{
+}
+
+ChessSearchResult ChessSearch::Search(ChessPosition const& rootPosition, ChessSearchLimits const& limits)
+{
+	m_limits = limits;
+	m_startTime = std::chrono::steady_clock::now();
+	m_totalNodes = 0;
+	m_isSearchDone = false;
+	m_table.NewSearch();
+
+	ChessSearchResult result;
+	ChessMoveList rootMoves;
+	GenerateLegalMoves(rootPosition, rootMoves);
+
+	std::vector<std::unique_ptr<ChessSearchWorker>> workers;
+	for (int i = 0; i < m_numThreads; i++)
+	{
+		workers.push_back(std::make_unique<ChessSearchWorker>(*this, i));
+	}
+	std::vector<std::thread> helperThreads;
+	for (int i = 1; i < m_numThreads; i++)
+	{
+		ChessSearchWorker* helper = workers[i].get();
+		helperThreads.emplace_back([helper, &rootPosition, &rootMoves]() { helper->Run(rootPosition, rootMoves); });
+	}
+	workers[0]->Run(rootPosition, rootMoves);
+	m_isSearchDone = true;
+	for (std::thread& helperThread : helperThreads)
+	{
+		helperThread.join();
+	}
+
+	//a helper that finished a deeper iteration than the main thread has the better informed move
+	ChessSearchWorker const* bestWorker = workers[0].get();
+	for (auto const& worker : workers)
+	{
+		if (worker->GetCompletedDepth() > bestWorker->GetCompletedDepth() && !worker->GetBestMove().IsNull())
+		{
+			bestWorker = worker.get();
+		}
+		result.m_nodes += worker->GetNodes();
+	}
+	result.m_bestMove = bestWorker->GetBestMove();
+	result.m_score = bestWorker->GetBestScore();
+	result.m_depth = bestWorker->GetCompletedDepth();
+	result.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+	result.m_hashfull = m_table.GetHashfull();
+	return result;
+}
+
+void ChessSearch::RequestStop()
+{
+	m_isStopRequested = true;
+}
+
+void ChessSearch::ClearStopRequest()
+{
+	m_isStopRequested = false;
+}
+
+void ChessSearch::SetNumThreads(int numThreads)
+{
+	m_numThreads = numThreads < 1 ? 1 : (numThreads > MAX_SEARCH_THREADS ? MAX_SEARCH_THREADS : numThreads);
+}
+
+int ChessSearch::GetNumThreads() const
+{
+	return m_numThreads;
+}
+
+ChessTranspositionTable& ChessSearch::GetTranspositionTable()
+{
+	return m_table;
+}
+
+bool ChessSearch::LoadNetwork(const char* filePath)
+{
+	std::unique_ptr<ChessNNUENetwork> network = std::make_unique<ChessNNUENetwork>();
+	if (!network->LoadFromFile(filePath))
+	{
+		m_network.reset();
+		return false;
+	}
+	m_network = std::move(network);
+	return true;
+}
+
+void ChessSearch::ClearNetwork()
+{
+	m_network.reset();
+}
+
+bool ChessSearch::IsUsingNetwork() const
+{
+	return m_network != nullptr;
+}
+
+int ChessSearch::LoadTablebases(const char* directoryPath)
+{
+	m_tablebases.Clear();
+	if (directoryPath == nullptr || directoryPath[0] == '\0')
+	{
+		return 0;
+	}
+	return m_tablebases.OpenDirectory(directoryPath);
+}
+
+ChessTablebases const& ChessSearch::GetTablebases() const
+{
+	return m_tablebases;
+}
+
+bool ChessSearch::IsLimitReached() const
+{
+	if (m_isStopRequested || m_isSearchDone)
+	{
+		return true;
+	}
+	if (m_limits.m_maxNodes > 0 && m_totalNodes >= m_limits.m_maxNodes)
+	{
+		return true;
+	}
+	if (m_limits.m_maxMilliseconds > 0)
+	{
+		auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+		return std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() >= m_limits.m_maxMilliseconds;
+	}
+	return false;
+}
+
+void ChessSearch::ReportNodes(uint64_t numNodes)
+{
+	m_totalNodes.fetch_add(numNodes, std::memory_order_relaxed);
+}
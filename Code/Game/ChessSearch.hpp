@@ -0,0 +1,131 @@
+#pragma once
+#include "Game/ChessMove.hpp"
+#include "Game/ChessPosition.hpp"
+#include "Game/ChessMovePicker.hpp"
+#include "Game/ChessTranspositionTable.hpp"
+#include "Game/ChessNNUE.hpp"
+#include "Game/ChessTablebase.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+
+//scores are centipawns for the player to move, mates are MATE_SCORE minus the plies to the mate
+constexpr int MAX_SEARCH_DEPTH = 64;
+constexpr int MAX_SEARCH_PLY = 128;
+constexpr int MAX_SEARCH_THREADS = 256;
+constexpr int MATE_SCORE = 32000;
+constexpr int MATE_BOUND = MATE_SCORE - MAX_SEARCH_PLY;//anything beyond is a forced mate
+constexpr int SEARCH_INFINITY = MATE_SCORE + 1;
+constexpr int DRAW_SCORE = 0;
+
+constexpr bool IsMateScore(int score) { return score >= MATE_BOUND || score <= -MATE_BOUND; }
+
+
+//the search stops at whichever limit it reaches first, 0 = no limit
+struct ChessSearchLimits
+{
+	int m_maxDepth = MAX_SEARCH_DEPTH;
+	uint64_t m_maxNodes = 0;
+	int m_maxMilliseconds = 0;
+};
+
+struct ChessSearchResult
+{
+	ChessMove m_bestMove;//null if the player to move has no legal move
+	int m_score = 0;
+	int m_depth = 0;//last iteration that finished
+	uint64_t m_nodes = 0;//all threads
+	double m_seconds = 0.0;
+	int m_hashfull = 0;//permille of the transposition table this search filled
+};
+
+
+class ChessSearch;
+
+//one search thread: its own position copy and counters, the transposition table is shared through the owner
+class ChessSearchWorker
+{
+public:
+	ChessSearchWorker(ChessSearch& owner, int threadIndex);
+
+	void Run(ChessPosition const& rootPosition, ChessMoveList const& rootMoves);
+
+	ChessMove GetBestMove()const { return m_bestMove; }
+	int GetBestScore()const { return m_bestScore; }
+	int GetCompletedDepth()const { return m_completedDepth; }
+	uint64_t GetNodes()const { return m_nodes; }
+
+private:
+	bool EnterNode();//counts the node, false once the search has to stop
+	int Negamax(int depth, int ply, int alpha, int beta);
+	int Quiescence(int ply, int alpha, int beta);//captures only until the position is quiet, in check every evasion
+	int Evaluate(int ply)const;
+	//killers, history and counter move after a quiet move cut off, triedQuietMoves are the quiet moves searched before it
+	void UpdateQuietMoveStats(ChessMove cutoffMove, int depth, int ply, ChessMove const* triedQuietMoves, int numTriedQuietMoves);
+
+private:
+	ChessSearch& m_owner;
+	int m_threadIndex = 0;
+	ChessPosition m_position;
+	uint64_t m_nodes = 0;
+	uint64_t m_nodesNotReported = 0;
+	bool m_isAborted = false;
+	std::vector<ChessNNUEAccumulator> m_accumulators;//one per ply, only with a network
+	ChessMove m_killers[MAX_SEARCH_PLY + 1][2];//the last two quiet moves that cut off at each ply
+	ChessMoveHistory m_history;
+
+	ChessMove m_rootBestMove;//best move of the iteration in progress
+	ChessMove m_bestMove;//from the last finished iteration, or a partial one that improved on it
+	int m_bestScore = 0;
+	int m_completedDepth = 0;
+};
+
+
+//iterative deepening negamax with alpha-beta pruning and a quiescence search on a headless position, InitializeChessAttackTables() must have been called;
+//with more than one thread it runs Lazy SMP: helper threads search the same root at staggered depths and
+//speed the main thread up only through the entries they leave in the shared transposition table
+class ChessSearch
+{
+	friend class ChessSearchWorker;
+
+public:
+	ChessSearch();
+	~ChessSearch();
+
+	ChessSearchResult Search(ChessPosition const& rootPosition, ChessSearchLimits const& limits);
+	//safe from any thread, Search() then returns the best move found so far;
+	//the request stays until ClearStopRequest() so a stop sent just before a search starts is not lost
+	void RequestStop();
+	void ClearStopRequest();
+
+	void SetNumThreads(int numThreads);
+	int GetNumThreads()const;
+	ChessTranspositionTable& GetTranspositionTable();
+	//evaluate with a network instead of the piece-square tables, false (and no network) if the file does not load
+	bool LoadNetwork(const char* filePath);
+	void ClearNetwork();
+	bool IsUsingNetwork()const;
+	//nodes below the root with few enough pieces are scored from the tables instead of searched; replaces the tables
+	//opened before, returns how many were found (an empty path or a missing directory leaves none)
+	int LoadTablebases(const char* directoryPath);
+	ChessTablebases const& GetTablebases()const;
+
+private:
+	bool IsLimitReached()const;
+	void ReportNodes(uint64_t numNodes);
+
+private:
+	ChessTranspositionTable m_table;
+	std::unique_ptr<ChessNNUENetwork> m_network;
+	ChessTablebases m_tablebases;
+	int m_numThreads = 1;
+
+	ChessSearchLimits m_limits;
+	std::chrono::steady_clock::time_point m_startTime;
+	std::atomic<uint64_t> m_totalNodes = 0;//reported by the workers every few thousand nodes
+	std::atomic<bool> m_isStopRequested = false;
+	std::atomic<bool> m_isSearchDone = false;//set by the main thread to release the helpers
+};
@@ -0,0 +1,497 @@
+#include "Game/ChessTablebase.hpp"
+#include "Game/ChessMoveGen.hpp"
+#include "Game/ChessAttacks.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+
+//pieces in the order names list them, strongest first
+constexpr ChessPieceType TABLEBASE_PIECE_ORDER[5] = { ChessPieceType::QUEEN, ChessPieceType::ROOK, ChessPieceType::BISHOP, ChessPieceType::KNIGHT, ChessPieceType::PAWN };
+constexpr char TABLEBASE_PIECE_LETTERS[5] = { 'Q', 'R', 'B', 'N', 'P' };
+
+
+static int GetTablebasePieceRank(ChessPieceType type)
+{
+	for (int rank = 0; rank < 5; rank++)
+	{
+		if (TABLEBASE_PIECE_ORDER[rank] == type)
+		{
+			return rank;
+		}
+	}
+	return 5;
+}
+
+static int GetNumKingSquares(bool hasPawns)
+{
+	//pawns only allow the left-right mirror, without them the king also stays on ranks 1-4
+	return hasPawns ? 32 : 16;
+}
+
+static void WriteTablebaseName(int const* firstRanks, int numFirst, int const* secondRanks, int numSecond, char* outName)
+{
+	int length = 0;
+	outName[length++] = 'K';
+	for (int i = 0; i < numFirst; i++)
+	{
+		outName[length++] = TABLEBASE_PIECE_LETTERS[firstRanks[i]];
+	}
+	outName[length++] = 'K';
+	for (int i = 0; i < numSecond; i++)
+	{
+		outName[length++] = TABLEBASE_PIECE_LETTERS[secondRanks[i]];
+	}
+	outName[length] = '\0';
+}
+
+//true if the first list of piece ranks (each sorted strongest first) is the side a table names first
+static bool IsFirstTablebaseSide(int const* ranks, int numRanks, int const* otherRanks, int numOtherRanks)
+{
+	if (numRanks != numOtherRanks)
+	{
+		return numRanks > numOtherRanks;
+	}
+	for (int i = 0; i < numRanks; i++)
+	{
+		if (ranks[i] != otherRanks[i])
+		{
+			return ranks[i] < otherRanks[i];
+		}
+	}
+	return true;
+}
+
+//insertion sort, a side has at most two pieces besides its king
+static void SortTablebaseRanks(int* ranks, int numRanks)
+{
+	for (int i = 1; i < numRanks; i++)
+	{
+		for (int j = i; j > 0 && ranks[j] < ranks[j - 1]; j--)
+		{
+			std::swap(ranks[j], ranks[j - 1]);
+		}
+	}
+}
+
+//sorts both sides strongest first and names the stronger side first
+static void WriteCanonicalTablebaseName(int* ranks, int numRanks, int* otherRanks, int numOtherRanks, char* outName)
+{
+	SortTablebaseRanks(ranks, numRanks);
+	SortTablebaseRanks(otherRanks, numOtherRanks);
+	if (IsFirstTablebaseSide(ranks, numRanks, otherRanks, numOtherRanks))
+	{
+		WriteTablebaseName(ranks, numRanks, otherRanks, numOtherRanks, outName);
+	}
+	else
+	{
+		WriteTablebaseName(otherRanks, numOtherRanks, ranks, numRanks, outName);
+	}
+}
+
+
+bool ChessTablebaseMaterial::SetFromName(const char* name)
+{
+	*this = ChessTablebaseMaterial();
+	size_t length = strlen(name);
+	if (length < 2 || length >= MAX_TABLEBASE_NAME_LENGTH || name[0] != 'K')
+	{
+		return false;
+	}
+	const char* secondKing = strchr(name + 1, 'K');
+	if (secondKing == nullptr)
+	{
+		return false;
+	}
+
+	m_types[0] = ChessPieceType::KING;
+	m_sides[0] = 0;
+	m_types[1] = ChessPieceType::KING;
+	m_sides[1] = 1;
+	m_numPieces = 2;
+	for (const char* letter = name + 1; *letter != '\0'; letter++)
+	{
+		if (letter == secondKing)
+		{
+			continue;
+		}
+		const char* found = (const char*)memchr(TABLEBASE_PIECE_LETTERS, *letter, sizeof(TABLEBASE_PIECE_LETTERS));
+		if (found == nullptr || m_numPieces >= MAX_TABLEBASE_PIECES)
+		{
+			*this = ChessTablebaseMaterial();
+			return false;
+		}
+		m_types[m_numPieces] = TABLEBASE_PIECE_ORDER[found - TABLEBASE_PIECE_LETTERS];
+		m_sides[m_numPieces] = letter < secondKing ? 0 : 1;
+		m_hasPawns = m_hasPawns || m_types[m_numPieces] == ChessPieceType::PAWN;
+		m_numPieces++;
+	}
+	memcpy(m_name, name, length + 1);
+	return true;
+}
+
+size_t ChessTablebaseMaterial::GetNumEntries() const
+{
+	size_t numEntries = (size_t)NUM_CHESS_PLAYERS * GetNumKingSquares(m_hasPawns);
+	for (int i = 1; i < m_numPieces; i++)
+	{
+		numEntries *= NUM_BOARD_SQUARES;
+	}
+	return numEntries;
+}
+
+size_t ChessTablebaseMaterial::GetIndex(int const* squares, int sideToMove) const
+{
+	int flip = 0;
+	if (GetFileForSquare(squares[0]) > 3)
+	{
+		flip ^= 7;
+	}
+	if (!m_hasPawns && GetRankForSquare(squares[0]) > 3)
+	{
+		flip ^= 56;
+	}
+
+	int kingSquare = squares[0] ^ flip;
+	size_t index = (size_t)sideToMove * GetNumKingSquares(m_hasPawns) + GetRankForSquare(kingSquare) * 4 + GetFileForSquare(kingSquare);
+	for (int i = 1; i < m_numPieces; i++)
+	{
+		index = index * NUM_BOARD_SQUARES + (size_t)(squares[i] ^ flip);
+	}
+	return index;
+}
+
+void ChessTablebaseMaterial::GetSquaresForIndex(size_t index, int* outSquares, int& outSideToMove) const
+{
+	for (int i = m_numPieces - 1; i >= 1; i--)
+	{
+		outSquares[i] = (int)(index % NUM_BOARD_SQUARES);
+		index /= NUM_BOARD_SQUARES;
+	}
+	int numKingSquares = GetNumKingSquares(m_hasPawns);
+	int kingIndex = (int)(index % numKingSquares);
+	outSquares[0] = GetSquareForFileAndRank(kingIndex % 4, kingIndex / 4);
+	outSideToMove = (int)(index / numKingSquares);
+}
+
+
+bool GetTablebaseKeyForPosition(ChessPosition const& position, char* outName, int* outSquares, int& outSideToMove)
+{
+	if (GetNumSetBits(position.GetOccupied()) > MAX_TABLEBASE_PIECES)
+	{
+		return false;
+	}
+
+	//each player's pieces other than the king, strongest first
+	int ranks[NUM_CHESS_PLAYERS][MAX_TABLEBASE_PIECES] = {};
+	int squares[NUM_CHESS_PLAYERS][MAX_TABLEBASE_PIECES] = {};
+	int numPieces[NUM_CHESS_PLAYERS] = {};
+	for (int player = 0; player < NUM_CHESS_PLAYERS; player++)
+	{
+		if (position.GetKingSquare(player) == NO_SQUARE)
+		{
+			return false;
+		}
+		for (int rank = 0; rank < 5; rank++)
+		{
+			Bitboard pieces = position.GetPieces(player, TABLEBASE_PIECE_ORDER[rank]);
+			while (pieces != EMPTY_BITBOARD)
+			{
+				ranks[player][numPieces[player]] = rank;
+				squares[player][numPieces[player]] = PopLowestSquare(pieces);
+				numPieces[player]++;
+			}
+		}
+	}
+
+	int firstPlayer = IsFirstTablebaseSide(ranks[0], numPieces[0], ranks[1], numPieces[1]) ? 0 : 1;
+	int secondPlayer = 1 - firstPlayer;
+	//the named first side is always indexed as player 0
+	int flip = firstPlayer == 0 ? 0 : 56;
+	WriteTablebaseName(ranks[firstPlayer], numPieces[firstPlayer], ranks[secondPlayer], numPieces[secondPlayer], outName);
+
+	int numSquares = 0;
+	outSquares[numSquares++] = position.GetKingSquare(firstPlayer) ^ flip;
+	outSquares[numSquares++] = position.GetKingSquare(secondPlayer) ^ flip;
+	for (int i = 0; i < numPieces[firstPlayer]; i++)
+	{
+		outSquares[numSquares++] = squares[firstPlayer][i] ^ flip;
+	}
+	for (int i = 0; i < numPieces[secondPlayer]; i++)
+	{
+		outSquares[numSquares++] = squares[secondPlayer][i] ^ flip;
+	}
+	outSideToMove = position.GetPlayerToMove() == firstPlayer ? 0 : 1;
+	return true;
+}
+
+void GetAllTablebaseNames(std::vector<std::string>& outNames)
+{
+	//captures lead to fewer pieces and promotions to fewer pawns, so sorting by both puts every dependency first
+	struct NamedMaterial
+	{
+		std::string m_name;
+		int m_numPieces = 0;
+		int m_numPawns = 0;
+	};
+	std::vector<NamedMaterial> materials;
+	char name[MAX_TABLEBASE_NAME_LENGTH] = {};
+	for (int first = 0; first < 5; first++)
+	{
+		WriteTablebaseName(&first, 1, nullptr, 0, name);
+		materials.push_back({ name, 3, first == 4 ? 1 : 0 });
+		for (int second = first; second < 5; second++)
+		{
+			int ranks[2] = { first, second };
+			WriteTablebaseName(ranks, 2, nullptr, 0, name);
+			materials.push_back({ name, 4, (first == 4 ? 1 : 0) + (second == 4 ? 1 : 0) });
+			WriteTablebaseName(&first, 1, &second, 1, name);
+			materials.push_back({ name, 4, (first == 4 ? 1 : 0) + (second == 4 ? 1 : 0) });
+		}
+	}
+	std::stable_sort(materials.begin(), materials.end(), [](NamedMaterial const& a, NamedMaterial const& b)
+		{
+			return a.m_numPieces != b.m_numPieces ? a.m_numPieces < b.m_numPieces : a.m_numPawns < b.m_numPawns;
+		});
+
+	outNames.clear();
+	for (NamedMaterial const& material : materials)
+	{
+		outNames.push_back(material.m_name);
+	}
+}
+
+void GetTablebaseDependencies(ChessTablebaseMaterial const& material, std::vector<std::string>& outNames)
+{
+	outNames.clear();
+	auto addMaterial = [&material, &outNames](int skippedPiece, int promotedPiece, ChessPieceType promotionType)
+		{
+			int ranks[NUM_CHESS_PLAYERS][MAX_TABLEBASE_PIECES] = {};
+			int numRanks[NUM_CHESS_PLAYERS] = {};
+			for (int i = 2; i < material.m_numPieces; i++)
+			{
+				if (i != skippedPiece)
+				{
+					int side = material.m_sides[i];
+					ranks[side][numRanks[side]++] = GetTablebasePieceRank(i == promotedPiece ? promotionType : material.m_types[i]);
+				}
+			}
+			char name[MAX_TABLEBASE_NAME_LENGTH] = {};
+			WriteCanonicalTablebaseName(ranks[0], numRanks[0], ranks[1], numRanks[1], name);
+			if (strcmp(name, "KK") != 0 && std::find(outNames.begin(), outNames.end(), name) == outNames.end())
+			{
+				outNames.push_back(name);
+			}
+		};
+
+	for (int i = 2; i < material.m_numPieces; i++)
+	{
+		addMaterial(i, -1, ChessPieceType::NONE);
+		if (material.m_types[i] == ChessPieceType::PAWN)
+		{
+			for (ChessPieceType promotionType : ChessMove::PROMOTION_TYPES)
+			{
+				addMaterial(-1, i, promotionType);
+			}
+		}
+	}
+}
+
+
+bool ChessTablebase::Open(const char* filePath)
+{
+	m_ownedCodes.clear();
+	m_codes = nullptr;
+	//a search probes scattered positions, reading ahead would only load pages nobody asked for
+	if (!m_file.Open(filePath, true) || m_file.GetSize() < TABLEBASE_HEADER_SIZE)
+	{
+		m_file.Close();
+		return false;
+	}
+
+	unsigned char const* data = m_file.GetData();
+	char name[MAX_TABLEBASE_NAME_LENGTH + 1] = {};
+	memcpy(name, data + 4, MAX_TABLEBASE_NAME_LENGTH);
+	uint32_t numEntries = 0;
+	memcpy(&numEntries, data + 12, sizeof(numEntries));
+	bool isValid = memcmp(data, "CTB1", 4) == 0 && m_material.SetFromName(name)
+		&& numEntries == m_material.GetNumEntries() && m_file.GetSize() == TABLEBASE_HEADER_SIZE + (size_t)numEntries;
+	if (!isValid)
+	{
+		m_file.Close();
+		m_material = ChessTablebaseMaterial();
+		return false;
+	}
+	m_codes = data + TABLEBASE_HEADER_SIZE;
+	return true;
+}
+
+void ChessTablebase::SetCodes(ChessTablebaseMaterial const& material, std::vector<uint8_t>&& codes)
+{
+	m_file.Close();
+	m_material = material;
+	m_ownedCodes = std::move(codes);
+	m_codes = m_ownedCodes.data();
+}
+
+bool ChessTablebase::WriteFile(const char* filePath) const
+{
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	fopen_s(&file, filePath, "wb");
+#else
+	file = fopen(filePath, "wb");
+#endif
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	unsigned char header[TABLEBASE_HEADER_SIZE] = {};
+	memcpy(header, "CTB1", 4);
+	memcpy(header + 4, m_material.m_name, MAX_TABLEBASE_NAME_LENGTH);
+	uint32_t numEntries = (uint32_t)m_material.GetNumEntries();
+	memcpy(header + 12, &numEntries, sizeof(numEntries));
+	bool isWritten = fwrite(header, sizeof(header), 1, file) == 1 && fwrite(m_codes, 1, numEntries, file) == numEntries;
+	return fclose(file) == 0 && isWritten;
+}
+
+ChessTablebaseMaterial const& ChessTablebase::GetMaterial() const
+{
+	return m_material;
+}
+
+uint8_t ChessTablebase::GetCode(size_t index) const
+{
+	return m_codes[index];
+}
+
+
+int ChessTablebases::OpenDirectory(const char* directoryPath)
+{
+	std::vector<std::string> names;
+	GetAllTablebaseNames(names);
+	int numOpened = 0;
+	for (std::string const& name : names)
+	{
+		if (FindTable(name.c_str()) != nullptr)
+		{
+			continue;
+		}
+		std::unique_ptr<ChessTablebase> table = std::make_unique<ChessTablebase>();
+		std::string filePath = std::string(directoryPath) + "/" + name + ".ctb";
+		if (table->Open(filePath.c_str()))
+		{
+			AddTable(std::move(table));
+			numOpened++;
+		}
+	}
+	return numOpened;
+}
+
+void ChessTablebases::AddTable(std::unique_ptr<ChessTablebase> table)
+{
+	m_tables.push_back(std::move(table));
+}
+
+void ChessTablebases::Clear()
+{
+	m_tables.clear();
+}
+
+int ChessTablebases::GetNumTables() const
+{
+	return (int)m_tables.size();
+}
+
+ChessTablebase const* ChessTablebases::FindTable(const char* name) const
+{
+	for (auto const& table : m_tables)
+	{
+		if (strcmp(table->GetMaterial().m_name, name) == 0)
+		{
+			return table.get();
+		}
+	}
+	return nullptr;
+}
+
+bool ChessTablebases::Probe(ChessPosition const& position, ChessTablebaseResult& out) const
+{
+	if (GetNumSetBits(position.GetOccupied()) > MAX_TABLEBASE_PIECES || position.GetCastlingRights() != CASTLING_NONE)
+	{
+		return false;
+	}
+	int enPassantSquare = position.GetEnPassantSquare();
+	int playerToMove = position.GetPlayerToMove();
+	if (enPassantSquare != NO_SQUARE
+		&& (GetPawnAttacks(1 - playerToMove, enPassantSquare) & position.GetPieces(playerToMove, ChessPieceType::PAWN)) != EMPTY_BITBOARD)
+	{
+		return false;
+	}
+
+	char name[MAX_TABLEBASE_NAME_LENGTH] = {};
+	int squares[MAX_TABLEBASE_PIECES] = {};
+	int sideToMove = 0;
+	if (!GetTablebaseKeyForPosition(position, name, squares, sideToMove))
+	{
+		return false;
+	}
+	//two bare kings have no table
+	if (strcmp(name, "KK") == 0)
+	{
+		out = ChessTablebaseResult();
+		return true;
+	}
+	ChessTablebase const* table = FindTable(name);
+	if (table == nullptr)
+	{
+		return false;
+	}
+	uint8_t code = table->GetCode(table->GetMaterial().GetIndex(squares, sideToMove));
+	if (code == TABLEBASE_CODE_ILLEGAL)
+	{
+		return false;
+	}
+	out = GetTablebaseResultForCode(code);
+	return true;
+}
+
+bool ChessTablebases::GetBestMove(ChessPosition const& position, ChessMove& outMove, ChessTablebaseResult& outResult) const
+{
+	if (!Probe(position, outResult))
+	{
+		return false;
+	}
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+
+	//wins rank above draws above losses, then the fastest win or the slowest loss
+	outMove = ChessMove();
+	int bestRank = -1;
+	int bestPlies = 0;
+	ChessPosition child = position;
+	for (ChessMove move : moves)
+	{
+		ChessTablebaseResult childResult;
+		child.MakeMove(move);
+		bool isProbed = Probe(child, childResult);
+		child.UnmakeMove();
+		if (!isProbed)
+		{
+			return false;
+		}
+		int rank = 1 - childResult.m_wdl;
+		bool isBetter = rank > bestRank
+			|| (rank == bestRank && rank == 2 && childResult.m_pliesToMate < bestPlies)
+			|| (rank == bestRank && rank == 0 && childResult.m_pliesToMate > bestPlies);
+		if (isBetter)
+		{
+			outMove = move;
+			bestRank = rank;
+			bestPlies = childResult.m_pliesToMate;
+		}
+	}
+	return !outMove.IsNull();
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "Game/ChessMove.hpp"
+#include "Game/ChessPosition.hpp"
+#include "Game/ChessMappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//endgame tablebases for up to four pieces (kings included), built offline by ChessTablebaseGen.
+//a table covers one material split, named strongest side first ("KRKP": king and rook against king and pawn),
+//and holds one byte per position: win or loss with the plies to mate for the player to move, or draw.
+//the stronger side is always indexed as player 0 (positions where player 1 has it are flipped), its king is mirrored
+//onto files a-d, and without pawns onto ranks 1-4 as well. castling rights, en passant and the fifty move rule
+//are not modelled: probes skip positions with a castling right or an en passant capture available
+//
+//file, little endian:
+//	char		magic[4] = "CTB1"
+//	char		name[8]					material name, zero padded
+//	uint32_t	numEntries				ChessTablebaseMaterial::GetNumEntries()
+//	uint8_t		codes[numEntries]		see GetTablebaseCodeForResult()
+
+constexpr int MAX_TABLEBASE_PIECES = 4;
+constexpr int MAX_TABLEBASE_NAME_LENGTH = 8;//"KQRKP" and the terminator fit
+constexpr int TABLEBASE_HEADER_SIZE = 16;
+constexpr int MAX_TABLEBASE_PLIES = 253;
+
+//0 draw, 255 impossible position, otherwise plies to mate + 1: odd codes lose, even codes win
+constexpr uint8_t TABLEBASE_CODE_DRAW = 0;
+constexpr uint8_t TABLEBASE_CODE_ILLEGAL = 255;
+
+
+struct ChessTablebaseResult
+{
+	int m_wdl = 0;//1 the player to move wins, 0 draw, -1 loses
+	int m_pliesToMate = 0;//with best play from both sides, 0 for draws and for a player already mated
+};
+
+constexpr uint8_t GetTablebaseCodeForResult(ChessTablebaseResult const& result)
+{
+	return result.m_wdl == 0 ? TABLEBASE_CODE_DRAW : (uint8_t)(result.m_pliesToMate + 1);
+}
+
+constexpr ChessTablebaseResult GetTablebaseResultForCode(uint8_t code)
+{
+	if (code == TABLEBASE_CODE_DRAW || code == TABLEBASE_CODE_ILLEGAL)
+	{
+		return ChessTablebaseResult();
+	}
+	ChessTablebaseResult result;
+	result.m_pliesToMate = code - 1;
+	result.m_wdl = (result.m_pliesToMate & 1) != 0 ? 1 : -1;
+	return result;
+}
+
+static_assert(GetTablebaseResultForCode(1).m_wdl == -1, "a mated player loses in 0 plies");
+static_assert(GetTablebaseResultForCode(GetTablebaseCodeForResult({ 1, 19 })).m_pliesToMate == 19, "codes round trip");
+
+
+//which pieces a table holds and how a placement of them maps onto an index
+struct ChessTablebaseMaterial
+{
+public:
+	bool SetFromName(const char* name);//false for malformed names and for more than MAX_TABLEBASE_PIECES pieces
+	size_t GetNumEntries()const;
+
+	//squares in m_types order with the named first side as player 0; the symmetry is applied here, squares may be any placement
+	size_t GetIndex(int const* squares, int sideToMove)const;
+	void GetSquaresForIndex(size_t index, int* outSquares, int& outSideToMove)const;
+
+public:
+	char m_name[MAX_TABLEBASE_NAME_LENGTH] = {};
+	int m_numPieces = 0;
+	//first side's king, second side's king, then the first side's pieces, then the second side's, strongest first
+	ChessPieceType m_types[MAX_TABLEBASE_PIECES] = {};
+	int m_sides[MAX_TABLEBASE_PIECES] = {};
+	bool m_hasPawns = false;
+};
+
+//the table a position belongs to: its material name, the squares in table order and the side to move,
+//with the colors swapped when player 1 is the named first side; false for more than MAX_TABLEBASE_PIECES pieces or a missing king
+bool GetTablebaseKeyForPosition(ChessPosition const& position, char* outName, int* outSquares, int& outSideToMove);
+//every material split the generator knows, in an order where a table only depends on tables before it
+void GetAllTablebaseNames(std::vector<std::string>& outNames);
+//the tables a capture or promotion in this one leads to, two bare kings left out
+void GetTablebaseDependencies(ChessTablebaseMaterial const& material, std::vector<std::string>& outNames);
+
+
+class ChessTablebase
+{
+public:
+	bool Open(const char* filePath);//mapped, false if missing, malformed or not sized for its material
+	void SetCodes(ChessTablebaseMaterial const& material, std::vector<uint8_t>&& codes);//a table built in memory
+	bool WriteFile(const char* filePath)const;
+
+	ChessTablebaseMaterial const& GetMaterial()const;
+	uint8_t GetCode(size_t index)const;
+
+private:
+	ChessTablebaseMaterial m_material;
+	ChessMappedFile m_file;
+	std::vector<uint8_t> m_ownedCodes;
+	uint8_t const* m_codes = nullptr;
+};
+
+
+//every table that could be opened, probing is read only and safe from any number of search threads
+class ChessTablebases
+{
+public:
+	int OpenDirectory(const char* directoryPath);//opens every known table found there, returns how many
+	void AddTable(std::unique_ptr<ChessTablebase> table);
+	void Clear();
+	int GetNumTables()const;
+	ChessTablebase const* FindTable(const char* name)const;
+
+	//false if the position has too many pieces, a castling right, an en passant capture or no table here
+	bool Probe(ChessPosition const& position, ChessTablebaseResult& out)const;
+	//the legal move that wins fastest, draws, or loses slowest; false if the position or a move's result cannot be probed
+	bool GetBestMove(ChessPosition const& position, ChessMove& outMove, ChessTablebaseResult& outResult)const;
+
+private:
+	std::vector<std::unique_ptr<ChessTablebase>> m_tables;
+};
@@ -0,0 +1,307 @@
+#include "Game/ChessTranspositionTable.hpp"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <malloc.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+
+//bits 0-15 move, 16-31 score, 32-39 depth, 40-41 bound, 42-47 generation
+constexpr int DATA_DEPTH_SHIFT = 32;
+constexpr int DATA_BOUND_SHIFT = 40;
+constexpr int DATA_GENERATION_SHIFT = 42;
+constexpr int GENERATION_MASK = 63;
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+constexpr int NUM_HASHFULL_SAMPLE_BUCKETS = 1000;
+
+
+static int GetDepthForData(uint64_t data) { return (int)((data >> DATA_DEPTH_SHIFT) & 0xFF); }
+static int GetBoundForData(uint64_t data) { return (int)((data >> DATA_BOUND_SHIFT) & 3); }
+static int GetGenerationForData(uint64_t data) { return (int)((data >> DATA_GENERATION_SHIFT) & GENERATION_MASK); }
+
+//maps the key onto [0, range) with the high bits of a 128 bit product, so range does not have to be a power of two
+static uint64_t GetHighProduct(uint64_t key, uint64_t range)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	return __umulh(key, range);
+#elif defined(__SIZEOF_INT128__)
+	return (uint64_t)(((unsigned __int128)key * range) >> 64);
+#else
+	uint64_t keyLow = key & 0xFFFFFFFFULL;
+	uint64_t keyHigh = key >> 32;
+	uint64_t rangeLow = range & 0xFFFFFFFFULL;
+	uint64_t rangeHigh = range >> 32;
+	uint64_t middle = keyHigh * rangeLow + ((keyLow * rangeLow) >> 32);
+	uint64_t middleLow = (middle & 0xFFFFFFFFULL) + keyLow * rangeHigh;
+	return keyHigh * rangeHigh + (middle >> 32) + (middleLow >> 32);
+#endif
+}
+
+
+ChessTranspositionTable::ChessTranspositionTable()
+{
+}
+
+ChessTranspositionTable::~ChessTranspositionTable()
+{
+	Free();
+}
+
+void ChessTranspositionTable::Resize(int sizeInMB, bool isUsingHugePages)
+{
+	sizeInMB = sizeInMB < 1 ? 1 : (sizeInMB > MAX_SIZE_MB ? MAX_SIZE_MB : sizeInMB);
+	if (m_buckets != nullptr && sizeInMB == m_sizeInMB && isUsingHugePages == m_isUsingHugePages)
+	{
+		Clear();
+		return;
+	}
+	Free();
+
+	size_t numBytes = (size_t)sizeInMB << 20;
+	void* memory = nullptr;
+#if defined(__linux__)
+	if (isUsingHugePages)
+	{
+		//explicit huge pages only exist if the administrator reserved some (vm.nr_hugepages), fall back quietly otherwise
+		numBytes = (numBytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		memory = mmap(nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (memory != MAP_FAILED)
+		{
+			m_isMemoryMapped = true;
+		}
+		else
+		{
+			//the kernel can only back a 2 MB aligned range with transparent huge pages
+			memory = std::aligned_alloc(HUGE_PAGE_SIZE, numBytes);
+			if (memory != nullptr)
+			{
+				madvise(memory, numBytes, MADV_HUGEPAGE);
+			}
+		}
+	}
+#endif
+	if (memory == nullptr)
+	{
+#if defined(_MSC_VER)
+		memory = _aligned_malloc(numBytes, alignof(Bucket));
+#else
+		memory = std::aligned_alloc(alignof(Bucket), numBytes);
+#endif
+	}
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	m_numAllocatedBytes = numBytes;
+	m_numBuckets = numBytes / sizeof(Bucket);
+	m_buckets = static_cast<Bucket*>(memory);
+	for (size_t i = 0; i < m_numBuckets; i++)
+	{
+		new (&m_buckets[i]) Bucket();
+	}
+	m_sizeInMB = sizeInMB;
+	m_isUsingHugePages = isUsingHugePages;
+	m_generation = 0;
+}
+
+void ChessTranspositionTable::Clear()
+{
+	for (size_t i = 0; i < m_numBuckets; i++)
+	{
+		for (Entry& entry : m_buckets[i].m_entries)
+		{
+			entry.m_keyXorData.store(0, std::memory_order_relaxed);
+			entry.m_data.store(0, std::memory_order_relaxed);
+		}
+	}
+	m_generation = 0;
+}
+
+void ChessTranspositionTable::NewSearch()
+{
+	m_generation = (m_generation + 1) & GENERATION_MASK;
+}
+
+bool ChessTranspositionTable::Probe(uint64_t key, ChessTTProbeResult& out)
+{
+	if (m_buckets == nullptr)
+	{
+		return false;
+	}
+	for (Entry& entry : GetBucketForKey(key).m_entries)
+	{
+		uint64_t data = entry.m_data.load(std::memory_order_relaxed);
+		uint64_t keyXorData = entry.m_keyXorData.load(std::memory_order_relaxed);
+		if ((keyXorData ^ data) != key || GetBoundForData(data) == BOUND_NONE)
+		{
+			continue;
+		}
+
+		//still in use, so it should not be the first to go in this search
+		if (GetGenerationForData(data) != m_generation)
+		{
+			uint64_t refreshedData = (data & ~((uint64_t)GENERATION_MASK << DATA_GENERATION_SHIFT)) | ((uint64_t)m_generation << DATA_GENERATION_SHIFT);
+			entry.m_keyXorData.store(key ^ refreshedData, std::memory_order_relaxed);
+			entry.m_data.store(refreshedData, std::memory_order_relaxed);
+		}
+
+		out.m_move.m_data = (unsigned short)(data & 0xFFFF);
+		out.m_score = (int)(short)((data >> 16) & 0xFFFF);
+		out.m_depth = GetDepthForData(data);
+		out.m_bound = GetBoundForData(data);
+		return true;
+	}
+	return false;
+}
+
+void ChessTranspositionTable::Store(uint64_t key, ChessMove move, int score, int depth, int bound)
+{
+	if (m_buckets == nullptr)
+	{
+		return;
+	}
+
+	//the key's own entry if it has one, otherwise an empty one, otherwise the least worth keeping:
+	//every search of age counts as much as 8 plies of depth
+	Entry* replacedEntry = nullptr;
+	uint64_t replacedData = 0;
+	bool isSameKey = false;
+	int lowestWorth = 0;
+	for (Entry& entry : GetBucketForKey(key).m_entries)
+	{
+		uint64_t data = entry.m_data.load(std::memory_order_relaxed);
+		uint64_t keyXorData = entry.m_keyXorData.load(std::memory_order_relaxed);
+		if (GetBoundForData(data) == BOUND_NONE || (keyXorData ^ data) == key)
+		{
+			replacedEntry = &entry;
+			replacedData = data;
+			isSameKey = (keyXorData ^ data) == key && GetBoundForData(data) != BOUND_NONE;
+			break;
+		}
+		int age = (m_generation - GetGenerationForData(data)) & GENERATION_MASK;
+		int worth = GetDepthForData(data) - 8 * age;
+		if (replacedEntry == nullptr || worth < lowestWorth)
+		{
+			replacedEntry = &entry;
+			replacedData = data;
+			lowestWorth = worth;
+		}
+	}
+
+	if (isSameKey)
+	{
+		//a search that did not find a move here keeps the move an earlier search found
+		if (move.IsNull())
+		{
+			move.m_data = (unsigned short)(replacedData & 0xFFFF);
+		}
+		//a much deeper bound from this search is worth more than a shallow one on the same position
+		bool isOldEntryDeeper = GetDepthForData(replacedData) > depth + 3 && GetGenerationForData(replacedData) == m_generation;
+		if (isOldEntryDeeper && bound != BOUND_EXACT)
+		{
+			return;
+		}
+	}
+
+	depth = depth < 0 ? 0 : (depth > 255 ? 255 : depth);
+	uint64_t data = PackData(move, score, depth, bound, m_generation);
+	replacedEntry->m_keyXorData.store(key ^ data, std::memory_order_relaxed);
+	replacedEntry->m_data.store(data, std::memory_order_relaxed);
+}
+
+void ChessTranspositionTable::Prefetch(uint64_t key) const
+{
+	if (m_buckets == nullptr)
+	{
+		return;
+	}
+#if defined(_MSC_VER) || defined(__SSE__)
+	_mm_prefetch(reinterpret_cast<const char*>(&GetBucketForKey(key)), _MM_HINT_T0);
+#else
+	__builtin_prefetch(&GetBucketForKey(key));
+#endif
+}
+
+int ChessTranspositionTable::GetHashfull() const
+{
+	size_t numSampleBuckets = m_numBuckets < NUM_HASHFULL_SAMPLE_BUCKETS ? m_numBuckets : NUM_HASHFULL_SAMPLE_BUCKETS;
+	if (numSampleBuckets == 0)
+	{
+		return 0;
+	}
+	size_t numUsedEntries = 0;
+	for (size_t i = 0; i < numSampleBuckets; i++)
+	{
+		for (Entry const& entry : m_buckets[i].m_entries)
+		{
+			uint64_t data = entry.m_data.load(std::memory_order_relaxed);
+			if (GetBoundForData(data) != BOUND_NONE && GetGenerationForData(data) == m_generation)
+			{
+				numUsedEntries++;
+			}
+		}
+	}
+	return (int)(numUsedEntries * 1000 / (numSampleBuckets * NUM_ENTRIES_PER_BUCKET));
+}
+
+int ChessTranspositionTable::GetSizeInMB() const
+{
+	return m_sizeInMB;
+}
+
+bool ChessTranspositionTable::IsUsingHugePages() const
+{
+	return m_isUsingHugePages;
+}
+
+ChessTranspositionTable::Bucket& ChessTranspositionTable::GetBucketForKey(uint64_t key) const
+{
+	return m_buckets[GetHighProduct(key, m_numBuckets)];
+}
+
+void ChessTranspositionTable::Free()
+{
+	if (m_buckets == nullptr)
+	{
+		return;
+	}
+#if defined(__linux__)
+	if (m_isMemoryMapped)
+	{
+		munmap(m_buckets, m_numAllocatedBytes);
+	}
+	else
+	{
+		std::free(m_buckets);
+	}
+#elif defined(_MSC_VER)
+	_aligned_free(m_buckets);
+#else
+	std::free(m_buckets);
+#endif
+	m_buckets = nullptr;
+	m_numBuckets = 0;
+	m_numAllocatedBytes = 0;
+	m_isMemoryMapped = false;
+	m_sizeInMB = 0;
+}
+
+uint64_t ChessTranspositionTable::PackData(ChessMove move, int score, int depth, int bound, int generation)
+{
+	return (uint64_t)move.m_data
+		| ((uint64_t)(unsigned short)(short)score << 16)
+		| ((uint64_t)(depth & 0xFF) << DATA_DEPTH_SHIFT)
+		| ((uint64_t)(bound & 3) << DATA_BOUND_SHIFT)
+		| ((uint64_t)(generation & GENERATION_MASK) << DATA_GENERATION_SHIFT);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "Game/ChessMove.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+
+enum ChessBound : int
+{
+	BOUND_NONE = 0,
+	BOUND_UPPER = 1,//the score is at most this (failed low)
+	BOUND_LOWER = 2,//the score is at least this (failed high)
+	BOUND_EXACT = 3
+};
+
+struct ChessTTProbeResult
+{
+	ChessMove m_move;
+	int m_score = 0;
+	int m_depth = 0;
+	int m_bound = BOUND_NONE;
+};
+
+
+//search results by zobrist key, shared by every search thread without locks:
+//each entry keeps (key ^ data) next to data, an entry torn by two threads writing at once fails the key check
+//and reads as a miss instead of handing out another position's move;
+//entries come in buckets of one cache line, a new result replaces the shallowest or oldest entry of its bucket
+class ChessTranspositionTable
+{
+public:
+	ChessTranspositionTable();
+	~ChessTranspositionTable();
+
+	//any size in MB, not only powers of two; with isUsingHugePages Linux backs the table with 2 MB pages
+	//(explicit hugetlb pages if the system has some reserved, transparent huge pages otherwise), elsewhere the flag is ignored
+	//must not be called while a search is running
+	void Resize(int sizeInMB, bool isUsingHugePages = false);
+	void Clear();
+	void NewSearch();//ages every entry stored so far, they are replaced first from now on
+
+	bool Probe(uint64_t key, ChessTTProbeResult& out);
+	void Store(uint64_t key, ChessMove move, int score, int depth, int bound);//score must fit in 16 bits, depth in 8
+	void Prefetch(uint64_t key)const;//pulls the key's bucket into the cache ahead of the Probe()
+
+	int GetHashfull()const;//permille of the entries written by the current search, from a sample of the buckets
+	int GetSizeInMB()const;
+	bool IsUsingHugePages()const;
+
+public:
+	static constexpr int DEFAULT_SIZE_MB = 16;
+	static constexpr int MAX_SIZE_MB = 1 << 16;
+	static constexpr int NUM_ENTRIES_PER_BUCKET = 4;
+
+private:
+	struct Entry
+	{
+		std::atomic<uint64_t> m_keyXorData{ 0 };
+		std::atomic<uint64_t> m_data{ 0 };
+	};
+	struct alignas(64) Bucket
+	{
+		Entry m_entries[NUM_ENTRIES_PER_BUCKET];
+	};
+	static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+
+	Bucket& GetBucketForKey(uint64_t key)const;
+	void Free();
+	static uint64_t PackData(ChessMove move, int score, int depth, int bound, int generation);
+
+private:
+	Bucket* m_buckets = nullptr;
+	size_t m_numBuckets = 0;
+	size_t m_numAllocatedBytes = 0;
+	bool m_isMemoryMapped = false;//from mmap rather than the aligned heap
+	bool m_isUsingHugePages = false;
+	int m_sizeInMB = 0;
+	int m_generation = 0;//6 bits, wraps around
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include "Game/ChessCommon.hpp"
+
+
+//zobrist keys are generated at compile time from a fixed seed, so every build
+//(client, server and tools) gives the same position the same key
+struct ChessZobristKeys
+{
+	uint64_t m_pieces[NUM_CHESS_PLAYERS][NUM_CHESS_PIECE_TYPES][NUM_BOARD_SQUARES] = {};
+	uint64_t m_castlingRights[CASTLING_ALL + 1] = {};//one key per combination, xor of the single right keys
+	uint64_t m_enPassantFiles[8] = {};
+	uint64_t m_player1ToMove = 0;
+};
+
+constexpr uint64_t GetNextZobristRandom(uint64_t& state)
+{
+	//splitmix64
+	state += 0x9E3779B97F4A7C15ULL;
+	uint64_t value = state;
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
+
+constexpr ChessZobristKeys MakeZobristKeys(uint64_t seed)
+{
+	ChessZobristKeys keys;
+	uint64_t state = seed;
+	for (int player = 0; player < NUM_CHESS_PLAYERS; player++)
+	{
+		for (int type = 0; type < NUM_CHESS_PIECE_TYPES; type++)
+		{
+			for (int square = 0; square < NUM_BOARD_SQUARES; square++)
+			{
+				keys.m_pieces[player][type][square] = GetNextZobristRandom(state);
+			}
+		}
+	}
+
+	uint64_t singleRightKeys[4] = {};
+	for (int i = 0; i < 4; i++)
+	{
+		singleRightKeys[i] = GetNextZobristRandom(state);
+	}
+	for (int rights = 0; rights <= CASTLING_ALL; rights++)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			if (rights & (1 << i))
+			{
+				keys.m_castlingRights[rights] ^= singleRightKeys[i];
+			}
+		}
+	}
+
+	for (int file = 0; file < 8; file++)
+	{
+		keys.m_enPassantFiles[file] = GetNextZobristRandom(state);
+	}
+	keys.m_player1ToMove = GetNextZobristRandom(state);
+	return keys;
+}
+
+inline constexpr ChessZobristKeys ZOBRIST_KEYS = MakeZobristKeys(0x43484553533344ULL);
+
+static_assert(ZOBRIST_KEYS.m_castlingRights[CASTLING_NONE] == 0, "no castling rights must not change the key");
+static_assert(ZOBRIST_KEYS.m_pieces[0][0][0] != ZOBRIST_KEYS.m_pieces[0][0][1], "zobrist keys must differ");
@@ -19,10 +19,8 @@
 
 
 #include <map>
+#include <cstdlib>
 
-bool Game::s_isPlayingRemotely = false;
-bool Game::s_myPlayerIndex = false;
-bool Game::s_isSpectator = false;
 float Game::s_SFXVolume = 1.f;
 float Game::s_totalAssetNum = 31.f;
 
@@ -130,7 +128,7 @@ void Game::Startup()
 	}
 	else {
 		Event_ChessConnect(args);
-		s_myPlayerIndex = true;
+		GetNetworkContext().m_myPlayerIndex = true;
 	}*/
 
 	
@@ -150,7 +148,7 @@ void Game::Update()
 	m_spotLights[1].c_lightFwdNormal = (Vec3(cosTime, sinTime, -1)).GetNormalized();
 	//m_spotLights[1].c_lightColor = Vec4(cosTime, sinTime, cosTime * sinTime, 1);
 
-	Game::s_isPlayingRemotely = g_theNetwork->IsConnected();
+	GetNetworkContext().m_isPlayingRemotely = g_theNetwork->IsConnected();
 
 	if (g_isAssetLoadingCompleted && !m_areAllModelsLoaded)
 	{
@@ -176,7 +174,7 @@ void Game::Update()
 
 		//update entities
 		UpdateEntities();
-		
+		UpdateAIPlayer();
 	}
 	//camera should update last
 	UpdateCameras();
@@ -543,6 +541,9 @@ void Game::StartMatch()
 {
 	
 	m_currentMatch = new ChessMatch(this, m_currentPlayerIndex);
+	m_currentMatch->SetNetworkRole(m_nextMatchContext.m_isPlayingRemotely, m_nextMatchContext.m_myPlayerIndex, m_nextMatchContext.m_isSpectator);
+	m_currentMatch->SetTurnChangeCallback(OnMatchTurnChange);
+	m_currentPlayerIndex = (int)m_currentMatch->GetIsPlayer1Turn();//a FEN default board state decides who moves first
 	PrintMatchOnlineStateBasedOnNetworkState();
 	SetPosAndOrientationForPlayerTurn();
 	m_currentMatch->InitPiecesToMatchBoardState(m_players[0],m_players[1]);
@@ -558,13 +559,53 @@ void Game::ResetMatch()
 	m_gameClock->SetTimeScale(1.0);
 	m_gameClock->Reset();
 
-	ChessMatch::ResetMatchData();
-
+	m_aiPlayer.Cancel();
+	if (m_currentMatch != nullptr)
+	{//the connection outlives the match, the next one starts with the same role
+		MatchContext const& endedContext = m_currentMatch->GetContext();
+		m_nextMatchContext.m_isPlayingRemotely = endedContext.m_isPlayingRemotely;
+		m_nextMatchContext.m_myPlayerIndex = endedContext.m_myPlayerIndex;
+		m_nextMatchContext.m_isSpectator = endedContext.m_isSpectator;
+	}
 	delete m_currentMatch;
 	m_currentMatch = nullptr;
 
 }
 
+void Game::SetPlayerName(int playerIndex, std::string const& name)
+{
+	m_players[playerIndex].m_playerName = name;
+	if (m_currentMatch != nullptr)
+	{
+		m_currentMatch->SetPlayerName(playerIndex, name);
+	}
+}
+
+MatchContext& Game::GetNetworkContext()
+{
+	return m_currentMatch != nullptr ? m_currentMatch->GetContext() : m_nextMatchContext;
+}
+
+void Game::OnMatchTurnChange(ChessMatch& match)
+{
+	//matches reached by matchID are not the one on screen
+	if (&match == App::s_theGame->m_currentMatch)
+	{
+		App::s_theGame->HandleTurnChange();
+	}
+}
+
+void Game::UpdateAIPlayer()
+{
+	bool isAITurn = false;
+	if (m_currentMatch != nullptr && !m_currentMatch->IsMatchFinished())
+	{
+		int playerIndex = (int)m_currentMatch->GetIsPlayer1Turn();
+		isAITurn = m_aiPlayer.IsPlayingForPlayer(playerIndex) && m_currentMatch->IsLocalPlayerTurn();
+	}
+	m_aiPlayer.Update(m_currentMatch, isAITurn);
+}
+
 void Game::EnterState(GameState state)
 {
 	if (state == GameState::ATTRACT)
@@ -617,7 +658,7 @@ void Game::PrintMatchOnlineStateBasedOnNetworkState()
 	{
 		return;
 	}
-	std::string onoffline = Game::s_isPlayingRemotely ? "online" : "offline";
+	std::string onoffline = m_currentMatch->GetContext().m_isPlayingRemotely ? "online" : "offline";
 	std::string infoStr = Stringf("Starting the match in %s mode...", onoffline.c_str());
 	PrintInfoMsgToConsole(infoStr);
 }
@@ -679,6 +720,34 @@ void Game::LoadFromGameConfig()
 
 	m_musicVolume = ParseXmlAttribute(*rootElement, "globalVolume", 1.f);
 	m_defaultBoardState = ParseXmlAttribute(*rootElement, "defaultBoardState", "RNBQKBNRPPPPPPPP................................pppppppprnbqkbnr");
+
+	//computer players
+	m_aiPlayer.SetIsPlayingForPlayer(0, ParseXmlAttribute(*rootElement, "aiPlayer0", false));
+	m_aiPlayer.SetIsPlayingForPlayer(1, ParseXmlAttribute(*rootElement, "aiPlayer1", false));
+	ChessSearchLimits aiLimits;
+	aiLimits.m_maxDepth = ParseXmlAttribute(*rootElement, "aiSearchDepth", MAX_SEARCH_DEPTH);
+	aiLimits.m_maxNodes = (uint64_t)ParseXmlAttribute(*rootElement, "aiSearchNodes", 0);
+	aiLimits.m_maxMilliseconds = ParseXmlAttribute(*rootElement, "aiSearchMilliseconds", 1000);
+	m_aiPlayer.SetSearchLimits(aiLimits);
+	m_aiPlayer.SetNumSearchThreads(ParseXmlAttribute(*rootElement, "aiSearchThreads", 1));
+	m_aiPlayer.SetTranspositionTableSize(ParseXmlAttribute(*rootElement, "aiHashMB", ChessTranspositionTable::DEFAULT_SIZE_MB),
+		ParseXmlAttribute(*rootElement, "aiHugePages", false));
+	std::string aiNetworkFile = ParseXmlAttribute(*rootElement, "aiNetworkFile", "");
+	if (!aiNetworkFile.empty() && !m_aiPlayer.LoadEvaluationNetwork(aiNetworkFile.c_str()))
+	{
+		PrintErrorMsgToConsole(Stringf("Error: could not load aiNetworkFile %s, the AI evaluates with piece-square tables", aiNetworkFile.c_str()));
+	}
+	std::string aiBookFile = ParseXmlAttribute(*rootElement, "aiBookFile", "");
+	if (!m_aiPlayer.LoadOpeningBook(aiBookFile.c_str()))
+	{
+		PrintErrorMsgToConsole(Stringf("Error: could not open aiBookFile %s, the AI searches every move", aiBookFile.c_str()));
+	}
+	std::string aiTablebaseDirectory = ParseXmlAttribute(*rootElement, "aiTablebaseDirectory", "");
+	if (!aiTablebaseDirectory.empty())
+	{
+		int numTablebases = m_aiPlayer.LoadTablebases(aiTablebaseDirectory.c_str());
+		PrintInfoMsgToConsole(Stringf("AI: %d endgame tablebases in %s", numTablebases, aiTablebaseDirectory.c_str()));
+	}
 	
 	std::string texturePath = "Data/Images/";
 	std::string boardDT = ParseXmlAttribute(*rootElement, "chessBoardDiffuseTexture", "?");
@@ -755,7 +824,7 @@ void Game::CheckInput()
 	if (m_currentState == GameState::ATTRACT) {
 		
 		if (g_theInput->WasKeyJustPressed('N') || g_theInput->WasKeyJustPressed(' ')|| controller.IsButtonDown(XBOX_BUTTON_A) || controller.IsButtonDown(XBOX_BUTTON_START)) {
-			if (s_isPlayingRemotely)
+			if (GetNetworkContext().m_isPlayingRemotely)
 			{
 				EventArgs args;
 				Event_ChessBegin(args);
@@ -785,7 +854,7 @@ void Game::CheckInput()
 	else if (m_currentState == GameState::PLAYING || m_currentState == GameState::GAMEOVER) {
 		//if pressing esc, goes back to attract mode
 		if (g_theInput->WasKeyJustPressed(KEYCODE_ESC) || controller.WasButtonJustPressed(XBOX_BUTTON_BACK)) {
-			if (s_isPlayingRemotely)
+			if (GetNetworkContext().m_isPlayingRemotely)
 			{
 				EventArgs args;
 				args.SetValue("reason", "quitting_match");
@@ -1075,6 +1144,14 @@ void Game::PrintBoardStateToConsole()
 
 
 	std::string boardCurrentLayout = m_currentMatch == nullptr ? m_defaultBoardState : m_currentMatch->GetBoardStateAsString();
+	if (m_currentMatch == nullptr && boardCurrentLayout.find('/') != std::string::npos)
+	{//the default board state is a FEN
+		ChessPosition defaultPosition;
+		defaultPosition.SetFromFEN(boardCurrentLayout.c_str());
+		char layout[64];
+		defaultPosition.WriteBoardState(layout);
+		boardCurrentLayout.assign(layout, 64);
+	}
 	std::string boardLayoutByLine;
 	int rowNum = 0;
 	for (int i = 7; i > -1; i--) {
@@ -1086,6 +1163,10 @@ void Game::PrintBoardStateToConsole()
 
 	boardState.push_back(columnLabel2);
 	boardState.push_back(columnLabel1);
+	if (m_currentMatch != nullptr)
+	{
+		boardState.push_back(Stringf("FEN: %s", m_currentMatch->GetFEN().c_str()));
+	}
 
 	Rgba8 color(120,160,200);
 	g_theDevConsole->AddParagraph(color, boardState);
@@ -1545,16 +1626,17 @@ void Game::ToggleCameraMode()
 
 void Game::SetPosAndOrientationForPlayerTurn()
 {
+	MatchContext const& networkContext = GetNetworkContext();
 	if (m_currentState == GameState::ATTRACT)
 	{
-		if (Game::s_isPlayingRemotely)//if playing online, locked to my player index view
+		if (networkContext.m_isPlayingRemotely)//if playing online, locked to my player index view
 		{
-			if (s_myPlayerIndex == 0)
+			if (networkContext.m_myPlayerIndex == 0)
 			{
 				m_worldCamera.SetPosition(m_defaultPlayer0CamPos);
 				m_worldCamera.SetOrientation(m_defaultPlayer0CamOri);
 			}
-			else if (s_myPlayerIndex == 1)
+			else if (networkContext.m_myPlayerIndex == 1)
 			{
 				m_worldCamera.SetPosition(m_defaultPlayer1CamPos);
 				m_worldCamera.SetOrientation(m_defaultPlayer1CamOri);
@@ -1570,7 +1652,7 @@ void Game::SetPosAndOrientationForPlayerTurn()
 	}
 	else if (m_currentState == GameState::PLAYING)
 	{
-		if (Game::s_isPlayingRemotely && !Game::s_isSpectator)//if playing online, locked to my player index view
+		if (networkContext.m_isPlayingRemotely && !networkContext.m_isSpectator)//if playing online, locked to my player index view
 		{
 			return;
 		}
@@ -1678,6 +1760,17 @@ void Game::SubscribeToLocalCommands()
 	argsChessConnect.SetValue("port", "3100");
 	g_theEventSystem->SubscribeEventCallbackFunction("ChessConnect", Event_ChessConnect, argsChessConnect);
 
+	//ChessBenchmark [iterations=<count>]
+	EventArgs argsChessBenchmark;
+	argsChessBenchmark.SetValue("iterations", "1000");
+	g_theEventSystem->SubscribeEventCallbackFunction("ChessBenchmark", ChessMatch::Event_ChessBenchmark, argsChessBenchmark);
+
+	//ChessReplay moves=<e2e4,e7e5,...> [matchID=<id>]
+	g_theEventSystem->SubscribeEventCallbackFunction("ChessReplay", ChessMatch::Event_ChessReplay);
+
+	//ChessAI player=<0|1> [enable=true] [depth=<n>] [nodes=<n>] [ms=<milliseconds>]
+	g_theEventSystem->SubscribeEventCallbackFunction("ChessAI", Event_ChessAI);
+
 	//RemoteCmd cmd=<commandName> [<key1>=<value1>] [key2=<value2>]
 	g_theEventSystem->SubscribeEventCallbackFunction("RemoteCmd", Event_RemoteCmd);
 }
@@ -1687,6 +1780,9 @@ void Game::UnsubscribeToLocalCommands()
 	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessServerInfo", Event_ChessServerInfo);
 	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessListen", Event_ChessListen);
 	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessConnect", Event_ChessConnect);
+	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessBenchmark", ChessMatch::Event_ChessBenchmark);
+	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessReplay", ChessMatch::Event_ChessReplay);
+	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessAI", Event_ChessAI);
 	g_theEventSystem->UnsubscribeEventCallbackFunction("RemoteCmd", Event_RemoteCmd);
 }
 
@@ -1824,7 +1920,8 @@ bool Game::Event_ChessListen(EventArgs& args)
 	std::string tempPort = args.GetValue("port", "");
 	unsigned short prevPort = g_theNetwork->GetCurrentListeningPort();
 	unsigned short portNum = tempPort == "" ? prevPort : (unsigned short)std::stoi(tempPort);
-	s_isSpectator = false;
+	MatchContext& networkContext = App::s_theGame->GetNetworkContext();
+	networkContext.m_isSpectator = false;
 
 	if (!g_theNetwork->IsServerListeningPortValid(portNum))
 	{//if input port is not valid
@@ -1879,7 +1976,7 @@ bool Game::Event_ChessListen(EventArgs& args)
 	}
 
 	}
-	s_myPlayerIndex = false;
+	networkContext.m_myPlayerIndex = false;
 
 
 	return true;
@@ -1951,10 +2048,11 @@ bool Game::Event_ChessConnect(EventArgs& args)
 		return false;
 	}
 
-	s_isSpectator = spectatorValidation == 1;
+	MatchContext& networkContext = App::s_theGame->GetNetworkContext();
+	networkContext.m_isSpectator = spectatorValidation == 1;
 
 	std::string infoMsg = Stringf("ChessConnect: Trying to connect to IP address %s at port %d", tempIP.c_str(), portNum);
-	if (s_isSpectator)
+	if (networkContext.m_isSpectator)
 	{
 		infoMsg.append(" as spectator");
 	}
@@ -1993,8 +2091,44 @@ bool Game::Event_ChessConnect(EventArgs& args)
 	}
 
 	}
-	s_myPlayerIndex = true;
+	networkContext.m_myPlayerIndex = true;
+
+	return true;
+}
+
+/* [local] ChessAI player=<0|1> [enable=true] [depth=<n>] [nodes=<n>] [ms=<milliseconds>] [threads=<n>]
+Lets the computer play one side, depth/nodes/ms set the search limits of both sides (0 = no limit),
+threads the number of search threads
+a.	Example: ChessAI player=1 ms=500
+b.	Example: ChessAI player=1 enable=false
+*/
+bool Game::Event_ChessAI(EventArgs& args)
+{
+	int playerIndex = args.GetValue("player", -1);
+	if (playerIndex != 0 && playerIndex != 1)
+	{
+		PrintErrorMsgToConsole("Invalid player args, Correct format: ChessAI player=1 [enable=true] [depth=<n>] [nodes=<n>] [ms=<milliseconds>] [threads=<n>]");
+		return false;
+	}
+	std::string enable = args.GetValue("enable", "true");
+	if (enable != "true" && enable != "false")
+	{
+		PrintErrorMsgToConsole("Invalid enable args format, Correct format: enable=true");
+		return false;
+	}
+
+	ChessAIPlayer& aiPlayer = App::s_theGame->m_aiPlayer;
+	ChessSearchLimits limits = aiPlayer.GetSearchLimits();
+	limits.m_maxDepth = args.GetValue("depth", limits.m_maxDepth);
+	limits.m_maxNodes = (uint64_t)args.GetValue("nodes", (int)limits.m_maxNodes);
+	limits.m_maxMilliseconds = args.GetValue("ms", limits.m_maxMilliseconds);
+	aiPlayer.SetSearchLimits(limits);
+	aiPlayer.SetNumSearchThreads(args.GetValue("threads", aiPlayer.GetNumSearchThreads()));
+	aiPlayer.SetIsPlayingForPlayer(playerIndex, enable == "true");
 
+	PrintInfoMsgToConsole(Stringf("ChessAI: player %d is %s, depth %d, nodes %llu, %d ms, %d threads", playerIndex,
+		enable == "true" ? "played by the computer" : "played by a human", limits.m_maxDepth, (unsigned long long)limits.m_maxNodes,
+		limits.m_maxMilliseconds, aiPlayer.GetNumSearchThreads()));
 	return true;
 }
 
@@ -2089,7 +2223,7 @@ bool Game::Event_ChessDisconnect(EventArgs& args)
 			commandLine = Stringf("ChessDisconnect reason=%s remote=true", reason.c_str());
 			explanationMsg = Stringf("ChessDisconnect: Disconnecting with reason: %s", reason.c_str());
 		}
-		if (isEventSenderSpectator || s_isSpectator)
+		if (isEventSenderSpectator || App::s_theGame->GetNetworkContext().m_isSpectator)
 		{//if you append isSpectator=true at the end of Disconnect, or you isSpectator=true at the end of Connect
 			commandLine.append(" isSpectator=true");
 		}
@@ -2149,8 +2283,10 @@ bool Game::Event_ChessPlayerInfo(EventArgs& args)
 	bool isSentByMyself = remoteValidation == 0;
 
 	std::string explanationMsg("ChessPlayerInfo");
-	std::string myName = App::s_theGame->m_players[s_myPlayerIndex].m_playerName;
-	std::string opponentName = App::s_theGame->m_players[!s_myPlayerIndex].m_playerName;
+	MatchContext const& networkContext = App::s_theGame->GetNetworkContext();
+	int myPlayerIndex = (int)networkContext.m_myPlayerIndex;
+	std::string myName = App::s_theGame->m_players[myPlayerIndex].m_playerName;
+	std::string opponentName = App::s_theGame->m_players[1 - myPlayerIndex].m_playerName;
 
 	std::string commandLine = Stringf("ChessPlayerInfo name=%s", playerName.c_str());
 
@@ -2166,7 +2302,7 @@ bool Game::Event_ChessPlayerInfo(EventArgs& args)
 				PrintErrorMsgToConsole(errorMsg);
 				return false;
 			}
-			App::s_theGame->m_players[s_myPlayerIndex].m_playerName = playerName;
+			App::s_theGame->SetPlayerName(myPlayerIndex, playerName);
 			myName = playerName;
 		}
 		else {//player name not input, defaulting to default
@@ -2175,7 +2311,7 @@ bool Game::Event_ChessPlayerInfo(EventArgs& args)
 			PrintWarningMsgToConsole(warningMsg);
 		}
 		commandLine = Stringf("ChessPlayerInfo name=%s", playerName.c_str());
-		if (!s_isSpectator) {
+		if (!networkContext.m_isSpectator) {
 			commandLine.append(" remote=true");
 			SetOutgoingData(commandLine);
 		}
@@ -2195,7 +2331,7 @@ bool Game::Event_ChessPlayerInfo(EventArgs& args)
 				PrintErrorMsgToConsole(errorMsg);
 				return false;
 			}
-			App::s_theGame->m_players[!s_myPlayerIndex].m_playerName = playerName;
+			App::s_theGame->SetPlayerName(1 - myPlayerIndex, playerName);
 			opponentName = playerName;
 		}
 		else {//player name cannot be null
@@ -2241,17 +2377,19 @@ bool Game::Event_ChessBegin(EventArgs& args)
 	}
 	bool isSentByMyself = remoteValidation == 0;
 
-	std::string myName = App::s_theGame->m_players[s_myPlayerIndex].m_playerName;
-	std::string opponentName = App::s_theGame->m_players[!s_myPlayerIndex].m_playerName;
+	MatchContext const& networkContext = App::s_theGame->GetNetworkContext();
+	int myPlayerIndex = (int)networkContext.m_myPlayerIndex;
+	std::string myName = App::s_theGame->m_players[myPlayerIndex].m_playerName;
+	std::string opponentName = App::s_theGame->m_players[1 - myPlayerIndex].m_playerName;
 	//match player name with player index
 	int startingPlayerIndex = -1;
 	if (firstPlayerName == "" || firstPlayerName == myName)//no param, defaulting to default player name
 	{
-		startingPlayerIndex = s_myPlayerIndex;
+		startingPlayerIndex = myPlayerIndex;
 		firstPlayerName = myName;
 	}else if (firstPlayerName == opponentName)
 	{
-		startingPlayerIndex = !s_myPlayerIndex;
+		startingPlayerIndex = 1 - myPlayerIndex;
 	}
 
 
@@ -2266,7 +2404,7 @@ bool Game::Event_ChessBegin(EventArgs& args)
 	if (isSentByMyself)
 	{
 		if (!SpectatorCheck("start a game", args.GetValue("fromServer", "")))return false;
-		if (!s_isSpectator)
+		if (!networkContext.m_isSpectator)
 		{
 			commandLine.append(" remote=true");
 			SetOutgoingData(commandLine);
@@ -2284,10 +2422,11 @@ bool Game::Event_ChessBegin(EventArgs& args)
 
 /* [remote] ChessValidate 
 [state=<gameState>] [player1=<playerName>] [player2=<playerName>] 
-[move=<moveNumber>] [board=<64characters>]: 
+[move=<moveNumber>] [board=<64characters>] [hash=<16 hex digits>]: 
 Validate the current state of the game, names and seats of the players, 
 current move number (starting with 0 before the opening move is made), 
 and the state of the entire board.  
+If hash= is present, the zobrist key of the position is compared instead of the board string.  
 Standard piece character abbreviations are used (see above). 
 If you receive this (remote=true) then validate each item against your own game state 
 	and, if any discontinuity is found:
@@ -2308,6 +2447,7 @@ bool Game::Event_ChessValidate(EventArgs& args)
 	std::string player2Name = args.GetValue("player2", "");
 	std::string moveNum = args.GetValue("move", "");
 	std::string boardAsAtring = args.GetValue("board", "");
+	std::string positionHash = args.GetValue("hash", "");
 
 	std::string isRemote = args.GetValue("remote", "");
 
@@ -2321,7 +2461,17 @@ bool Game::Event_ChessValidate(EventArgs& args)
 
 	
 
-	const ChessMatch* match = App::s_theGame->m_currentMatch;
+	//before any match starts there is nothing to route to, the states are then compared as GameOver
+	const ChessMatch* match = nullptr;
+	if (App::s_theGame->m_currentMatch != nullptr || args.GetValue("matchID", "") != "")
+	{
+		match = ChessMatch::GetMatchForEventArgs(args);
+		if (match == nullptr)
+		{
+			return false;
+		}
+	}
+	bool isSpectator = App::s_theGame->GetNetworkContext().m_isSpectator;
 
 	std::string currentGameStateLocal = match == nullptr? "GameOver" : match->GetGameStateAsString();
 	//if the game has not started
@@ -2344,7 +2494,7 @@ bool Game::Event_ChessValidate(EventArgs& args)
 		else {
 
 			if (!SpectatorCheck("validate a game", args.GetValue("fromServer", "")))return false;
-			if (s_isSpectator)return false;
+			if (isSpectator)return false;
 
 			if (gameState != "Player1Moving" && gameState != "Player2Moving" && gameState != "GameOver")
 			{
@@ -2362,20 +2512,24 @@ bool Game::Event_ChessValidate(EventArgs& args)
 
 
 	//if the game is started
-	std::string player1NameLocal = App::s_theGame->m_players[0].m_playerName;
-	std::string player2NameLocal = App::s_theGame->m_players[1].m_playerName;
+	std::string player1NameLocal = match->GetPlayerByIndex(0).m_playerName;
+	std::string player2NameLocal = match->GetPlayerByIndex(1).m_playerName;
 	int moveNumLocal = match->GetTurnNum();
-	std::string boardAsAtringLocal = match->GetBoardStateAsString();
+	uint64_t positionHashLocal = match->GetPositionHash();
 
 	int inputMoveNum = moveNum == "" ? moveNumLocal : std::stoi(moveNum);
 
 	if (isSentByOpponent)
 	{//if sent by the opponent, validate each with my data
+		//the hash is enough when the opponent sends one, the board string is only built for older clients
+		bool isBoardMatching = positionHash != ""
+			? strtoull(positionHash.c_str(), nullptr, 16) == positionHashLocal
+			: boardAsAtring == match->GetBoardStateAsString();
 		if (gameState != currentGameStateLocal 
 			|| player1Name != player1NameLocal 
 			|| player2Name != player2NameLocal 
 			|| inputMoveNum != moveNumLocal
-			|| boardAsAtring != boardAsAtringLocal)
+			|| !isBoardMatching)
 		{
 			PrintInfoMsgToConsole("ChessValidate: opponent just validated your state and does not match");
 			EventArgs argsWithReason;
@@ -2391,7 +2545,7 @@ bool Game::Event_ChessValidate(EventArgs& args)
 	else {//if any param is missing, fill it out for the user
 
 		if (!SpectatorCheck("validate a game", args.GetValue("fromServer", "")))return false;
-		if (s_isSpectator)return false;
+		if (match->GetContext().m_isSpectator)return false;
 		if (gameState != "Player1Moving" && gameState != "Player2Moving" && gameState != "GameOver")
 		{
 			std::string warningMsg = Stringf("Warning: ChessValidate invalid or missing gameState (Player1Moving/Player2Moving/GameOver). Defaulting to %s.", currentGameStateLocal.c_str());
@@ -2416,6 +2570,7 @@ bool Game::Event_ChessValidate(EventArgs& args)
 			PrintWarningMsgToConsole(warningMsg);
 			moveNum = std::to_string(moveNumLocal);
 		}
+		std::string boardAsAtringLocal = match->GetBoardStateAsString();
 		if (boardAsAtring != boardAsAtringLocal)
 		{
 			std::string warningMsg = Stringf("Warning: ChessValidate invalid or missing board. Defaulting to %s.", boardAsAtringLocal.c_str());
@@ -2425,8 +2580,8 @@ bool Game::Event_ChessValidate(EventArgs& args)
 
 		PrintInfoMsgToConsole("ChessValidate: validating opponent's state...");
 
-		std::string commandLine = Stringf("ChessValidate state=%s player1=%s player2=%s move=%s board=%s remote=true", 
-			gameState.c_str(), player1Name.c_str(), player2Name.c_str(), moveNum.c_str(), boardAsAtring.c_str());
+		std::string commandLine = Stringf("ChessValidate state=%s player1=%s player2=%s move=%s board=%s hash=%016llx remote=true", 
+			gameState.c_str(), player1Name.c_str(), player2Name.c_str(), moveNum.c_str(), boardAsAtring.c_str(), (unsigned long long)positionHashLocal);
 
 		SetOutgoingData(commandLine);
 
@@ -2468,6 +2623,11 @@ bool Game::Event_ChessMove(EventArgs& args)
 		return false;
 	}
 	bool isSentByMyself = remoteValidation == 0;
+	ChessMatch* match = ChessMatch::GetMatchForEventArgs(args);
+	if (match == nullptr)
+	{
+		return false;
+	}
 	std::string commandLine("ChessMove");
 
 	std::map<std::string, std::string> allKeyValurPairs = args.GetAllValuePairs();
@@ -2483,14 +2643,14 @@ bool Game::Event_ChessMove(EventArgs& args)
 	if (isSentByMyself)//if the event is fired by myself (already succeeded on my machine
 	{// if succeeded, send it to the opponent
 		if (!SpectatorCheck("move a piece", args.GetValue("fromServer", "")))return false;
-		if (!s_isSpectator)
+		if (!match->GetContext().m_isSpectator)
 		{
 			commandLine.append(" remote=true");
 			SetOutgoingData(commandLine);
 			//SendOutgoingDataImmediately(commandLine);
 		}
 		else {
-			bool validMove = App::s_theGame->m_currentMatch->Event_ChessMove(args);
+			bool validMove = ChessMatch::Event_ChessMove(args);
 			if (!validMove)
 			{
 				PrintErrorMsgToConsole("Error: ChessMove opponent invalid move.");
@@ -2503,7 +2663,7 @@ bool Game::Event_ChessMove(EventArgs& args)
 		SetOutgoingDataToAllSpectators(commandLine);
 
 		PrintInfoMsgToConsole("ChessMove: opponent moved piece");
-		bool validMove = App::s_theGame->m_currentMatch->Event_ChessMove(args);
+		bool validMove = ChessMatch::Event_ChessMove(args);
 		if (!validMove)
 		{
 			PrintErrorMsgToConsole("Error: ChessMove opponent invalid move.");
@@ -2530,19 +2690,25 @@ bool Game::Event_ChessResign(EventArgs& args)
 		return false;
 	}
 	bool isSentByMyself = remoteValidation == 0;
+	ChessMatch* match = ChessMatch::GetMatchForEventArgs(args);
+	if (match == nullptr)
+	{
+		return false;
+	}
+	MatchContext const& matchContext = match->GetContext();
 
 	std::string commandLine("ChessResign");
 
 	if (isSentByMyself)
 	{//set current match to be opponent winning
 		if (!SpectatorCheck("resign", args.GetValue("fromServer", "")))return false;
-		if (!s_isSpectator)
+		if (!matchContext.m_isSpectator)
 		{
 			PrintInfoMsgToConsole("ChessResign: You resigned");
 			commandLine.append(" remote=true");
 			SetOutgoingData(commandLine);
 		}
-		App::s_theGame->m_currentMatch->SetMatchResultAndEndTheGame(!s_myPlayerIndex);
+		match->SetMatchResultAndEndTheGame(!matchContext.m_myPlayerIndex);
 	}
 	else {//if opponent resigned, set current match to be me winning
 
@@ -2550,7 +2716,7 @@ bool Game::Event_ChessResign(EventArgs& args)
 		SetOutgoingDataToAllSpectators(commandLine);
 
 		PrintInfoMsgToConsole("ChessResign: Your opponent resigned");
-		App::s_theGame->m_currentMatch->SetMatchResultAndEndTheGame(s_myPlayerIndex);
+		match->SetMatchResultAndEndTheGame(matchContext.m_myPlayerIndex);
 		g_theAudio->StartSound(App::s_theGame->m_infoSFX, false, s_SFXVolume);
 	}
 
@@ -2580,9 +2746,9 @@ bool Game::Event_ChessOfferDraw(EventArgs& args)
 	
 
 	//if a game has not started yet
-	if (App::s_theGame->m_currentMatch == nullptr)
+	ChessMatch* match = ChessMatch::GetMatchForEventArgs(args);
+	if (match == nullptr)
 	{
-		PrintErrorMsgToConsole("Error: ChessOfferDraw there is no ongoing match");
 		return false;
 	}
 
@@ -2599,7 +2765,7 @@ bool Game::Event_ChessOfferDraw(EventArgs& args)
 	if (isSentByMyself)
 	{
 		if (!SpectatorCheck("offer draw", args.GetValue("fromServer", "")))return false;
-		if (!s_isSpectator)
+		if (!match->GetContext().m_isSpectator)
 		{
 			commandLine.append(" remote=true");
 			SetOutgoingData(commandLine);
@@ -2638,6 +2804,11 @@ bool Game::Event_ChessAcceptDraw(EventArgs& args)
 		return false;
 	}
 	bool isSentByMyself = remoteValidation == 0;
+	ChessMatch* match = ChessMatch::GetMatchForEventArgs(args);
+	if (match == nullptr)
+	{
+		return false;
+	}
 
 	std::string commandLine("ChessAcceptDraw");
 
@@ -2650,7 +2821,7 @@ bool Game::Event_ChessAcceptDraw(EventArgs& args)
 			PrintErrorMsgToConsole("Error: ChessAcceptDraw do not have permission to accept draw");
 			return false;
 		}
-		if (!s_isSpectator)
+		if (!match->GetContext().m_isSpectator)
 		{
 			commandLine.append(" remote=true");
 			SetOutgoingData(commandLine);
@@ -2668,7 +2839,7 @@ bool Game::Event_ChessAcceptDraw(EventArgs& args)
 		g_theAudio->StartSound(App::s_theGame->m_infoSFX, false, s_SFXVolume);
 	}
 	
-	App::s_theGame->m_currentMatch->SetMatchResultAndEndTheGame(2);
+	match->SetMatchResultAndEndTheGame(2);
 
 	return true;
 }
@@ -2682,6 +2853,11 @@ bool Game::Event_ChessRejectDraw(EventArgs& args)
 		return false;
 	}
 	bool isSentByMyself = remoteValidation == 0;
+	ChessMatch* match = ChessMatch::GetMatchForEventArgs(args);
+	if (match == nullptr)
+	{
+		return false;
+	}
 
 	std::string commandLine("ChessRejectDraw");
 
@@ -2694,7 +2870,7 @@ bool Game::Event_ChessRejectDraw(EventArgs& args)
 			PrintErrorMsgToConsole("Error: ChessRejectDraw do not have permission to reject draw");
 			return false;
 		}
-		if (!s_isSpectator)
+		if (!match->GetContext().m_isSpectator)
 		{
 			commandLine.append(" remote=true");
 			SetOutgoingData(commandLine);
@@ -2861,7 +3037,7 @@ bool Game::SendOutgoingDataImmediatelyToAllSpectators(std::string const& data, b
 
 bool Game::SpectatorCheck(std::string const& actionStr, std::string const& fromServerStr)
 {
-	if (s_isSpectator && g_theNetwork->IsClientConnectedToServer())
+	if (App::s_theGame->GetNetworkContext().m_isSpectator && g_theNetwork->IsClientConnectedToServer())
 	{//spectator are not allowed to play
 		int isSentFromServer = GetValidationOfBooleanArgs(fromServerStr);
 		if (isSentFromServer == 1)
@@ -4,6 +4,7 @@
 #include "Game/Player.hpp"
 #include "Game/ChessObject.hpp"
 #include "Game/ChessMatch.hpp"
+#include "Game/ChessAIPlayer.hpp"
 #include "Game/ChessBoard.hpp"
 #include "Game/Widget.hpp"
 #include "Game/Button.hpp"
@@ -72,6 +73,10 @@ public:
 	//gameplay related
 	void StartMatch();
 	void ResetMatch();
+	void UpdateAIPlayer();
+	void SetPlayerName(int playerIndex, std::string const& name);//also renames the player in the running match
+	MatchContext& GetNetworkContext();//the running match's, or the one the next match starts with
+	static void OnMatchTurnChange(ChessMatch& match);
 
 	//update functions
 	void UpdateEntities();
@@ -155,6 +160,7 @@ public://static functions
 	static bool Event_ChessAcceptDraw(EventArgs& args);
 	static bool Event_ChessRejectDraw(EventArgs& args);
 	static bool Event_RemoteCmd(EventArgs& args);
+	static bool Event_ChessAI(EventArgs& args);
 
 
 	static bool SetOutgoingData(std::string const& data);
@@ -162,9 +168,6 @@ public://static functions
 	static bool SendOutgoingDataImmediately(std::string const& data, bool disconnectRightAfter = false);
 	static bool SendOutgoingDataImmediatelyToAllSpectators(std::string const& data, bool disconnectRightAfter = false);
 	static bool SpectatorCheck(std::string const& actionStr, std::string const& fromServerStr);
-	static bool s_isPlayingRemotely;
-	static bool s_myPlayerIndex;
-	static bool s_isSpectator;
 	static float s_SFXVolume;
 	static float s_totalAssetNum;
 
@@ -212,7 +215,9 @@ public:
 	EntityList m_allEntities;
 	int m_currentPlayerIndex = 0;
 	ChessMatch* m_currentMatch = nullptr;
+	MatchContext m_nextMatchContext;//only its network role is used, while no match runs
 	std::string m_defaultBoardState;
+	ChessAIPlayer m_aiPlayer;
 
 
 	//camera